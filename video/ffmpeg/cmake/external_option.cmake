@@ -6,6 +6,8 @@ option(POLLUX_ASAN "enable asan" OFF)
 
 option(POLLUX_GCOV "enable gcov" OFF)
 
+option(POLLUX_TRACE "record the pipeline events for `trace_dump`" OFF)
+
 option(POLLUX_WARNING_ALL "enable all compile warnings" ON)
 
 option(POLLUX_WARNING_ERROR "compile warnings as errors" OFF)
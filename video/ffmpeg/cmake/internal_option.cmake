@@ -69,6 +69,14 @@ if(POLLUX_GCOV)
     )
 endif()
 
+# pipeline trace #
+if(POLLUX_TRACE)
+    target_compile_definitions(
+        ${POLLUX_TARGET_NAME}
+        PRIVATE -DPOLLUX_TRACE_ENABLE
+    )
+endif()
+
 # all warnings #
 if(POLLUX_WARNING_ALL)
     if (CMAKE_CXX_COMPILER_ID STREQUAL "MSVC")
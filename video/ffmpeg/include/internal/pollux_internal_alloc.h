@@ -0,0 +1,63 @@
+#ifndef __POLLUX_INTERNAL_ALLOC_H__
+#define __POLLUX_INTERNAL_ALLOC_H__
+
+#include "sirius_attributes.h"
+#include "pollux_decode.h"
+
+#include "libavutil/imgutils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * the least alignment of the buffers, the widest vector
+ * the ffmpeg kernels load, like `av_malloc`
+ */
+#define INTERNAL_ALLOC_ALIGN (64)
+
+/* the huge pages of `POLLUX_PAGE_HUGE`, the usual size on x86-64 and arm64 */
+#define INTERNAL_ALLOC_HUGE_SIZE ((size_t)2 << 20)
+
+/**
+ * @brief copy an allocator, the default one of the pages `page`
+ *  stands in for an allocator without callbacks; with a NUMA node
+ *  `node`, not negative, its buffers are mappings of their own
+ *  bound to the node before they are faulted in
+ */
+hide_symbol void
+internal_alloc_set(pollux_allocator_t *p_dst,
+    const pollux_allocator_t *p_src, pollux_page_t page, int node);
+
+static inline void *
+internal_alloc(const pollux_allocator_t *p_a, size_t size, size_t alignment)
+{
+    if (alignment < INTERNAL_ALLOC_ALIGN) alignment = INTERNAL_ALLOC_ALIGN;
+    return p_a->alloc(p_a->p_user, size, alignment);
+}
+
+static inline void
+internal_free(const pollux_allocator_t *p_a, void *ptr, size_t size)
+{
+    if (ptr) p_a->free(p_a->p_user, ptr, size);
+}
+
+/**
+ * @brief whether `alloc` of `p_a` returns `size` bytes zeroed already,
+ *  the fresh pages of a mapping, so that no one writes over them again
+ */
+hide_symbol bool
+internal_alloc_is_zeroed(const pollux_allocator_t *p_a, size_t size);
+
+/**
+ * @brief allocate an image, in place of `av_image_alloc`
+ * 
+ * @return the size allocated, to be passed to `internal_free`
+ *  with `data[0]`; 0 on failure
+ */
+hide_symbol size_t
+internal_alloc_image(const pollux_allocator_t *p_a,
+    uint8_t *data[4], int linesize[4],
+    int width, int height, enum AVPixelFormat fmt, int alignment);
+
+#endif // __POLLUX_INTERNAL_ALLOC_H__
@@ -0,0 +1,139 @@
+#ifndef __POLLUX_INTERNAL_AUDIO_H__
+#define __POLLUX_INTERNAL_AUDIO_H__
+
+#include "sirius_attributes.h"
+#include "pollux_decode.h"
+
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+#include "libswresample/swresample.h"
+
+#include <stdatomic.h>
+
+/* number of chunks in the ring, a power of 2 */
+#define INTERNAL_AUDIO_SLOT_NR (64)
+
+typedef struct {
+    /* decode the audio or not */
+    unsigned short is_enable;
+
+    /* sample rate, 0 for the source rate */
+    unsigned int sample_rate;
+    /* number of channels, 0 for the source layout */
+    unsigned short channels;
+    /* sample format requested by the caller */
+    pollux_sample_fmt_t fmt;
+} internal_audio_param_t;
+
+typedef struct {
+    /* interleaved samples and the capacity of `buf` */
+    unsigned char *buf;
+    size_t size;
+    /* number of samples per channel */
+    unsigned int sample_nr;
+    /* presentation time of the first sample */
+    int64_t pts_us;
+    /* the chunk is stale once `epoch` of the ring moves on */
+    unsigned int epoch;
+} internal_audio_slot_t;
+
+/**
+ * the audio output of a handle, decoded from the packets read by the
+ * decoding thread and passed to the consumer through a ring with
+ * exactly one producer and one consumer; `head` is only written by
+ * the decoding thread and `tail` only by the consumer, neither of
+ * them ever waits for the other
+ */
+typedef struct {
+    /* index of the audio stream */
+    unsigned int stream_index;
+    /* time base of the audio stream */
+    AVRational time_base;
+    /**
+     * start time of the video stream in microseconds,
+     * the audio timestamps are relative to it like the video ones
+     */
+    int64_t start_us;
+
+    /* codec context */
+    AVCodecContext *codec_ctx;
+    /* resampler to the requested layout, rate and format */
+    struct SwrContext *swr_ctx;
+    /* decoded frame */
+    AVFrame *frame;
+
+    /* output layout, rate and format */
+    AVChannelLayout ch_layout;
+    int sample_rate;
+    enum AVSampleFormat fmt;
+    pollux_sample_fmt_t pollux_fmt;
+    /* bytes of one sample of all channels */
+    int sample_size;
+
+    /* stands in for missing timestamps */
+    int64_t pts_next;
+
+    internal_audio_slot_t slot[INTERNAL_AUDIO_SLOT_NR];
+    /* number of chunks published, written by the decoding thread */
+    atomic_uint head;
+    /* number of chunks taken, written by the consumer */
+    atomic_uint tail;
+    /* moved on by `internal_audio_flush` */
+    atomic_uint epoch;
+    /* number of chunks discarded because the ring was full */
+    atomic_ullong drop_nr;
+} internal_audio_t;
+
+/**
+ * @brief open the audio stream of the file that belongs with the
+ *  video stream, and stop the demuxer from discarding it
+ * 
+ * @param[in] video_index: index of the decoded video stream
+ * 
+ * @return 0 on success, error code otherwise
+ */
+hide_symbol int
+internal_audio_open(internal_audio_t *p_a,
+    const internal_audio_param_t *p_param,
+    AVFormatContext *fmt_ctx, unsigned int video_index);
+
+/**
+ * @brief close the audio, the ring buffers are freed as well
+ */
+hide_symbol void
+internal_audio_close(internal_audio_t *p_a);
+
+/**
+ * @brief decode an audio packet and publish the resampled chunks,
+ *  it is called by the decoding thread
+ * 
+ * @param[in] pkt: the packet, `NULL` drains the decoder at the end
+ *  of the file so that it can start over
+ * @param[in] pts_base: added to the timestamps of the stream
+ * @param[in] pts_min: chunks ending before it are not published,
+ *  `AV_NOPTS_VALUE` for none
+ */
+hide_symbol void
+internal_audio_decode(internal_audio_t *p_a, const AVPacket *pkt,
+    int64_t pts_base, int64_t pts_min);
+
+/**
+ * @brief forget the decoder state and the chunks not yet taken,
+ *  it is called by the decoding thread after a seek
+ * 
+ * @param[in] pts_us: the timestamp the audio continues from
+ */
+hide_symbol void
+internal_audio_flush(internal_audio_t *p_a, int64_t pts_us);
+
+/**
+ * @brief take the oldest chunk, its buffer is exchanged with
+ *  the buffer of `p_res`
+ * 
+ * @return 0 on success, `POLLUX_ERR_AGAIN` if the ring is empty
+ */
+hide_symbol int
+internal_audio_take(internal_audio_t *p_a,
+    pollux_decode_audio_result_t *p_res);
+
+#endif // __POLLUX_INTERNAL_AUDIO_H__
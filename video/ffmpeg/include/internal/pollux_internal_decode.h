@@ -1,7 +1,25 @@
 #ifndef __POLLUX_INTERNAL_DECODE_H__
 #define __POLLUX_INTERNAL_DECODE_H__
 
+#include "pollux_decode.h"
+
+#include <stdint.h>
+
 /* maximum number of images cached */
-#define INTERNAL_FRAME_NR (32)
+#define INTERNAL_FRAME_NR (POLLUX_FRAME_NR_MAX)
+
+/**
+ * the values reported to the caller with a frame cache, kept beside
+ * the caches by their index in `opaque`, so that the fields of the
+ * `AVFrame` keep their libav meaning
+ */
+typedef struct {
+    /* presentation time in microseconds */
+    int64_t pts_us;
+    /* index of the frame since `param_set` */
+    unsigned long long frame_idx;
+    /* number of output ticks the frame stands for, refer to `fps` */
+    unsigned int repeat_nr;
+} internal_frame_meta_t;
 
 #endif // __POLLUX_INTERNAL_DECODE_H__
@@ -2,6 +2,13 @@
 #define __POLLUX_INTERNAL_FFMPEG_H__
 
 #include "sirius_attributes.h"
+#include "pollux_decode.h"
+
+#include "./internal/pollux_internal_fmt.h"
+#include "./internal/pollux_internal_audio.h"
+#include "./internal/pollux_internal_shed.h"
+#include "./internal/pollux_internal_sched.h"
+#include "./internal/pollux_internal_shm.h"
 
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
@@ -20,7 +27,11 @@ typedef struct {
     /* stream index, such as video, audio, etc  */
     unsigned int stream_index;
 
-    /* sws context */
+    /**
+     * sws context, `NULL` as long as the decoded frames have
+     * the requested size and format and are copied as they are;
+     * refer to `internal_ffmpeg_convert`
+     */
     struct SwsContext *sws_ctx;
 
     /* frame data */
@@ -39,6 +50,16 @@ typedef struct {
      */
     unsigned short is_loop;
 
+    /* frame delivery mode, refer to `pollux_delivery_t` */
+    pollux_delivery_t delivery;
+    /* frame drop policy, refer to `pollux_drop_t` */
+    pollux_drop_t drop;
+
+    /* frame ready callback, `NULL` if the result queue is used */
+    pollux_decode_on_frame_t on_frame;
+    /* user data of `on_frame` */
+    void *p_user;
+
     /* width */
     unsigned short width;
     /* height */
@@ -49,21 +70,114 @@ typedef struct {
     /* the buffer size alignment for yuv */
     size_t alignment;
 
+    /* number of caller-owned frame buffers, 0 if none */
+    unsigned int ext_buf_nr;
+    /* caller-owned frame buffers */
+    unsigned char *p_ext_buf[POLLUX_FRAME_NR_MAX];
+    /* shared memory frame ring, `slot_nr` is 0 if none */
+    internal_shm_param_t shm;
+    /* allocator of the frame caches and the results, never empty */
+    pollux_allocator_t allocator;
+
     /* format, refer to `enum AVPixelFormat` */
     enum AVPixelFormat fmt;
+    /* format requested by the caller, refer to `pollux_fmt_t` */
+    pollux_fmt_t pollux_fmt;
+    /* normalization of the tensor formats */
+    internal_fmt_norm_t norm;
+    /* number of luma pyramid levels, 0 or 1 without pyramid */
+    unsigned short pyramid_nr;
+
+    /* audio output */
+    internal_audio_param_t audio;
+    /* load shedding */
+    internal_shed_param_t shed;
+    /* scheduling of the decoding thread */
+    internal_sched_param_t sched;
+    /* threads decoding segments in parallel, 0 or 1 for none */
+    unsigned short segment_thd_nr;
 
     /* the path of source stream file */
     char src_file_path[PATH_MAX];
+    /* index of the stream to decode, -1 for the best one */
+    int stream_index;
+    /* the other streams are not discarded by the demuxer */
+    bool discard_off;
+    /* the path of the keyframe index sidecar, empty if none */
+    char idx_file_path[PATH_MAX];
+    /* the path the trace is written to at `release`, empty if none */
+    char trace_file_path[PATH_MAX];
+
+    /* probe limits, 0 for the ffmpeg defaults */
+    long long probesize;
+    long long analyzeduration;
 } internal_ffmpeg_param_t;
 
+/**
+ * @brief open a decoder for the stream described by `codec_param`
+ * 
+ * @return the codec context, `NULL` on failure
+ */
+hide_symbol AVCodecContext *
+internal_ffmpeg_decoder_create(const AVCodecParameters *codec_param);
+
 hide_symbol void
 internal_ffmpeg_deinit(internal_ffmpeg_info_t *p_ffmpeg);
 
 hide_symbol int
-internal_ffmpeg_init(const char *p_file,
+internal_ffmpeg_init(const internal_ffmpeg_param_t *p_m,
     enum AVMediaType media_type,
     internal_ffmpeg_info_t *p_ffmpeg);
 
+/**
+ * @brief create the sws context converting the decoded frames of
+ *  `codec_ctx` to the given size and format
+ * 
+ * @param[out] pp_sws: the sws context, `NULL` if the decoded frames
+ *  need no conversion
+ * 
+ * @return 0 on success, error code otherwise
+ */
+hide_symbol int
+internal_ffmpeg_sws_create(struct SwsContext **pp_sws,
+    const AVCodecContext *codec_ctx,
+    int width, int height, enum AVPixelFormat fmt);
+
+/**
+ * @brief the presentation time of a decoded frame in microseconds,
+ *  relative to the start of the stream
+ * 
+ * @return the time, `AV_NOPTS_VALUE` if the frame has none
+ */
+hide_symbol int64_t
+internal_ffmpeg_pts_us(const internal_ffmpeg_info_t *p_ffmpeg,
+    const AVFrame *p_frame);
+
+/**
+ * @brief the duration of a decoded frame in microseconds,
+ *  estimated from the frame rate of the stream if the frame has none
+ * 
+ * @return the duration, 0 if unknown
+ */
+hide_symbol int64_t
+internal_ffmpeg_duration_us(const internal_ffmpeg_info_t *p_ffmpeg,
+    const AVFrame *p_frame);
+
+/**
+ * @brief convert a decoded frame into a frame cache of `width` x
+ *  `height` in `fmt`
+ * 
+ * @param[in,out] pp_sws: the value of `internal_ffmpeg_sws_create`,
+ *  it is replaced when the size or the format of the decoded frames
+ *  changes, the frames are copied without it while they match
+ * 
+ * @return the height of the converted frame, 0 on failure
+ */
+hide_symbol int
+internal_ffmpeg_convert(struct SwsContext **pp_sws,
+    const AVFrame *p_src, AVFrame *p_dst,
+    int width, int height, enum AVPixelFormat fmt);
+
 hide_symbol void
 internal_ffmpeg_resource_free(internal_ffmpeg_info_t *p_ffmpeg);
 
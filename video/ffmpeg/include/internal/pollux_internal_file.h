@@ -0,0 +1,39 @@
+#ifndef __POLLUX_INTERNAL_FILE_H__
+#define __POLLUX_INTERNAL_FILE_H__
+
+#include "sirius_attributes.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief the size and the modification time of a regular file,
+ *  which tell whether the data cached for it still holds
+ * 
+ * @return 0 on success, error code if the file can not be stat
+ *  or is not a regular file
+ */
+hide_symbol int
+internal_file_stat(const char *p_path,
+    uint64_t *p_size, int64_t *p_mtime_ns);
+
+/**
+ * @brief the writer of `internal_file_replace`
+ * 
+ * @return true if everything is written
+ */
+typedef bool (*internal_file_write_t)(FILE *fp, void *args);
+
+/**
+ * @brief write a file aside and rename it over `p_path`, readers
+ *  never see half a file; the temporary file is named after the
+ *  process, so that writers in different processes do not mix
+ * 
+ * @return 0 on success, error code otherwise, `p_path` is left as is
+ */
+hide_symbol int
+internal_file_replace(const char *p_path,
+    internal_file_write_t pfn_write, void *args);
+
+#endif // __POLLUX_INTERNAL_FILE_H__
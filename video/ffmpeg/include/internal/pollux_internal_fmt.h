@@ -16,6 +16,10 @@ do { \
         case POLLUX_FMT_444P: F_444P break; \
         case POLLUX_FMT_NV21: F_NV21 break; \
         case POLLUX_FMT_NV12: F_NV12 break; \
+        case POLLUX_FMT_P010: F_P010 break; \
+        case POLLUX_FMT_YUV420P10: F_420P10 break; \
+        case POLLUX_FMT_YUV444P16: F_444P16 break; \
+        case POLLUX_FMT_RGB_F32: F_RGBF32 break; \
         default: \
             SIRIUS_WARN( \
                 "unsupported pollux fmt: %d\n", fmt); \
@@ -29,6 +33,10 @@ do { \
         case AV_PIX_FMT_YUV444P: F_444P break; \
         case AV_PIX_FMT_NV21: F_NV21 break; \
         case AV_PIX_FMT_NV12: F_NV12 break; \
+        case AV_PIX_FMT_P010LE: F_P010 break; \
+        case AV_PIX_FMT_YUV420P10LE: F_420P10 break; \
+        case AV_PIX_FMT_YUV444P16LE: F_444P16 break; \
+        case AV_PIX_FMT_GBRP: F_RGBF32 break; \
         default: \
             SIRIUS_WARN( \
                 "unsupported ffmpeg fmt: %d\n", fmt); \
@@ -36,17 +44,86 @@ do { \
     } \
 } while (0)
 
+/**
+ * per-channel normalization of the tensor formats,
+ * `dst = src * scale + bias`, channels in the order r, g, b
+ */
+typedef struct {
+    float scale[3];
+    float bias[3];
+} internal_fmt_norm_t;
+
+/**
+ * @brief fill the normalization from the mean and the standard
+ *  deviation on the [0, 1] scale, a zero deviation counts as 1
+ */
+hide_symbol void
+internal_fmt_norm_set(internal_fmt_norm_t *p_norm,
+    const float *p_mean, const float *p_std);
+
 hide_symbol bool
 internal_fmt_convert(pollux_fmt_t src_fmt,
     enum AVPixelFormat *p_dst_fmt);
 
+/**
+ * @brief whether the frame cache of the format holds the result
+ *  exactly as it is delivered, the tensor formats are only complete
+ *  after `internal_fmt_img_copy`
+ */
+hide_symbol bool
+internal_fmt_is_direct(enum AVPixelFormat fmt);
+
+/**
+ * @brief the line size in bytes of the first plane of a result
+ * 
+ * @param[in] linesize: the line size of the frame cache
+ */
+hide_symbol unsigned int
+internal_fmt_stride(enum AVPixelFormat fmt,
+    int width, int linesize);
+
+/**
+ * @brief the line size in bytes of the first plane of the results
+ *  of `width`, before any frame cache is allocated
+ * 
+ * @return the line size, 0 if the format or the width is invalid
+ */
+hide_symbol unsigned int
+internal_fmt_stride_of(enum AVPixelFormat fmt,
+    int width, int alignment);
+
+/**
+ * @brief the size of a result
+ * 
+ * @param[in] stride: the value of `internal_fmt_stride`
+ */
 hide_symbol unsigned int
 internal_fmt_size(enum AVPixelFormat fmt,
-    int linesize, int height);
+    int stride, int height);
+
+/**
+ * @brief the size of a frame in `POLLUX_LAYOUT_PACKED` layout
+ * 
+ * @return the size in bytes, 0 if the format can not be packed
+ */
+hide_symbol unsigned int
+internal_fmt_packed_size(enum AVPixelFormat fmt,
+    int width, int height);
+
+/**
+ * @brief copy a frame cache into a continuous buffer
+ */
+hide_symbol int
+internal_fmt_img_copy(unsigned char *p_dst,
+    const AVFrame *p_frame,
+    enum AVPixelFormat fmt,
+    pollux_layout_t layout,
+    const internal_fmt_norm_t *p_norm);
 
 hide_symbol int
 internal_fmt_img_result(pollux_decode_result_t *p_res,
     const AVFrame *frame_nv21,
-    enum AVPixelFormat fmt);
+    enum AVPixelFormat fmt,
+    const internal_fmt_norm_t *p_norm);
 
 #endif // __POLLUX_INTERNAL_FMT_H__
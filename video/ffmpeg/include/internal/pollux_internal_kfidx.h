@@ -0,0 +1,93 @@
+#ifndef __POLLUX_INTERNAL_KFIDX_H__
+#define __POLLUX_INTERNAL_KFIDX_H__
+
+#include "sirius_attributes.h"
+
+#include "libavformat/avformat.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+typedef struct {
+    /**
+     * decoding timestamp of the keyframe packet in the stream time
+     * base, as in the index of the demuxer and `avformat_seek_file`
+     */
+    int64_t ts;
+    /* number of frames of the stream before the keyframe */
+    int64_t frame_nr;
+} internal_kf_entry_t;
+
+/**
+ * keyframe index of the video stream of a file,
+ * taken from the index of the demuxer when it lists every frame,
+ * loaded from the sidecar file, or built by a scan in the background
+ */
+typedef struct {
+    /* entries in ascending order, valid once `ready` is set */
+    internal_kf_entry_t *p_entry;
+    size_t nr;
+    size_t cap;
+    atomic_bool ready;
+
+    /* the background scan */
+    pthread_t thd;
+    bool thd_valid;
+    atomic_bool stop;
+
+    /* time base of the stream */
+    AVRational time_base;
+    /* start time of the stream in `time_base`, 0 if unknown */
+    int64_t start_time;
+
+    /* stream index */
+    unsigned int stream_index;
+    /* the path of source stream file */
+    char file[PATH_MAX];
+    /* the path of the sidecar file, empty if none */
+    char sidecar[PATH_MAX];
+} internal_kfidx_t;
+
+/**
+ * @brief prepare the index, it is ready at once if the demuxer or
+ *  the sidecar file provides it, otherwise a scan is started
+ * 
+ * @param[in] fmt_ctx: the opened format context of `p_file`
+ * @param[in] p_sidecar: the path of the sidecar file, `NULL` if none
+ * 
+ * @return 0 on success, error code otherwise
+ */
+hide_symbol int
+internal_kfidx_open(internal_kfidx_t *p_idx,
+    AVFormatContext *fmt_ctx, unsigned int stream_index,
+    const char *p_file, const char *p_sidecar);
+
+/**
+ * @brief stop the scan and free the index
+ */
+hide_symbol void
+internal_kfidx_close(internal_kfidx_t *p_idx);
+
+/**
+ * @brief find the last keyframe at or before a timestamp
+ * 
+ * @param[in] ts: the timestamp in the stream time base
+ * 
+ * @return the entry, the first one if none is before;
+ *  `NULL` if the index is not ready or empty
+ */
+hide_symbol const internal_kf_entry_t *
+internal_kfidx_by_ts(internal_kfidx_t *p_idx, int64_t ts);
+
+/**
+ * @brief find the last keyframe at or before a frame number
+ * 
+ * @return the entry, the first one if none is before;
+ *  `NULL` if the index is not ready or empty
+ */
+hide_symbol const internal_kf_entry_t *
+internal_kfidx_by_frame(internal_kfidx_t *p_idx, int64_t frame_nr);
+
+#endif // __POLLUX_INTERNAL_KFIDX_H__
@@ -0,0 +1,63 @@
+#ifndef __POLLUX_INTERNAL_MBOX_H__
+#define __POLLUX_INTERNAL_MBOX_H__
+
+#include "sirius_attributes.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+
+/**
+ * single slot mailbox,
+ * the producer always overwrites the slot and the consumer
+ * always takes the newest element
+ */
+typedef struct {
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+
+    /* the newest element, `NULL` if the slot is empty */
+    void *p_elem;
+    /* a waiting consumer returns without an element */
+    bool kick;
+} internal_mbox_t;
+
+hide_symbol void
+internal_mbox_deinit(internal_mbox_t *p_mbox);
+
+hide_symbol int
+internal_mbox_init(internal_mbox_t *p_mbox);
+
+/**
+ * @brief put an element into the slot
+ * 
+ * @return the element displaced from the slot, `NULL` if the slot
+ *  was empty
+ */
+hide_symbol void *
+internal_mbox_put(internal_mbox_t *p_mbox, void *p_elem);
+
+/**
+ * @brief take the element from the slot, waiting at most
+ *  `timeout_ms` milliseconds for one to arrive
+ * 
+ * @return the element, `NULL` on timeout
+ */
+hide_symbol void *
+internal_mbox_get(internal_mbox_t *p_mbox, unsigned int timeout_ms);
+
+/**
+ * @brief wake up the consumer waiting in `internal_mbox_get`,
+ *  which returns `NULL` at once
+ */
+hide_symbol void
+internal_mbox_kick(internal_mbox_t *p_mbox);
+
+/**
+ * @brief empty the slot without waiting
+ * 
+ * @return the element taken out of the slot, `NULL` if it was empty
+ */
+hide_symbol void *
+internal_mbox_reset(internal_mbox_t *p_mbox);
+
+#endif // __POLLUX_INTERNAL_MBOX_H__
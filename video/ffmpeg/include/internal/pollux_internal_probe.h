@@ -0,0 +1,71 @@
+#ifndef __POLLUX_INTERNAL_PROBE_H__
+#define __POLLUX_INTERNAL_PROBE_H__
+
+#include "sirius_attributes.h"
+
+#include "libavformat/avformat.h"
+
+#include <stdint.h>
+
+/* default number of files remembered by the probe cache */
+#define INTERNAL_PROBE_ENTRY_NR (256)
+
+/**
+ * identity of a file in the probe cache,
+ * a file that changes in size or modification time is probed again
+ */
+typedef struct {
+    const char *p_path;
+    uint64_t size;
+    int64_t mtime_ns;
+} internal_probe_key_t;
+
+/**
+ * @brief configure the probe cache shared by the whole process
+ * 
+ * @param[in] entry_nr: the maximum number of files, 0 disables it
+ * @param[in] p_file: the cache file, `NULL` if none
+ * 
+ * @return 0 on success, error code otherwise
+ */
+hide_symbol int
+internal_probe_config(unsigned int entry_nr, const char *p_file);
+
+/**
+ * @brief fill the key of a file
+ * 
+ * @return 0 on success, error code if the file can not be stat
+ */
+hide_symbol int
+internal_probe_key_get(const char *p_path, internal_probe_key_t *p_key);
+
+/**
+ * @brief the input format of a cached file, so that
+ *  `avformat_open_input` skips the format probe
+ * 
+ * @return the input format, `NULL` on a miss
+ */
+hide_symbol const AVInputFormat *
+internal_probe_iformat(const internal_probe_key_t *p_key);
+
+/**
+ * @brief restore the probed stream parameters of a cached file,
+ *  which takes the place of `avformat_find_stream_info`
+ * 
+ * @param[in] fmt_ctx: the format context opened on the file
+ * 
+ * @return 0 on a hit, error code on a miss
+ */
+hide_symbol int
+internal_probe_apply(const internal_probe_key_t *p_key,
+    AVFormatContext *fmt_ctx);
+
+/**
+ * @brief remember the stream parameters probed by
+ *  `avformat_find_stream_info`
+ */
+hide_symbol void
+internal_probe_store(const internal_probe_key_t *p_key,
+    const AVFormatContext *fmt_ctx);
+
+#endif // __POLLUX_INTERNAL_PROBE_H__
@@ -0,0 +1,39 @@
+#ifndef __POLLUX_INTERNAL_PYRAMID_H__
+#define __POLLUX_INTERNAL_PYRAMID_H__
+
+#include "pollux_decode.h"
+#include "sirius_attributes.h"
+
+/**
+ * @brief lay out the luma pyramid behind the frame in a result
+ * 
+ * @param[out] p_level: `level_nr` levels, level 0 is the luma plane
+ *  of the frame itself
+ * @param[in] level_nr: number of levels, including level 0
+ * @param[in] width: width of the frame
+ * @param[in] height: height of the frame
+ * @param[in] stride: stride of the frame
+ * @param[in] base_size: the size of the frame in the result,
+ *  the first scaled level starts right after it
+ * 
+ * @return the size of the result including all the levels,
+ *  0 if the frame is too small for `level_nr` levels
+ */
+hide_symbol unsigned int
+internal_pyramid_layout(pollux_decode_level_t *p_level,
+    unsigned int level_nr, int width, int height, int stride,
+    unsigned int base_size);
+
+/**
+ * @brief fill the scaled levels, each one is the 2x2 box average
+ *  of the previous level
+ * 
+ * @param[in,out] p_buf: buffer of the result, level 0 is read from it
+ * @param[in] p_level: the layout from `internal_pyramid_layout`
+ * @param[in] level_nr: number of levels, including level 0
+ */
+hide_symbol void
+internal_pyramid_build(unsigned char *p_buf,
+    const pollux_decode_level_t *p_level, unsigned int level_nr);
+
+#endif // __POLLUX_INTERNAL_PYRAMID_H__
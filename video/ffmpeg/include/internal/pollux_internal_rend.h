@@ -0,0 +1,149 @@
+#ifndef __POLLUX_INTERNAL_REND_H__
+#define __POLLUX_INTERNAL_REND_H__
+
+#include "sirius_queue.h"
+#include "sirius_attributes.h"
+
+#include "./internal/pollux_internal_fmt.h"
+#include "./internal/pollux_internal_alloc.h"
+#include "./internal/pollux_internal_decode.h"
+
+#include "libswscale/swscale.h"
+
+#include <pthread.h>
+
+/* number of frame caches of an additional rendition */
+#define INTERNAL_REND_FRAME_NR (8)
+
+typedef struct {
+    /* width */
+    unsigned short width;
+    /* height */
+    unsigned short height;
+    /* stride of the results */
+    unsigned short stride;
+
+    /* the buffer size alignment */
+    size_t alignment;
+
+    /* format, refer to `enum AVPixelFormat` */
+    enum AVPixelFormat fmt;
+    /* format requested by the caller, refer to `pollux_fmt_t` */
+    pollux_fmt_t pollux_fmt;
+    /* normalization of the tensor formats */
+    internal_fmt_norm_t norm;
+    /* number of luma pyramid levels */
+    unsigned short pyramid_nr;
+} internal_rend_param_t;
+
+/**
+ * an additional output of a handle, converted from the same decoded
+ * frames as the primary output with its own sws context and caches;
+ * it never blocks the decoding thread, when all the caches wait for
+ * the consumer the oldest one is recycled
+ */
+typedef struct {
+    /* queue handle, free */
+    sirius_que_handle h_que_free;
+    /* queue handle, result */
+    sirius_que_handle h_que_res;
+    /* frame caches, allocated with their data */
+    AVFrame *p_frame[INTERNAL_REND_FRAME_NR];
+    /* the values of each frame cache, refer to `internal_rend_meta` */
+    internal_frame_meta_t meta[INTERNAL_REND_FRAME_NR];
+    /* the allocator and the size of the data of each frame cache */
+    pollux_allocator_t alloc;
+    size_t frame_size;
+
+    /* sws context, refer to `internal_ffmpeg_sws_create` */
+    struct SwsContext *sws_ctx;
+
+    /* parameters */
+    internal_rend_param_t param;
+
+    /**
+     * only keeps the consumer of the rendition away from `param_set`
+     * and `release`, the decoding thread never takes it
+     */
+    pthread_mutex_t mtx;
+} internal_rend_t;
+
+hide_symbol void
+internal_rend_deinit(internal_rend_t *p_rend);
+
+/**
+ * @brief create the queues and the mutex, the frame caches are
+ *  allocated by `internal_rend_data_alloc`
+ */
+hide_symbol int
+internal_rend_init(internal_rend_t *p_rend);
+
+/**
+ * @brief free the frame caches, nothing is done if there are none
+ */
+hide_symbol void
+internal_rend_data_free(internal_rend_t *p_rend);
+
+/**
+ * @brief allocate the frame caches based on `p_rend->param`
+ * 
+ * @param[in] p_alloc: the allocator, it is kept until the data is freed
+ */
+hide_symbol int
+internal_rend_data_alloc(internal_rend_t *p_rend,
+    const pollux_allocator_t *p_alloc);
+
+hide_symbol void
+internal_rend_sws_free(internal_rend_t *p_rend);
+
+hide_symbol int
+internal_rend_sws_create(internal_rend_t *p_rend,
+    const AVCodecContext *codec_ctx);
+
+/**
+ * @brief convert a decoded frame into the rendition,
+ *  it is called by the decoding thread
+ * 
+ * @param[in] p_meta: the values of the frame
+ */
+hide_symbol void
+internal_rend_push(internal_rend_t *p_rend, const AVFrame *p_src,
+    const internal_frame_meta_t *p_meta);
+
+/**
+ * @brief the values of a frame cache of the rendition
+ */
+static inline const internal_frame_meta_t *
+internal_rend_meta(const internal_rend_t *p_rend, const AVFrame *p_frame)
+{
+    return &(p_rend->meta[(intptr_t)(p_frame->opaque)]);
+}
+
+/**
+ * @brief take a converted frame
+ * 
+ * @return the frame, `NULL` if no frame is available in time
+ */
+hide_symbol AVFrame *
+internal_rend_take(internal_rend_t *p_rend, unsigned int timeout_ms);
+
+/**
+ * @brief give a frame from `internal_rend_take` back to the rendition
+ */
+hide_symbol void
+internal_rend_recycle(internal_rend_t *p_rend, AVFrame *p_frame);
+
+/**
+ * @brief wake up a consumer waiting in `internal_rend_take`,
+ *  which returns `NULL` at once
+ */
+hide_symbol void
+internal_rend_kick(internal_rend_t *p_rend);
+
+/**
+ * @brief give every converted frame not yet taken back to the rendition
+ */
+hide_symbol void
+internal_rend_flush(internal_rend_t *p_rend);
+
+#endif // __POLLUX_INTERNAL_REND_H__
@@ -0,0 +1,75 @@
+#ifndef __POLLUX_INTERNAL_SCHED_H__
+#define __POLLUX_INTERNAL_SCHED_H__
+
+#include "sirius_attributes.h"
+#include "pollux_decode.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* the CPUs a handle can be bound to, as many as `CPU_SETSIZE` */
+#define INTERNAL_SCHED_CPU_NR (1024)
+#define INTERNAL_SCHED_MASK_NR (INTERNAL_SCHED_CPU_NR / 64)
+/* the NUMA nodes a handle can be placed on */
+#define INTERNAL_SCHED_NODE_NR (64)
+
+typedef struct {
+    /* refer to `pollux_priority_t` */
+    pollux_priority_t priority;
+    /* the nice value of the class, or of `cpu_share` */
+    int nice;
+
+    /* the thread may run on any CPU if it is not set */
+    bool has_cpus;
+    /* bit `n % 64` of word `n / 64` stands for CPU `n` */
+    unsigned long long cpu_mask[INTERNAL_SCHED_MASK_NR];
+
+    /* the NUMA node of the memory, -1 if the memory is left alone */
+    int node;
+    /**
+     * the node `POLLUX_NUMA_AUTO` gave the handle, kept over the
+     * next `param_set`, -1 before the first
+     */
+    int auto_node;
+} internal_sched_param_t;
+
+/**
+ * @brief the scheduling parameters of a new handle
+ */
+static inline void
+internal_sched_param_init(internal_sched_param_t *p_param)
+{
+    p_param->node = -1;
+    p_param->auto_node = -1;
+}
+
+/**
+ * @brief fill the scheduling parameters from the public ones
+ * 
+ * @return 0 on success, error code otherwise
+ */
+hide_symbol int
+internal_sched_param_set(internal_sched_param_t *p_param,
+    const pollux_decode_sched_t *p_sched);
+
+/**
+ * @brief apply the parameters to the calling thread; a setting the
+ *  process is not allowed to make is reported and left out
+ */
+hide_symbol void
+internal_sched_apply(const internal_sched_param_t *p_param);
+
+/**
+ * @brief prefer the NUMA node `node` for the whole pages of `size`
+ *  bytes at `ptr`, the pages touched already are moved to it; it
+ *  does nothing with a negative node
+ * 
+ * @return 0 on success, `errno` of `mbind` otherwise
+ * 
+ * @note the policy stays on the mapping, only a mapping of its own
+ *  may be bound, not the heap of the process
+ */
+hide_symbol int
+internal_sched_mem_bind(int node, void *ptr, size_t size);
+
+#endif // __POLLUX_INTERNAL_SCHED_H__
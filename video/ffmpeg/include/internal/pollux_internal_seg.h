@@ -0,0 +1,138 @@
+#ifndef __POLLUX_INTERNAL_SEG_H__
+#define __POLLUX_INTERNAL_SEG_H__
+
+#include "sirius_attributes.h"
+#include "sirius_queue.h"
+
+#include "./internal/pollux_internal_ffmpeg.h"
+#include "./internal/pollux_internal_stats.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* the most threads decoding segments of one file */
+#define INTERNAL_SEG_THD_MAX POLLUX_SEGMENT_THD_MAX
+/* decoded frames each thread may have ahead of the delivery */
+#define INTERNAL_SEG_FRAME_NR (4)
+/* segments per thread, so that a slow segment holds up less */
+#define INTERNAL_SEG_PER_THD (4)
+
+typedef struct {
+    /* the segmenter the thread belongs to */
+    struct internal_seg_t *p_seg;
+    /* index of the thread, it decodes the segments `index + n * thd_nr` */
+    unsigned int index;
+
+    /* thread id, valid while `thd_valid` is set */
+    pthread_t thd;
+    bool thd_valid;
+
+    /* an input, a decoder, a packet and a frame of its own */
+    internal_ffmpeg_info_t ffmpeg;
+
+    /* decoded frames of the thread, idle ones */
+    sirius_que_handle h_que_free;
+    /**
+     * decoded frames in presentation order, a frame without data
+     * closes a segment; `NULL` stops the reader
+     */
+    sirius_que_handle h_que_out;
+    AVFrame *p_frame[INTERNAL_SEG_FRAME_NR];
+} internal_seg_thd_t;
+
+/**
+ * the file is cut into segments of equal duration; segment `n` holds
+ * the frames presented from `p_start[n]` to `p_start[n + 1]`
+ * (excluded), it is decoded from the keyframe before its start, and
+ * up to the first frame presented after its end, so that no frame
+ * reordered across a boundary is lost, at the cost of decoding about
+ * one GOP twice per segment; each thread has its own demuxer and
+ * decoder, the reader takes the segments back in order
+ */
+typedef struct internal_seg_t {
+    internal_seg_thd_t thd[INTERNAL_SEG_THD_MAX];
+    unsigned int thd_nr;
+
+    /* start of each segment in the stream time base */
+    int64_t *p_start;
+    /**
+     * how each segment ended, 0 or an error code, written before the
+     * frame that closes it; refer to `internal_seg_ret`
+     */
+    int *p_ret;
+    unsigned int seg_nr;
+    /**
+     * the seek goes this far before the start of a segment, so that
+     * the frames the decoder reorders are decoded from their own GOP
+     */
+    int64_t margin;
+
+    /* parameters of the handle, the threads take its scheduling */
+    const internal_ffmpeg_param_t *p_m;
+    /* statistics of the handle, the threads count read, send, receive */
+    internal_stats_t *p_stats;
+
+    atomic_bool stop;
+} internal_seg_t;
+
+/**
+ * @brief cut the file into segments and start the threads
+ * 
+ * @param[in] p_m: the parameters of the handle, the file, the stream and
+ *  the scheduling; it must stay valid until `internal_seg_close`
+ * @param[in] p_main: the opened input of the handle
+ * @param[in] thd_nr: number of threads, no more than
+ *  `INTERNAL_SEG_THD_MAX`
+ * 
+ * @return 0 on success, `POLLUX_ERR_UNSUPPORTED` if the input cannot
+ *  seek or has no duration, error code otherwise
+ */
+hide_symbol int
+internal_seg_open(internal_seg_t *p_seg,
+    const internal_ffmpeg_param_t *p_m, const internal_ffmpeg_info_t *p_main,
+    unsigned int thd_nr, internal_stats_t *p_stats);
+
+/**
+ * @brief make the threads and the reader stop waiting, they return
+ *  at once; it may be called from any thread
+ */
+hide_symbol void
+internal_seg_stop(internal_seg_t *p_seg);
+
+/**
+ * @brief stop and join the threads, and free the segmenter;
+ *  the reader must have returned
+ */
+hide_symbol void
+internal_seg_close(internal_seg_t *p_seg);
+
+/**
+ * @brief take the next frame of segment `seg`, waiting for it
+ * 
+ * @return the decoded frame, to be given back by `internal_seg_recycle`;
+ *  `NULL` at the end of the segment or after `internal_seg_stop`
+ */
+hide_symbol AVFrame *
+internal_seg_take(internal_seg_t *p_seg, unsigned int seg);
+
+/**
+ * @brief how segment `seg` ended, once `internal_seg_take` has
+ *  returned `NULL` for it without `internal_seg_stop`
+ * 
+ * @return 0 if it was decoded to its end, error code if its input
+ *  could not be sought to or read, the frames before are delivered
+ */
+static inline int
+internal_seg_ret(const internal_seg_t *p_seg, unsigned int seg)
+{
+    return p_seg->p_ret[seg];
+}
+
+/**
+ * @brief give a frame of segment `seg` back to its thread
+ */
+hide_symbol void
+internal_seg_recycle(internal_seg_t *p_seg, unsigned int seg, AVFrame *avf);
+
+#endif // __POLLUX_INTERNAL_SEG_H__
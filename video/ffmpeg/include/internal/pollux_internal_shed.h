@@ -0,0 +1,62 @@
+#ifndef __POLLUX_INTERNAL_SHED_H__
+#define __POLLUX_INTERNAL_SHED_H__
+
+#include "sirius_attributes.h"
+#include "pollux_decode.h"
+
+#include "libavcodec/avcodec.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* the default threshold of `late_ms`, unit: microsecond */
+#define INTERNAL_SHED_LATE_US (40000)
+/* frames between two level changes, the time to see the effect */
+#define INTERNAL_SHED_HOLD_NR (16)
+
+typedef struct {
+    /* the level is never changed if it is not set */
+    bool is_enable;
+    /* raise the level above it, lower it below a quarter of it */
+    int64_t late_us;
+} internal_shed_param_t;
+
+/**
+ * controller of the load shedding, it is driven by the decoding
+ * thread alone; `level` and `late_avg_us` are read by `stats_get`
+ */
+typedef struct {
+    internal_shed_param_t param;
+
+    /* refer to `pollux_shed_level_t` */
+    atomic_int level;
+    /* moving average of the lateness, weight 1/8 */
+    atomic_llong late_avg_us;
+    /* frames left before the level may change again */
+    unsigned int hold_nr;
+} internal_shed_t;
+
+hide_symbol void
+internal_shed_reset(internal_shed_t *p_shed,
+    const internal_shed_param_t *p_param);
+
+/**
+ * @brief account the lateness of a delivered frame, and apply the
+ *  level it leads to on the decoder
+ * 
+ * @param[in] late_us: the time the frame is past its due time,
+ *  negative if it is early
+ */
+hide_symbol void
+internal_shed_update(internal_shed_t *p_shed,
+    AVCodecContext *codec_ctx, int64_t late_us);
+
+static inline pollux_shed_level_t
+internal_shed_level(internal_shed_t *p_shed)
+{
+    return (pollux_shed_level_t)atomic_load_explicit(
+        &(p_shed->level), memory_order_relaxed);
+}
+
+#endif // __POLLUX_INTERNAL_SHED_H__
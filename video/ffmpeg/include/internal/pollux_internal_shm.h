@@ -0,0 +1,98 @@
+#ifndef __POLLUX_INTERNAL_SHM_H__
+#define __POLLUX_INTERNAL_SHM_H__
+
+#include "sirius_attributes.h"
+#include "pollux_shm.h"
+
+#include "./internal/pollux_internal_decode.h"
+
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+
+#include <stddef.h>
+
+/* the longest name of the memfd, the terminator included */
+#define INTERNAL_SHM_NAME_MAX (64)
+
+typedef struct {
+    /* number of slots, 0 if the ring is not used */
+    unsigned int slot_nr;
+    /* name of the memfd */
+    char name[INTERNAL_SHM_NAME_MAX];
+} internal_shm_param_t;
+
+/**
+ * the writer side of the frame ring, refer to `pollux_shm.h`;
+ * it is open while `p_hdr` is set, and only the decoding thread
+ * publishes frames
+ */
+typedef struct {
+    /* the memfd */
+    int fd;
+    /* the mapping, writable */
+    pollux_shm_header_t *p_hdr;
+    pollux_shm_slot_t *p_slot;
+    unsigned char *p_data;
+} internal_shm_t;
+
+/**
+ * @brief create the memfd and lay out the ring for frames of
+ *  the given size and format
+ * 
+ * @return 0 on success, error code otherwise
+ */
+hide_symbol int
+internal_shm_open(internal_shm_t *p_shm,
+    const internal_shm_param_t *p_param,
+    enum AVPixelFormat fmt, pollux_fmt_t pollux_fmt,
+    unsigned short width, unsigned short height, int alignment);
+
+/**
+ * @brief end the ring for its readers, unmap and close it;
+ *  the readers keep their own mappings
+ */
+hide_symbol void
+internal_shm_close(internal_shm_t *p_shm);
+
+/**
+ * @brief the frame of slot `index`
+ */
+static inline unsigned char *
+internal_shm_slot_data(internal_shm_t *p_shm, unsigned int index)
+{
+    return p_shm->p_data + index * p_shm->p_hdr->slot_size;
+}
+
+/**
+ * @brief mark the slot of the next frame as being written
+ * 
+ * @return index of the slot, the frame is written to
+ *  `internal_shm_slot_data` of it
+ */
+hide_symbol unsigned int
+internal_shm_begin(internal_shm_t *p_shm);
+
+/**
+ * @brief publish the frame written since `internal_shm_begin`
+ * 
+ * @param[in] p_meta: the values of the frame, copied to the slot
+ */
+hide_symbol void
+internal_shm_publish(internal_shm_t *p_shm,
+    const internal_frame_meta_t *p_meta);
+
+/**
+ * @brief give the slot of `internal_shm_begin` back unpublished, its
+ *  contents are no frame; the next frame goes to the same slot
+ */
+hide_symbol void
+internal_shm_abort(internal_shm_t *p_shm);
+
+/**
+ * @brief tell the readers that no more frames are published,
+ *  it does nothing if the ring is not open
+ */
+hide_symbol void
+internal_shm_end(internal_shm_t *p_shm);
+
+#endif // __POLLUX_INTERNAL_SHM_H__
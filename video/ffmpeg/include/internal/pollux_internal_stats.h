@@ -0,0 +1,69 @@
+#ifndef __POLLUX_INTERNAL_STATS_H__
+#define __POLLUX_INTERNAL_STATS_H__
+
+#include "sirius_attributes.h"
+#include "pollux_decode.h"
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* sub-buckets per power of 2 of a histogram, refer to `internal_hist_t` */
+#define INTERNAL_HIST_SUB_BITS (3)
+#define INTERNAL_HIST_SUB_NR (1 << INTERNAL_HIST_SUB_BITS)
+/* up to 2^34 ns (about 17 s), the longer ones go to the last bucket */
+#define INTERNAL_HIST_BUCKET_NR (256)
+
+/**
+ * latency histogram with logarithmic buckets, each power of 2 split
+ * into `INTERNAL_HIST_SUB_NR` linear sub-buckets, like HdrHistogram;
+ * it is updated with relaxed atomics only, by any number of threads
+ */
+typedef struct {
+    atomic_ullong bucket[INTERNAL_HIST_BUCKET_NR];
+    atomic_ullong count;
+    atomic_ullong total_ns;
+    atomic_ullong max_ns;
+} internal_hist_t;
+
+typedef struct {
+    /* the monotonic time of the reset */
+    atomic_llong start_ns;
+
+    atomic_ullong packet_nr;
+    atomic_ullong decode_nr;
+    atomic_ullong deliver_nr;
+
+    /* refer to `pollux_stage_t` */
+    internal_hist_t hist[POLLUX_STAGE_MAX];
+} internal_stats_t;
+
+/**
+ * @brief the monotonic clock in nanoseconds
+ */
+hide_symbol int64_t
+internal_stats_now_ns(void);
+
+/**
+ * @brief start over, it may run while `internal_stats_get` reads
+ */
+hide_symbol void
+internal_stats_reset(internal_stats_t *p_stats);
+
+/**
+ * @brief record a pass of `stage` that began at `start_ns`
+ * 
+ * @return the end of the pass, the start of the next stage
+ */
+hide_symbol int64_t
+internal_stats_stage(internal_stats_t *p_stats,
+    pollux_stage_t stage, int64_t start_ns);
+
+/**
+ * @brief fill the public statistics, except the fields kept
+ *  outside `p_stats`
+ */
+hide_symbol void
+internal_stats_get(const internal_stats_t *p_stats,
+    pollux_decode_stats_t *p_out);
+
+#endif // __POLLUX_INTERNAL_STATS_H__
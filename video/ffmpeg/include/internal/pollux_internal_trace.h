@@ -0,0 +1,123 @@
+#ifndef __POLLUX_INTERNAL_TRACE_H__
+#define __POLLUX_INTERNAL_TRACE_H__
+
+#include "sirius_attributes.h"
+#include "pollux_decode.h"
+#include "./internal/pollux_internal_stats.h"
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* events kept per thread, a power of 2, the oldest are overwritten */
+#define INTERNAL_TRACE_EVENT_NR (1 << 16)
+
+/**
+ * events of the timeline, the stages of `pollux_stage_t`
+ * keep their values
+ */
+typedef enum {
+    INTERNAL_TRACE_EV_READ = POLLUX_STAGE_READ,
+    INTERNAL_TRACE_EV_SEND = POLLUX_STAGE_SEND,
+    INTERNAL_TRACE_EV_RECEIVE = POLLUX_STAGE_RECEIVE,
+    INTERNAL_TRACE_EV_SCALE = POLLUX_STAGE_CONVERT,
+    INTERNAL_TRACE_EV_ENQUEUE = POLLUX_STAGE_DELIVER,
+    INTERNAL_TRACE_EV_COPY = POLLUX_STAGE_COPY,
+    /* the consumer waiting for a frame */
+    INTERNAL_TRACE_EV_DEQUEUE,
+
+    INTERNAL_TRACE_EV_MAX,
+} internal_trace_ev_t;
+
+/**
+ * the threads writing the events; the consumers of a handle are
+ * serialized by its result mutex, so they write as one; the consumers
+ * of rendition `i` by the mutex of the rendition, they write as
+ * `INTERNAL_TRACE_THD_RENDITION + i`
+ */
+typedef enum {
+    INTERNAL_TRACE_THD_DECODE = 0,
+    INTERNAL_TRACE_THD_CONSUMER,
+    INTERNAL_TRACE_THD_RENDITION,
+
+    INTERNAL_TRACE_THD_MAX =
+        INTERNAL_TRACE_THD_RENDITION + POLLUX_RENDITION_MAX,
+} internal_trace_thd_t;
+
+typedef struct {
+    /**
+     * the position of the event plus 1, 0 while it is written;
+     * a reader keeps the event only if it is the same before
+     * and after the copy
+     */
+    atomic_ullong seq;
+
+    int64_t start_ns;
+    int64_t end_ns;
+    /* index of the frame, -1 if none */
+    int64_t arg;
+    internal_trace_ev_t ev;
+} internal_trace_slot_t;
+
+/**
+ * ring of one writer, the writer never waits and
+ * the readers never block it
+ */
+typedef struct {
+    internal_trace_slot_t *slot;
+    /* number of events written */
+    atomic_ullong head;
+} internal_trace_ring_t;
+
+typedef struct {
+    internal_trace_ring_t ring[INTERNAL_TRACE_THD_MAX];
+} internal_trace_t;
+
+#ifdef POLLUX_TRACE_ENABLE
+#define INTERNAL_TRACE_NOW() internal_stats_now_ns()
+#define INTERNAL_TRACE(p_trace, thd, ev, start_ns, end_ns, arg) \
+    internal_trace_add(p_trace, thd, ev, start_ns, end_ns, arg)
+#else
+/* the events and their timestamps cost nothing */
+#define INTERNAL_TRACE_NOW() ((int64_t)0)
+#define INTERNAL_TRACE(p_trace, thd, ev, start_ns, end_ns, arg) \
+    ((void)(start_ns))
+#endif
+
+/**
+ * @brief allocate the rings, nothing is allocated unless the library
+ *  is built with `POLLUX_TRACE`
+ * 
+ * @return 0 on success, error code otherwise
+ */
+hide_symbol int
+internal_trace_open(internal_trace_t *p_trace);
+
+hide_symbol void
+internal_trace_close(internal_trace_t *p_trace);
+
+/**
+ * @brief forget the events, no writer may run concurrently
+ */
+hide_symbol void
+internal_trace_reset(internal_trace_t *p_trace);
+
+/**
+ * @brief record an event, it is only called by the writer of `thd`
+ */
+hide_symbol void
+internal_trace_add(internal_trace_t *p_trace, internal_trace_thd_t thd,
+    internal_trace_ev_t ev, int64_t start_ns, int64_t end_ns, int64_t arg);
+
+/**
+ * @brief write the events in the Chrome trace event format,
+ *  it may run while the writers go on
+ * 
+ * @param[in] p_file: the JSON file, it is overwritten
+ * 
+ * @return 0 on success, `POLLUX_ERR_UNSUPPORTED` without `POLLUX_TRACE`,
+ *  error code otherwise
+ */
+hide_symbol int
+internal_trace_dump(internal_trace_t *p_trace, const char *p_file);
+
+#endif // __POLLUX_INTERNAL_TRACE_H__
@@ -3,12 +3,30 @@
 
 #include "pollux_fmt.h"
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* maximum number of frame caches of a handle */
+#define POLLUX_FRAME_NR_MAX (32)
+
+/* maximum number of pyramid levels, including the full size level */
+#define POLLUX_PYRAMID_MAX (4)
+
+/* maximum number of additional renditions of a handle */
+#define POLLUX_RENDITION_MAX (4)
+
+/* maximum number of threads decoding segments of a file */
+#define POLLUX_SEGMENT_THD_MAX (16)
+
 typedef struct {
-    /* width */
+    /**
+     * width, the line of a result, `stride` of the
+     * `pollux_decode_result_t` struct, must not exceed 65535 bytes;
+     * e.g., no more than 16383 for `POLLUX_FMT_RGB_F32`
+     */
     unsigned short width;
     /* height */
     unsigned short height;
@@ -18,10 +36,384 @@ typedef struct {
 
     /* format, refer to `pollux_fmt_t` */
     pollux_fmt_t fmt;
+
+    /**
+     * normalization of the tensor formats such as
+     * `POLLUX_FMT_RGB_F32`, per channel in the order r, g, b:
+     * `dst = (src / 255 - mean) / std`;
+     * a zero `std` counts as 1
+     */
+    float mean[3];
+    float std[3];
+
+    /**
+     * number of luma pyramid levels, no more than `POLLUX_PYRAMID_MAX`;
+     * each level is the 2x2 box average of the previous one,
+     * level 0 is the luma plane of the frame itself;
+     * 0 or 1: no pyramid;
+     * only the 8-bit yuv formats support it, and the smallest level
+     * must keep at least one pixel in each dimension
+     */
+    unsigned short pyramid_nr;
 } pollux_decode_yuv_t;
 
 typedef struct {
-    /* frames per second */
+    /**
+     * 1: decode the audio stream of the file in the same pass as the
+     *  video, refer to `audio_get`; `param_set` fails if the file
+     *  has no audio stream;
+     * 0: no audio, the audio streams are discarded by the demuxer
+     */
+    unsigned short is_enable;
+
+    /* sample rate, 0: the rate of the source */
+    unsigned int sample_rate;
+    /* number of channels in their default layout, 0: the source layout */
+    unsigned short channels;
+    /* sample format, refer to `pollux_sample_fmt_t` */
+    pollux_sample_fmt_t fmt;
+} pollux_decode_audio_t;
+
+typedef enum {
+    /* every decoded frame is delivered in decoding order */
+    POLLUX_DELIVERY_FIFO = 0,
+
+    /**
+     * only the newest frame is kept, the decoding thread
+     * overwrites it with every new frame and `result_get`
+     * always returns the most recent one
+     */
+    POLLUX_DELIVERY_MAILBOX,
+
+    POLLUX_DELIVERY_MAX,
+} pollux_delivery_t;
+
+typedef enum {
+    /**
+     * the decoding thread waits for the consumer
+     * when all frame caches are in use
+     */
+    POLLUX_DROP_NONE = 0,
+
+    /**
+     * the decoding thread discards the oldest undelivered
+     * frame when all frame caches are in use
+     */
+    POLLUX_DROP_OLDEST,
+
+    POLLUX_DROP_MAX,
+} pollux_drop_t;
+
+typedef enum {
+    /**
+     * `target` is a time in microseconds, refer to `pts_us`;
+     * the frames resume at the keyframe at or before it, which
+     * needs no decoding ahead and is the fastest
+     */
+    POLLUX_SEEK_KEYFRAME = 0,
+
+    /**
+     * `target` is a time in microseconds, refer to `pts_us`;
+     * the frames resume at the first one at or after it, the frames
+     * from the keyframe before it are decoded but not delivered
+     */
+    POLLUX_SEEK_ACCURATE,
+
+    /**
+     * `target` is a frame index, refer to `frame_idx`;
+     * the frames resume at that frame, in the same way as
+     * `POLLUX_SEEK_ACCURATE`
+     */
+    POLLUX_SEEK_FRAME,
+
+    POLLUX_SEEK_MAX,
+} pollux_seek_t;
+
+/**
+ * degradation levels of the load shedding, each one includes
+ * the ones before it
+ */
+typedef enum {
+    /* full quality */
+    POLLUX_SHED_NONE = 0,
+    /* the in-loop deblocking filter is skipped */
+    POLLUX_SHED_LOOP_FILTER,
+    /* the non-reference frames are not decoded */
+    POLLUX_SHED_NONREF,
+    /* the frames already past their due time are not converted */
+    POLLUX_SHED_CONVERT,
+
+    POLLUX_SHED_MAX,
+} pollux_shed_level_t;
+
+/**
+ * adaptive load shedding: the decoding thread measures how late the
+ * frames are against the pace of the timestamps, and when it keeps
+ * falling behind (an oversubscribed CPU), it trades quality for time
+ * one level after another, refer to `pollux_shed_level_t`; it returns
+ * to full quality step by step once the frames are on time again;
+ * the time a consumer holds up the decoder, in the frame caches or
+ * in `on_frame`, is not lateness, the pace moves on after it
+ */
+typedef struct {
+    /**
+     * 1: shed load when the frames are late;
+     * 0: the frames are always decoded in full, the setting
+     *  for streams that must not degrade;
+     * it is ignored for `POLLUX_PRIORITY_HIGH` and above
+     */
+    unsigned short is_enable;
+
+    /**
+     * the smoothed lateness above which one more level is shed,
+     * unit: millisecond; 0: 40 ms
+     */
+    unsigned int late_ms;
+} pollux_decode_shed_t;
+
+typedef enum {
+    /* the default scheduling of the process */
+    POLLUX_PRIORITY_NORMAL = 0,
+
+    /**
+     * batch work, such as extraction ahead of time; it runs on
+     * `SCHED_BATCH` with nice 10 and yields to the other classes
+     */
+    POLLUX_PRIORITY_BACKGROUND,
+
+    /**
+     * live streams, such as previews; nice -5, which needs
+     * `CAP_SYS_NICE` or `RLIMIT_NICE`, it stays at 0 otherwise;
+     * never sheds load, refer to `pollux_decode_shed_t`
+     */
+    POLLUX_PRIORITY_HIGH,
+
+    /**
+     * `SCHED_RR` at priority 10, which needs `CAP_SYS_NICE`
+     * or `RLIMIT_RTPRIO`, `POLLUX_PRIORITY_HIGH` otherwise;
+     * never sheds load
+     */
+    POLLUX_PRIORITY_REALTIME,
+
+    POLLUX_PRIORITY_MAX,
+} pollux_priority_t;
+
+/* no NUMA placement, refer to `numa` of `pollux_decode_sched_t` */
+#define POLLUX_NUMA_NONE (0)
+/* the handles of the process take the online nodes in turn */
+#define POLLUX_NUMA_AUTO (-1)
+/* node `n`, as in `/sys/devices/system/node/node<n>` */
+#define POLLUX_NUMA_NODE(n) ((int)(n) + 1)
+
+/**
+ * scheduling of the decoding thread of a handle
+ */
+typedef struct {
+    /* priority class, refer to `pollux_priority_t` */
+    pollux_priority_t priority;
+
+    /**
+     * relative CPU weight under contention, 1024 is the weight of a
+     * normal thread, like `cpu.shares` of cgroups; it is carried out
+     * with the nice value of the nearest weight and replaces the nice
+     * value of `priority`, it is ignored with `POLLUX_PRIORITY_REALTIME`;
+     * 0: the weight of `priority`
+     */
+    unsigned int cpu_share;
+
+    /**
+     * the CPUs the decoding thread may run on, `cpu_nr` indices;
+     * 0: any CPU of the process
+     */
+    unsigned int cpu_nr;
+    const unsigned int *p_cpu;
+
+    /**
+     * NUMA node of the handle, `POLLUX_NUMA_NONE`, `POLLUX_NUMA_AUTO`
+     * or `POLLUX_NUMA_NODE(n)`, nodes 0 to 63: the frame caches and
+     * the results of the default allocator are mapped on the node
+     * (those of an `allocator` of the caller are left where it puts
+     * them), the decoding threads prefer it for the memory they
+     * allocate, and they run on the CPUs of the node unless `cpu_nr`
+     * names others; with `POLLUX_NUMA_AUTO`, the first `param_set` of
+     * a handle takes the next node and the handle keeps it, and a
+     * host with one node is left alone
+     */
+    int numa;
+} pollux_decode_sched_t;
+
+/**
+ * a converted frame borrowed from the frame cache of the decoder
+ */
+typedef struct {
+    /* width */
+    unsigned short width;
+    /* height */
+    unsigned short height;
+
+    /* format, refer to `pollux_fmt_t` */
+    pollux_fmt_t fmt;
+
+    /* plane addresses, unused planes are `NULL` */
+    unsigned char *data[4];
+    /* line size of each plane in bytes */
+    int linesize[4];
+
+    /**
+     * index of the frame cache, with caller-owned buffers it is the
+     * index of the buffer in `pp_buf` of `pollux_decode_ext_buf_t`
+     */
+    unsigned int index;
+
+    /**
+     * the token of the frame cache,
+     * pass it to `frame_release` if the frame is retained
+     */
+    int token;
+
+    /* presentation time in microseconds, refer to `pollux_decode_result_t` */
+    long long pts_us;
+    /* index of the frame, refer to `pollux_decode_result_t` */
+    unsigned long long frame_idx;
+
+    /**
+     * number of output ticks the frame stands for, refer to `fps`
+     * of the `pollux_decode_param_t` struct; the frame is handed
+     * over only once, the caller repeats it itself
+     */
+    unsigned int repeat_nr;
+} pollux_decode_frame_view_t;
+
+/* the frame cache goes back to the decoder when the callback returns */
+#define POLLUX_FRAME_RELEASE (0)
+/* the caller keeps the frame cache until it calls `frame_release` */
+#define POLLUX_FRAME_RETAIN (1)
+
+/**
+ * @brief frame ready callback, it is invoked in the decoding thread
+ *  right after the frame is converted
+ * 
+ * @param[in] p_view: the converted frame, only valid during the call
+ *  unless the frame is retained
+ * @param[in] p_user: `p_user` in the `pollux_decode_param_t` struct
+ * 
+ * @return `POLLUX_FRAME_RELEASE` or `POLLUX_FRAME_RETAIN`
+ * 
+ * @note the callback runs on the decoding thread and delays the
+ *  decoding of the next frame, keep it short; it must not call
+ *  `param_set` or `release` of the same handle
+ */
+typedef int (*pollux_decode_on_frame_t)(
+    const pollux_decode_frame_view_t *p_view, void *p_user);
+
+/**
+ * memory allocator of the frame caches and the result buffers;
+ * the callbacks may be called from any thread, and also after
+ * `param_set` for the buffers allocated before
+ */
+typedef struct {
+    /**
+     * @brief allocate memory, it does not have to be zeroed
+     * 
+     * @param[in] p_user: `p_user` of the allocator
+     * @param[in] size: the size in bytes
+     * @param[in] alignment: the alignment of the address, a power of 2
+     * 
+     * @return the memory, `NULL` on failure
+     */
+    void *(*alloc)(void *p_user, size_t size, size_t alignment);
+
+    /**
+     * @brief free memory from `alloc`
+     * 
+     * @param[in] p_user: `p_user` of the allocator
+     * @param[in] ptr: the memory
+     * @param[in] size: the size passed to `alloc`
+     */
+    void (*free)(void *p_user, void *ptr, size_t size);
+
+    /* user data passed to the callbacks */
+    void *p_user;
+} pollux_allocator_t;
+
+/**
+ * pages behind the default allocator, refer to `page` of the
+ * `pollux_decode_param_t` struct
+ */
+typedef enum {
+    /* the aligned allocator of the C library */
+    POLLUX_PAGE_DEFAULT = 0,
+
+    /**
+     * buffers of 1 MB and more are mapped on 2 MB huge pages and
+     * faulted in at once, so the decoding thread neither takes a page
+     * fault per 4 KB on the first frames nor a TLB miss per 4 KB
+     * while it converts; the huge pages come from the `hugetlbfs` pool
+     * (`/proc/sys/vm/nr_hugepages`), or from transparent huge pages
+     * when the pool is empty, or from ordinary pages at last.
+     * each buffer is rounded up to a multiple of 2 MB
+     */
+    POLLUX_PAGE_HUGE,
+
+    POLLUX_PAGE_MAX,
+} pollux_page_t;
+
+/**
+ * caller-owned buffers used as the frame caches of the decoder,
+ * the decoding thread converts frames straight into them
+ */
+typedef struct {
+    /**
+     * number of buffers, no more than `POLLUX_FRAME_NR_MAX`;
+     * 0: the decoder allocates the frame caches itself
+     */
+    unsigned int nr;
+
+    /**
+     * buffer addresses, each one is at least the size given by
+     * `pollux_decode_buf_size`, aligned to `alignment` of the
+     * `pollux_decode_yuv_t` struct;
+     * the buffers must stay valid until the next `param_set`
+     * or `release`
+     */
+    unsigned char **pp_buf;
+} pollux_decode_ext_buf_t;
+
+/**
+ * frame caches in shared memory, published to other processes
+ * as a ring, refer to `pollux_shm.h` for the protocol and the readers
+ */
+typedef struct {
+    /**
+     * number of slots of the ring, 2 to `POLLUX_FRAME_NR_MAX`;
+     * the decoding thread converts each frame into the next slot and
+     * never waits for the readers, a reader may fall `slot_nr - 1`
+     * frames behind before it loses frames.
+     * the frames go to the ring only, `result_get` and the like return
+     * `POLLUX_ERR_UNSUPPORTED`, refer to `shm_fd_get`;
+     * not available for the tensor formats, nor with `on_frame`
+     * or `ext_buf`;
+     * 0: no shared memory
+     */
+    unsigned int slot_nr;
+
+    /* name of the memfd, for `/proc/<pid>/fd` only; `NULL`: "pollux" */
+    const char *p_name;
+} pollux_decode_shm_t;
+
+typedef struct {
+    /**
+     * output frames per second.
+     * 
+     * the source is decoded at its native rate, paced by the
+     * timestamps; each output tick `n` at `n / fps` seconds shows
+     * the frame presented at that time. a frame without a tick is
+     * dropped before it is converted, a frame with several ticks is
+     * converted once and `result_get` returns it again for each
+     * of them, with `pts_us` of the tick
+     * 
+     * 0: the native rate, every frame is delivered once
+     */
     unsigned short fps;
 
     /** 
@@ -38,6 +430,49 @@ typedef struct {
      */
     unsigned short is_loop;
 
+    /* frame delivery mode, refer to `pollux_delivery_t` */
+    pollux_delivery_t delivery;
+
+    /**
+     * the policy when the frame cache is exhausted,
+     * refer to `pollux_drop_t`;
+     * ignored when `delivery` is `POLLUX_DELIVERY_MAILBOX`
+     */
+    pollux_drop_t drop;
+
+    /**
+     * frame ready callback, refer to `pollux_decode_on_frame_t`;
+     * when it is set, frames bypass the result queue and
+     * `result_get` / `result_try_get` return `POLLUX_ERR_UNSUPPORTED`;
+     * not available for the tensor formats
+     */
+    pollux_decode_on_frame_t on_frame;
+    /* user data passed to `on_frame` */
+    void *p_user;
+
+    /**
+     * caller-owned frame buffers, refer to `pollux_decode_ext_buf_t`;
+     * not available for the tensor formats
+     */
+    pollux_decode_ext_buf_t ext_buf;
+
+    /* shared memory frame ring, refer to `pollux_decode_shm_t` */
+    pollux_decode_shm_t shm;
+
+    /**
+     * allocator of the frame caches of `yuv` and the renditions,
+     * and of the buffers of `pollux_decode_result_alloc` and
+     * `pollux_decode_batch_alloc`, refer to `pollux_allocator_t`;
+     * `alloc` and `free` are set together or not at all.
+     * `NULL` `alloc`: the default aligned allocator of the C library
+     */
+    pollux_allocator_t allocator;
+    /**
+     * pages of the default allocator, refer to `pollux_page_t`;
+     * ignored with an `allocator` of the caller
+     */
+    pollux_page_t page;
+
     /**
      * information of the yuv settings, the function
      * `pollux_decode_result_alloc` will request memory
@@ -45,17 +480,125 @@ typedef struct {
      */
     pollux_decode_yuv_t yuv;
 
+    /**
+     * number of additional renditions, no more than
+     * `POLLUX_RENDITION_MAX`; 0: only `yuv` is produced
+     */
+    unsigned int rendition_nr;
+    /**
+     * settings of the additional renditions, `rendition_nr` elements;
+     * each decoded frame is converted once more for every rendition,
+     * rendition `i + 1` of `result_rendition_get` is `p_rendition[i]`.
+     * the renditions are always delivered in decoding order and never
+     * hold up the decoder, when the consumer falls behind the oldest
+     * frames are discarded; `delivery`, `drop`, `on_frame` and
+     * `ext_buf` apply to `yuv` only, and the frames repeated by
+     * `fps` are delivered to the renditions only once
+     */
+    const pollux_decode_yuv_t *p_rendition;
+
+    /* audio output, refer to `pollux_decode_audio_t` */
+    pollux_decode_audio_t audio;
+
+    /* load shedding, refer to `pollux_decode_shed_t` */
+    pollux_decode_shed_t shed;
+
+    /* scheduling of the decoding thread, refer to `pollux_decode_sched_t` */
+    pollux_decode_sched_t sched;
+
+    /**
+     * number of threads decoding the file in parallel, for extracting
+     * the whole file ahead of time; no more than `POLLUX_SEGMENT_THD_MAX`.
+     * 
+     * the file is cut into segments, each thread decodes its segments
+     * with a demuxer and a decoder of its own, and the frames are
+     * delivered in order through the frame caches as usual; about one
+     * GOP per segment is decoded twice. the frames are not paced,
+     * they are delivered as fast as they are taken.
+     * 
+     * it requires an input that can seek and has a duration, `is_loop`
+     * 0 and no `audio`; `seek` returns `POLLUX_ERR_UNSUPPORTED`.
+     * a segment that cannot be sought to or read ends the delivery
+     * after the frames before it, with `POLLUX_ERR_DECODE_THD_EXIT`
+     * instead of `POLLUX_ERR_FILE_END`.
+     * 
+     * 0 or 1: one decoding thread, paced by the timestamps
+     */
+    unsigned short segment_thd_nr;
+
     /* source stream file path */
     const char *p_file;
+
+    /**
+     * 1: decode the stream `stream_index` of the file, which must be
+     *  a video stream;
+     * 0: decode the video stream ffmpeg rates best;
+     * the other streams of the file are discarded by the demuxer
+     */
+    unsigned short is_stream_index;
+    /* index of the stream in the file, refer to `is_stream_index` */
+    unsigned int stream_index;
+    /**
+     * 1: the demuxer returns the packets of the other streams as well
+     *  and the decoding thread drops them, which only costs time, it
+     *  is meant to measure what the discarding saves;
+     * 0: the other streams are discarded by the demuxer
+     */
+    unsigned short is_discard_off;
+
+    /**
+     * the sidecar file of the keyframe index used by `seek`;
+     * when the demuxer does not list every frame, the index is built
+     * by scanning the file in the background after `param_set` and is
+     * saved to this file, later handles load it from here instead.
+     * the sidecar is ignored once the source file changes;
+     * `NULL`: nothing is saved, every handle scans again
+     */
+    const char *p_index_file;
+
+    /**
+     * upper bound of the bytes read to probe the streams,
+     * 0: the ffmpeg default
+     */
+    long long probesize;
+    /**
+     * upper bound of the media duration analyzed to probe the streams,
+     * unit: microsecond; 0: the ffmpeg default
+     */
+    long long analyzeduration;
+
+    /**
+     * the file the pipeline events are written to by `release`,
+     * in the Chrome trace event format (`chrome://tracing`, perfetto);
+     * only used if the library is built with `POLLUX_TRACE`;
+     * `NULL`: refer to `trace_dump`
+     */
+    const char *p_trace_file;
 } pollux_decode_param_t;
 
+/**
+ * a luma pyramid level in the buffer of `pollux_decode_result_t`
+ */
+typedef struct {
+    /* width */
+    unsigned short width;
+    /* height */
+    unsigned short height;
+    /* the distance in bytes between two lines */
+    unsigned short stride;
+
+    /* the offset in bytes of the level from the start of `buf` */
+    unsigned int offset;
+} pollux_decode_level_t;
+
 typedef struct {
     /* width */
     unsigned short width;
     /* height */
     unsigned short height;
     /**
-     * stride, which will be filled after calling the
+     * stride, the distance in bytes between two lines of the
+     * first plane, which will be filled after calling the
      * function `pollux_decode_result_alloc`
      */
     unsigned short stride;
@@ -63,13 +606,207 @@ typedef struct {
     /* format, refer to `pollux_fmt_t` */
     pollux_fmt_t fmt;
 
+    /**
+     * presentation time in microseconds, relative to the start of
+     * the stream; with `is_loop` it keeps increasing across the loops;
+     * with a non-zero `fps` it is the time of the output tick
+     */
+    long long pts_us;
+    /**
+     * index of the frame in the stream, counted in the order the
+     * decoder outputs them, including the frames dropped later;
+     * with `is_loop` it keeps increasing across the loops
+     */
+    unsigned long long frame_idx;
+
+    /**
+     * number of valid elements in `level`, 0 without pyramid;
+     * the scaled levels are stored in `buf` behind the frame and
+     * are filled by `result_get` / `result_try_get` only
+     */
+    unsigned short level_nr;
+    /* luma pyramid levels, refer to `pyramid_nr` */
+    pollux_decode_level_t level[POLLUX_PYRAMID_MAX];
+
     /**
      * the buffer of the yuv,
      * which is allocated in the function `pollux_decode_result_alloc`
      */
     unsigned char *buf;
+    /* the size of `buf` in bytes */
+    size_t buf_size;
+    /**
+     * the allocator `buf` comes from, `pollux_decode_result_free`
+     * gives it back there
+     */
+    pollux_allocator_t allocator;
 } pollux_decode_result_t;
 
+typedef struct {
+    /* sample rate */
+    unsigned int sample_rate;
+    /* number of channels */
+    unsigned short channels;
+    /* sample format, refer to `pollux_sample_fmt_t` */
+    pollux_sample_fmt_t fmt;
+
+    /* number of samples per channel in `buf` */
+    unsigned int sample_nr;
+
+    /**
+     * presentation time of the first sample in microseconds,
+     * on the same timeline as `pts_us` of `pollux_decode_result_t`
+     */
+    long long pts_us;
+
+    /**
+     * number of decoded chunks discarded since `param_set`
+     * because the consumer fell behind
+     */
+    unsigned long long drop_nr;
+
+    /**
+     * interleaved samples, `size` bytes can be held;
+     * it is exchanged with the decoder on every `audio_get`,
+     * so both the address and the size may change
+     */
+    unsigned char *buf;
+    size_t size;
+} pollux_decode_audio_result_t;
+
+typedef enum {
+    /**
+     * planes one after another, each line padded to `stride`,
+     * the same layout as the buffer of `pollux_decode_result_t`
+     * (NCHW-style)
+     */
+    POLLUX_LAYOUT_PLANAR = 0,
+
+    /**
+     * components of a pixel next to each other, lines without
+     * padding (NHWC-style), only `POLLUX_FMT_444P` supports it
+     */
+    POLLUX_LAYOUT_PACKED,
+
+    POLLUX_LAYOUT_MAX,
+} pollux_layout_t;
+
+/**
+ * meta data of a frame in `pollux_decode_batch_t`
+ */
+typedef struct {
+    /* width */
+    unsigned short width;
+    /* height */
+    unsigned short height;
+    /* the distance in bytes between two lines of the first plane */
+    unsigned int stride;
+
+    /* format, refer to `pollux_fmt_t` */
+    pollux_fmt_t fmt;
+
+    /* presentation time in microseconds, refer to `pollux_decode_result_t` */
+    long long pts_us;
+    /* index of the frame, refer to `pollux_decode_result_t` */
+    unsigned long long frame_idx;
+} pollux_decode_meta_t;
+
+typedef struct {
+    /* the maximum number of frames the batch holds */
+    unsigned int frame_nr;
+
+    /* layout of every frame, refer to `pollux_layout_t` */
+    pollux_layout_t layout;
+
+    /**
+     * the distance in bytes between two frames in `buf`,
+     * which is filled in the function `pollux_decode_batch_alloc`
+     */
+    size_t frame_size;
+
+    /**
+     * continuous buffer of `frame_nr * frame_size` bytes,
+     * frame `i` starts at `buf + i * frame_size`
+     */
+    unsigned char *buf;
+
+    /* meta data, `frame_nr` elements */
+    pollux_decode_meta_t *p_meta;
+
+    /* the allocator `buf` comes from, refer to `pollux_decode_result_t` */
+    pollux_allocator_t allocator;
+} pollux_decode_batch_t;
+
+/**
+ * stages of the pipeline timed by `stats_get`
+ */
+typedef enum {
+    /* `av_read_frame`, the demuxer and the input */
+    POLLUX_STAGE_READ = 0,
+    /* `avcodec_send_packet` */
+    POLLUX_STAGE_SEND,
+    /* `avcodec_receive_frame` */
+    POLLUX_STAGE_RECEIVE,
+    /* conversion of the decoded frame, `sws_scale` and the like */
+    POLLUX_STAGE_CONVERT,
+    /* hand-over to the consumer, the `on_frame` callback included */
+    POLLUX_STAGE_DELIVER,
+    /* copy into the result, in the thread of the consumer */
+    POLLUX_STAGE_COPY,
+
+    POLLUX_STAGE_MAX,
+} pollux_stage_t;
+
+typedef struct {
+    /* number of times the stage was passed */
+    unsigned long long count;
+    /* the time spent in the stage in total, unit: nanosecond */
+    unsigned long long total_ns;
+
+    /**
+     * percentiles of a single pass, unit: nanosecond;
+     * from a histogram with 8 buckets per power of 2,
+     * so they are accurate to 12.5%
+     */
+    unsigned long long p50_ns;
+    unsigned long long p99_ns;
+    /* the longest single pass, exact */
+    unsigned long long max_ns;
+} pollux_decode_stage_stats_t;
+
+typedef struct {
+    /* the time since `param_set`, unit: microsecond */
+    long long elapsed_us;
+
+    /* packets of the decoded stream read from the file */
+    unsigned long long packet_nr;
+    /* frames out of the decoder */
+    unsigned long long decode_nr;
+    /* frames converted and handed over to the consumer */
+    unsigned long long deliver_nr;
+    /* frames discarded, the same as `drop_nr_get` */
+    unsigned long long drop_nr;
+    /* decoded frames per second over `elapsed_us` */
+    double decode_fps;
+
+    /**
+     * results ready for the consumer, the repeats of `fps` included,
+     * the same as the counter of the event descriptor
+     */
+    unsigned int ready_nr;
+
+    /* the current degradation, refer to `pollux_decode_shed_t` */
+    pollux_shed_level_t shed_level;
+    /**
+     * the smoothed lateness of the frames against the pace of their
+     * timestamps, unit: microsecond; negative when they are early
+     */
+    long long late_us;
+
+    /* refer to `pollux_stage_t` */
+    pollux_decode_stage_stats_t stage[POLLUX_STAGE_MAX];
+} pollux_decode_stats_t;
+
 /**
  * @details
  * flow:
@@ -98,7 +835,10 @@ typedef struct pollux_decode_t {
      *  the size of the result cache `pollux_decode_result_t`
      *  may no longer be appropriate, so when you call this
      *  function, you may want to ensure that the function
-     *  `result_get` exits temporarily in any thread
+     *  `result_get` exits temporarily in any thread;
+     *  a `result_get` waiting for a frame at the time returns
+     *  at once with `POLLUX_ERR_RESOURCE_REQUEST`, and the
+     *  previous decoding thread stops after at most one frame
      */
     int (*param_set)(struct pollux_decode_t *thiz,
         const pollux_decode_param_t *p_param);
@@ -137,6 +877,234 @@ typedef struct pollux_decode_t {
      */
     int (* result_get)(struct pollux_decode_t *thiz,
         pollux_decode_result_t *p_res);
+
+    /**
+     * @brief get the number of frames discarded by the decoder
+     *  since the last `param_set`, either overwritten in
+     *  `POLLUX_DELIVERY_MAILBOX` mode or dropped by `POLLUX_DROP_OLDEST`
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[out] p_nr: the number of dropped frames
+     * 
+     * @return 0 on success, error code otherwise
+     */
+    int (*drop_nr_get)(struct pollux_decode_t *thiz,
+        unsigned long long *p_nr);
+
+    /**
+     * @brief get result without blocking
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * 
+     * @return the same as `result_get`, except that
+     *  `POLLUX_ERR_AGAIN` is returned immediately when no result
+     *  is ready or the handle is busy in another thread
+     */
+    int (*result_try_get)(struct pollux_decode_t *thiz,
+        pollux_decode_result_t *p_res);
+
+    /**
+     * @brief get the event file descriptor of the handle
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[out] p_fd: the event file descriptor
+     * 
+     * @return 0 on success, error code otherwise
+     * 
+     * @note the descriptor becomes readable (`EPOLLIN`) when
+     *  `result_try_get` has something to return, either a frame or
+     *  the termination of the decoding thread; it is level-triggered
+     *  and is drained by `result_get` / `result_try_get` only,
+     *  so never read it yourself.
+     *  the descriptor is owned by the handle, it remains valid until
+     *  `pollux_decode_deinit` and must not be closed by the caller
+     */
+    int (*event_fd_get)(struct pollux_decode_t *thiz, int *p_fd);
+
+    /**
+     * @brief give a retained frame cache back to the decoder
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[in] token: `token` of the `pollux_decode_frame_view_t`
+     * 
+     * @return 0 on success;
+     * 
+     *  `POLLUX_ERR_INVALID_PARAMETER` if the token is stale or the
+     *  frame is not retained, e.g. it has been released already;
+     * 
+     *  error code otherwise
+     * 
+     * @note it may be called from any thread, including the callback;
+     *  the frames still retained or borrowed at the next `param_set`
+     *  or `release` are taken back by it, their views and tokens are
+     *  stale after it
+     */
+    int (*frame_release)(struct pollux_decode_t *thiz, int token);
+
+    /**
+     * @brief get up to `n` results into one continuous buffer
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[in] n: the maximum number of frames, no more than
+     *  `frame_nr` of the batch
+     * @param[out] p_batch: the batch from `pollux_decode_batch_alloc`
+     * @param[in] timeout_ms: the maximum time to wait for the first
+     *  frame, the following frames are only taken if already ready
+     * 
+     * @return the number of frames written to `p_batch` (> 0);
+     * 
+     *  `POLLUX_ERR_AGAIN` if no frame is ready in time;
+     * 
+     *  `POLLUX_ERR_FILE_END` / `POLLUX_ERR_DECODE_THD_EXIT`,
+     *  refer to `result_get`;
+     * 
+     *  error code otherwise
+     */
+    int (*result_get_batch)(struct pollux_decode_t *thiz,
+        unsigned int n, pollux_decode_batch_t *p_batch,
+        unsigned int timeout_ms);
+
+    /**
+     * @brief borrow a result without copying it,
+     *  the view points into the frame cache itself
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[out] p_view: the borrowed frame
+     * @param[in] timeout_ms: the maximum time to wait for a frame
+     * 
+     * @return the same as `result_get`, except that `POLLUX_ERR_AGAIN`
+     *  is returned when no frame is ready in time
+     * 
+     * @note the frame cache is not reused by the decoder until it is
+     *  given back by `frame_release` with `token` of the view, once;
+     *  the tensor formats such as `POLLUX_FMT_RGB_F32` are only
+     *  produced by copying, `POLLUX_ERR_UNSUPPORTED` is returned
+     */
+    int (*result_borrow)(struct pollux_decode_t *thiz,
+        pollux_decode_frame_view_t *p_view, unsigned int timeout_ms);
+
+    /**
+     * @brief get result of a rendition
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[in] index: 0 is `yuv` of the `pollux_decode_param_t`
+     *  struct, the same as `result_get`; `i` (> 0) is `p_rendition[i - 1]`
+     * @param[out] p_res: the result from
+     *  `pollux_decode_result_rendition_alloc` with the same `index`
+     * 
+     * @return the same as `result_get`
+     */
+    int (*result_rendition_get)(struct pollux_decode_t *thiz,
+        unsigned int index, pollux_decode_result_t *p_res);
+
+    /**
+     * @brief move the decoder to another position of the stream
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[in] target: a time in microseconds or a frame index,
+     *  refer to `pollux_seek_t`
+     * @param[in] mode: refer to `pollux_seek_t`
+     * 
+     * @return 0 on success;
+     * 
+     *  `POLLUX_ERR_FILE_END` / `POLLUX_ERR_DECODE_THD_EXIT` if the
+     *  decoding thread has already terminated, refer to `result_get`;
+     * 
+     *  error code otherwise
+     * 
+     * @note the function returns once the decoding thread has moved,
+     *  the frames not yet taken are discarded and the next result is
+     *  the target frame, `pts_us` and `frame_idx` continue from there;
+     *  retained or borrowed frames are not affected.
+     *  the seek decodes from the nearest keyframe before the target
+     *  according to the keyframe index, until the index is ready
+     *  the demuxer seeks by time and `POLLUX_SEEK_FRAME` is
+     *  converted to a time by the frame rate; `frame_idx` of the
+     *  first frame decoded is then its timestamp times the frame rate
+     */
+    int (*seek)(struct pollux_decode_t *thiz,
+        long long target, pollux_seek_t mode);
+
+    /**
+     * @brief get a chunk of audio, the samples of one decoded frame,
+     *  without waiting
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[out] p_res: the result from
+     *  `pollux_decode_audio_result_alloc`
+     * 
+     * @return 0 on success;
+     * 
+     *  `POLLUX_ERR_AGAIN` if no chunk is ready;
+     * 
+     *  `POLLUX_ERR_UNSUPPORTED` if `audio` of the parameters
+     *  is not enabled;
+     * 
+     *  `POLLUX_ERR_FILE_END` / `POLLUX_ERR_DECODE_THD_EXIT` once the
+     *  decoding thread has terminated and every chunk is taken,
+     *  refer to `result_get`;
+     * 
+     *  error code otherwise
+     * 
+     * @note the audio is demuxed and decoded by the decoding thread
+     *  along with the video, and is paced by the video; the chunks
+     *  pass through a single-producer ring that the decoding thread
+     *  never waits on, when the consumer falls behind the newest
+     *  chunks are discarded and counted in `drop_nr`.
+     *  it may be called from another thread than `result_get`
+     */
+    int (*audio_get)(struct pollux_decode_t *thiz,
+        pollux_decode_audio_result_t *p_res);
+
+    /**
+     * @brief get the statistics of the handle since the last `param_set`
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[out] p_stats: the statistics
+     * 
+     * @return 0 on success, error code otherwise
+     * 
+     * @note the counters are updated without locks while the handle
+     *  runs, so the fields of one snapshot may be a frame apart;
+     *  it never waits, and may be called from any thread
+     */
+    int (*stats_get)(struct pollux_decode_t *thiz,
+        pollux_decode_stats_t *p_stats);
+
+    /**
+     * @brief write the timeline of the latest pipeline events
+     *  (read, send, receive, scale, enqueue, dequeue, copy)
+     *  in the Chrome trace event format
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[in] p_file: the JSON file, it is overwritten
+     * 
+     * @return 0 on success, `POLLUX_ERR_UNSUPPORTED` if the library
+     *  is built without `POLLUX_TRACE`, error code otherwise
+     * 
+     * @note the events are recorded by each thread into a ring of its
+     *  own without locks, the oldest ones are overwritten;
+     *  it may be called while the handle runs
+     */
+    int (*trace_dump)(struct pollux_decode_t *thiz, const char *p_file);
+
+    /**
+     * @brief get the memfd of the shared memory frame ring,
+     *  refer to `shm` of the `pollux_decode_param_t` struct
+     * 
+     * @param[in] thiz: the handle of type `pollux_decode_t`
+     * @param[out] p_fd: the memfd
+     * 
+     * @return 0 on success, `POLLUX_ERR_UNSUPPORTED` if the frames
+     *  do not go to shared memory, error code otherwise
+     * 
+     * @note the descriptor is owned by the handle, it is closed by the
+     *  next `param_set` or `release`, and the ring is ended for its
+     *  readers; pass it to the readers over a unix socket
+     *  (`SCM_RIGHTS`), or let them open `/proc/<pid>/fd/<fd>`,
+     *  then `pollux_shm_reader_open`
+     */
+    int (*shm_fd_get)(struct pollux_decode_t *thiz, int *p_fd);
 } pollux_decode_t;
 
 /**
@@ -158,12 +1126,110 @@ pollux_decode_result_free(pollux_decode_result_t *p_result);
  * @return 0 on success, error code otherwise
  * 
  * @note the function assigns a value to the `stride`
- *  member in the `pollux_decode_result_t` struct
+ *  member in the `pollux_decode_result_t` struct; `buf` is zeroed,
+ *  whatever `allocator` it comes from, the stride padding keeps
+ *  these zeros
  */
 int
 pollux_decode_result_alloc(pollux_decode_t *p_handle,
     pollux_decode_result_t **pp_ressult);
 
+/**
+ * @brief allocate a `pollux_decode_result_t` struct for a rendition,
+ *  refer to `result_rendition_get`
+ * 
+ * @param[in] p_handle: the handle of type `pollux_decode_t`
+ * @param[in] index: index of the rendition, 0 is the same as
+ *  `pollux_decode_result_alloc`
+ * @param[out] pp_ressult: the pointer of `pollux_decode_result_t`
+ * 
+ * @return 0 on success, error code otherwise
+ */
+int
+pollux_decode_result_rendition_alloc(pollux_decode_t *p_handle,
+    unsigned int index, pollux_decode_result_t **pp_ressult);
+
+/**
+ * @brief free the memory for the `pollux_decode_audio_result_t` struct
+ * 
+ * @param[in] p_result: the pointer of `pollux_decode_audio_result_t`
+ */
+void
+pollux_decode_audio_result_free(pollux_decode_audio_result_t *p_result);
+
+/**
+ * @brief allocate a `pollux_decode_audio_result_t` struct,
+ *  refer to `audio_get`
+ * 
+ * @param[out] pp_result: the pointer of `pollux_decode_audio_result_t`
+ * 
+ * @return 0 on success, error code otherwise
+ * 
+ * @note the sample buffer is provided by `audio_get`
+ */
+int
+pollux_decode_audio_result_alloc(pollux_decode_audio_result_t **pp_result);
+
+/**
+ * @brief get the size of a caller-owned frame buffer,
+ *  refer to `pollux_decode_ext_buf_t`
+ * 
+ * @param[in] p_yuv: the yuv settings passed to `param_set`
+ * @param[out] p_size: the size in bytes
+ * 
+ * @return 0 on success, error code otherwise
+ */
+int
+pollux_decode_buf_size(const pollux_decode_yuv_t *p_yuv,
+    size_t *p_size);
+
+/**
+ * @brief free the memory for the `pollux_decode_batch_t` struct
+ * 
+ * @param[in] p_batch: the pointer of `pollux_decode_batch_t`
+ */
+void
+pollux_decode_batch_free(pollux_decode_batch_t *p_batch);
+
+/**
+ * @brief allocate a `pollux_decode_batch_t` struct,
+ *  the function `param_set` needs to be called before calling
+ *  this function
+ * 
+ * @param[in] p_handle: the handle of type `pollux_decode_t`
+ * @param[in] frame_nr: the maximum number of frames
+ * @param[in] layout: layout of the frames, refer to `pollux_layout_t`
+ * @param[out] pp_batch: the pointer of `pollux_decode_batch_t`
+ * 
+ * @return 0 on success, error code otherwise
+ * 
+ * @note `buf` is zeroed, as by `pollux_decode_result_alloc`
+ */
+int
+pollux_decode_batch_alloc(pollux_decode_t *p_handle,
+    unsigned int frame_nr, pollux_layout_t layout,
+    pollux_decode_batch_t **pp_batch);
+
+/**
+ * @brief configure the probe cache shared by all handles of the process
+ * 
+ * @param[in] entry_nr: the maximum number of files remembered,
+ *  0 disables the cache
+ * @param[in] p_file: the file the cache is loaded from and saved to,
+ *  `NULL` keeps the cache in memory only
+ * 
+ * @return 0 on success, error code otherwise
+ * 
+ * @note
+ *  the stream parameters probed on the first `param_set` of a file are
+ *  remembered by path, size and modification time, so a later
+ *  `param_set` of the same file skips `avformat_find_stream_info`;
+ *  by default the cache holds 256 files in memory only,
+ *  call this before the first `param_set`
+ */
+int
+pollux_decode_probe_cache_set(unsigned int entry_nr, const char *p_file);
+
 /**
  * @brief deinit the pollux decode module
  * 
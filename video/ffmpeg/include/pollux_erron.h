@@ -8,6 +8,7 @@
 #define POLLUX_ERR_TIMEOUT              (-10000)        // 超时
 #define POLLUX_ERR_NULL_POINTER         (-10001)        // 指针为空
 #define POLLUX_ERR_INVALID_PARAMETER    (-10002)        // 参数无效
+#define POLLUX_ERR_UNSUPPORTED          (-10003)        // 当前配置下不支持该操作
 
 /* function */
 #define POLLUX_ERR_INVALID_ENTRY        (-11000)        // 函数入参无效
@@ -22,5 +23,6 @@
 /* decode */
 #define POLLUX_ERR_DECODE_THD_EXIT      (-15000)        // 解码线程已退出
 #define POLLUX_ERR_FILE_END             (-15001)        // 文件读取至末尾，此宏在非循环读取时可能使用
+#define POLLUX_ERR_AGAIN                (-15002)        // 暂无可用结果，稍后重试
 
 #endif // __POLLUX_ERRNO_H__
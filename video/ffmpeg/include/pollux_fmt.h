@@ -13,7 +13,44 @@ typedef enum {
     /* yuv nv12 */
     POLLUX_FMT_NV12,
 
+    /**
+     * yuv 4:2:0, 10 bits in the high bits of little-endian
+     * 16-bit words, y plane followed by interleaved uv plane
+     */
+    POLLUX_FMT_P010,
+
+    /**
+     * yuv 4:2:0 planar, 10 bits in the low bits of little-endian
+     * 16-bit words, the u and v lines are half the `stride`
+     */
+    POLLUX_FMT_YUV420P10,
+
+    /* yuv 4:4:4 planar, little-endian 16-bit words */
+    POLLUX_FMT_YUV444P16,
+
+    /**
+     * rgb float32 planes (CHW), lines without padding,
+     * each channel normalized by `mean` and `std`
+     * of the `pollux_decode_yuv_t` struct
+     */
+    POLLUX_FMT_RGB_F32,
+
     POLLUX_FMT_MAX,
 } pollux_fmt_t;
 
+typedef enum {
+    POLLUX_SAMPLE_FMT_NONE = -1,
+
+    /* signed 16 bits, channels interleaved */
+    POLLUX_SAMPLE_FMT_S16,
+
+    /* signed 32 bits, channels interleaved */
+    POLLUX_SAMPLE_FMT_S32,
+
+    /* float32, channels interleaved */
+    POLLUX_SAMPLE_FMT_F32,
+
+    POLLUX_SAMPLE_FMT_MAX,
+} pollux_sample_fmt_t;
+
 #endif // __POLLUX_FMT_H__
@@ -0,0 +1,184 @@
+#ifndef __POLLUX_JEMALLOC_H__
+#define __POLLUX_JEMALLOC_H__
+
+/**
+ * @details
+ * an adapter of `pollux_allocator_t` that puts the frame caches and
+ * the results of a handle in a jemalloc arena of their own, so that
+ * the hundreds of MB of frames neither fragment nor bloat the arenas
+ * of the rest of the process, and can be told apart in the jemalloc
+ * statistics (`stats.arenas.<i>.*`).
+ * 
+ * it is header-only, the program links jemalloc itself, built
+ * without a symbol prefix (`mallocx`, not `je_mallocx`), such as
+ * the static library of `memory/jemalloc/example/lib` in this
+ * repository; `<jemalloc/jemalloc.h>` is used if it can be found,
+ * the few declarations the adapter needs stand in for it otherwise.
+ * 
+ * usage:
+ *  pollux_jemalloc_arena_t arena;
+ *  pollux_jemalloc_arena_create(&arena);
+ *  param.allocator = arena.allocator;
+ *  ... param_set, results, release ...
+ *  pollux_jemalloc_arena_destroy(&arena);
+ */
+
+#include "pollux_decode.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__has_include)
+#if __has_include(<jemalloc/jemalloc.h>)
+#define POLLUX_JEMALLOC_HEADER
+#endif
+#endif
+
+#ifdef POLLUX_JEMALLOC_HEADER
+#include <jemalloc/jemalloc.h>
+#else
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the non-standard API of jemalloc 5, refer to `man jemalloc` */
+void *mallocx(size_t size, int flags);
+void dallocx(void *ptr, int flags);
+int mallctl(const char *name,
+    void *oldp, size_t *oldlenp, void *newp, size_t newlen);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* `a` is a power of 2 */
+#define MALLOCX_ALIGN(a) ((int)(__builtin_ctzll((unsigned long long)(a))))
+#define MALLOCX_TCACHE_NONE ((int)(1 << 8))
+#define MALLOCX_ARENA(a) ((int)(((unsigned int)(a) + 1) << 20))
+
+#endif // POLLUX_JEMALLOC_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    /* index of the arena */
+    unsigned int index;
+    /* the allocator to pass to `param_set` */
+    pollux_allocator_t allocator;
+} pollux_jemalloc_arena_t;
+
+/**
+ * the thread caches are bypassed, the frames are large and freed by
+ * other threads than the ones that allocated them
+ */
+static inline void *
+pollux_jemalloc_alloc(void *p_user, size_t size, size_t alignment)
+{
+    unsigned int index = (unsigned int)(uintptr_t)p_user;
+    return mallocx(size, MALLOCX_ALIGN(alignment) |
+        MALLOCX_ARENA(index) | MALLOCX_TCACHE_NONE);
+}
+
+/**
+ * not `sdallocx`, its size class would have to be looked up with the
+ * alignment of the allocation, which the free does not know
+ */
+static inline void
+pollux_jemalloc_free(void *p_user, void *ptr, size_t size)
+{
+    (void)p_user;
+    (void)size;
+
+    dallocx(ptr, MALLOCX_TCACHE_NONE);
+}
+
+/**
+ * @brief create a jemalloc arena and the allocator of it
+ * 
+ * @param[out] p_arena: the arena
+ * 
+ * @return 0 on success, error code otherwise
+ */
+static inline int
+pollux_jemalloc_arena_create(pollux_jemalloc_arena_t *p_arena)
+{
+    if (!(p_arena)) return POLLUX_ERR_INVALID_ENTRY;
+
+    unsigned int index;
+    size_t len = sizeof(index);
+    if (mallctl("arenas.create", &index, &len, NULL, 0))
+        return POLLUX_ERR_RESOURCE_REQUEST;
+
+    p_arena->index = index;
+    p_arena->allocator.alloc = pollux_jemalloc_alloc;
+    p_arena->allocator.free = pollux_jemalloc_free;
+    p_arena->allocator.p_user = (void *)(uintptr_t)index;
+
+    return POLLUX_OK;
+}
+
+/**
+ * @brief get the bytes the arena has handed out and not yet taken back
+ * 
+ * @param[in] p_arena: the arena
+ * @param[out] p_size: the size in bytes
+ * 
+ * @return 0 on success, error code otherwise
+ * 
+ * @note jemalloc must be built with statistics, they are
+ *  refreshed by `epoch`
+ */
+static inline int
+pollux_jemalloc_arena_allocated(const pollux_jemalloc_arena_t *p_arena,
+    size_t *p_size)
+{
+    if (!(p_arena) || !(p_size)) return POLLUX_ERR_INVALID_ENTRY;
+
+    uint64_t epoch = 1;
+    size_t len = sizeof(epoch);
+    mallctl("epoch", &epoch, &len, &epoch, len);
+
+    char name[64];
+    size_t small = 0, large = 0;
+    len = sizeof(size_t);
+    snprintf(name, sizeof(name),
+        "stats.arenas.%u.small.allocated", p_arena->index);
+    if (mallctl(name, &small, &len, NULL, 0)) return POLLUX_ERR_UNSUPPORTED;
+    snprintf(name, sizeof(name),
+        "stats.arenas.%u.large.allocated", p_arena->index);
+    if (mallctl(name, &large, &len, NULL, 0)) return POLLUX_ERR_UNSUPPORTED;
+
+    *p_size = small + large;
+    return POLLUX_OK;
+}
+
+/**
+ * @brief destroy the arena, with all of the memory still in it
+ * 
+ * @param[in] p_arena: the arena
+ * 
+ * @return 0 on success, error code otherwise
+ * 
+ * @note every handle and result using it must be released before
+ */
+static inline int
+pollux_jemalloc_arena_destroy(pollux_jemalloc_arena_t *p_arena)
+{
+    if (!(p_arena)) return POLLUX_ERR_INVALID_ENTRY;
+
+    char name[64];
+    snprintf(name, sizeof(name), "arena.%u.destroy", p_arena->index);
+    return (mallctl(name, NULL, NULL, NULL, 0)) ?
+        POLLUX_ERR : POLLUX_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __POLLUX_JEMALLOC_H__
@@ -0,0 +1,237 @@
+#ifndef __POLLUX_SHM_H__
+#define __POLLUX_SHM_H__
+
+#include "pollux_fmt.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @details
+ * the frame ring shared with other processes, refer to `shm` of the
+ * `pollux_decode_param_t` struct and `shm_fd_get`.
+ * 
+ * the frame caches of the handle live in a memfd, the decoding thread
+ * converts every frame straight into the next slot of the ring and
+ * publishes it, the readers map the memfd and read the frames where
+ * they are. the writer never waits for the readers, a reader that
+ * falls behind by more than `slot_nr - 1` frames loses the oldest
+ * ones; any number of readers may map the ring.
+ * 
+ * layout, in the byte order of the host:
+ *  offset 0                `pollux_shm_header_t`
+ *  offset `slot_offset`    `pollux_shm_slot_t`, `slot_nr` elements
+ *  offset `data_offset`    the frame of slot 0, then the frame of
+ *                          slot `i` at `data_offset + i * slot_size`
+ * 
+ * `head` is the number of frames published so far, frame `n`
+ * (counting from 0, modulo 2^32) is in slot `n % slot_nr`.
+ * 
+ * the writer, for frame `n` (`n` equals `head`):
+ *  (1) `seq` of the slot += 1 (now odd), release fence
+ *  (2) the frame and the rest of the slot are written,
+ *      `frame_nr` of the slot is set to `n`
+ *  (3) `seq` of the slot += 1 (even again), store-release
+ *  (4) `head` = `n + 1`, store-release, and a `FUTEX_WAKE` on `head`
+ * a frame that fails is not published: (2) stops, `seq` goes even
+ * again in (3) and `head` stays, the slot is written anew for the
+ * next frame; the readers never read the slot of frame `head`.
+ * 
+ * a reader, for frame `n`:
+ *  (1) load-acquire `head`, while it equals `n` the frame is not
+ *      published yet, `FUTEX_WAIT` on `head` with the value `n`;
+ *      if `head - n >= slot_nr`, the slot has been reused, skip to
+ *      frame `head - slot_nr + 1`
+ *  (2) load-acquire `seq` of the slot, it is odd or `frame_nr` is not
+ *      `n` if the writer has already moved on: skip the frame
+ *  (3) read the frame
+ *  (4) acquire fence, load `seq` again; the frame read in (3) is only
+ *      valid if it is unchanged, otherwise it was overwritten while
+ *      being read and must be discarded
+ * 
+ * the futex word is shared between processes, the waits and wakes
+ * must not use `FUTEX_PRIVATE_FLAG`. once `state` becomes
+ * `POLLUX_SHM_STATE_END` no more frames are published.
+ * 
+ * the memfd is sealed against resizing, so the mapping is always
+ * backed; the readers only need to map it read-only.
+ * `pollux_shm_reader_*` implement the reader side.
+ */
+
+/* `magic` of the header, "PLXR" */
+#define POLLUX_SHM_MAGIC (0x52584c50u)
+/* `version` of the header, changed with any change of the layout */
+#define POLLUX_SHM_VERSION (1u)
+
+/* frames are being published */
+#define POLLUX_SHM_STATE_RUNNING (0u)
+/**
+ * no more frames are published, the file has been decoded to the end
+ * or the handle has moved on to the next `param_set` / `release`
+ */
+#define POLLUX_SHM_STATE_END (1u)
+
+typedef struct {
+    /* `POLLUX_SHM_MAGIC` */
+    uint32_t magic;
+    /* `POLLUX_SHM_VERSION` */
+    uint32_t version;
+
+    /* number of slots */
+    uint32_t slot_nr;
+    /* width of the frames */
+    uint32_t width;
+    /* height of the frames */
+    uint32_t height;
+    /* format of the frames, refer to `pollux_fmt_t` */
+    int32_t fmt;
+    /* line size of each plane in bytes, 0 for unused planes */
+    int32_t linesize[4];
+    /* offset of each plane from the start of the frame */
+    uint32_t plane_offset[4];
+    /* size of a frame in bytes */
+    uint64_t frame_size;
+
+    /* offset of the slot array from the start of the region */
+    uint64_t slot_offset;
+    /* offset of the frame of slot 0 from the start of the region */
+    uint64_t data_offset;
+    /* distance between the frames of two slots, a multiple of the page */
+    uint64_t slot_size;
+    /* size of the whole region */
+    uint64_t region_size;
+
+    /* process id of the writer */
+    int32_t writer_pid;
+    /* `POLLUX_SHM_STATE_*`, written with store-release */
+    uint32_t state;
+
+    uint8_t reserved0[24];
+
+    /**
+     * number of frames published, the futex word;
+     * it has a cache line of its own
+     */
+    uint32_t head;
+
+    uint8_t reserved1[60];
+} pollux_shm_header_t;
+
+typedef struct {
+    /* odd while the slot is written, refer to the protocol */
+    uint32_t seq;
+    /* the number of the frame in the slot, refer to `head` */
+    uint32_t frame_nr;
+
+    /* presentation time in microseconds, refer to `pollux_decode_result_t` */
+    int64_t pts_us;
+    /* index of the frame, refer to `pollux_decode_result_t` */
+    uint64_t frame_idx;
+    /* number of output ticks the frame stands for, refer to `fps` */
+    uint32_t repeat_nr;
+
+    uint8_t reserved[36];
+} pollux_shm_slot_t;
+
+/**
+ * a frame in the ring, read in place
+ */
+typedef struct {
+    /* width */
+    unsigned short width;
+    /* height */
+    unsigned short height;
+    /* format, refer to `pollux_fmt_t` */
+    pollux_fmt_t fmt;
+
+    /* plane addresses in the mapping, unused planes are `NULL` */
+    const unsigned char *data[4];
+    /* line size of each plane in bytes */
+    int linesize[4];
+
+    /* presentation time in microseconds, refer to `pollux_decode_result_t` */
+    long long pts_us;
+    /* index of the frame, refer to `pollux_decode_result_t` */
+    unsigned long long frame_idx;
+    /* number of output ticks the frame stands for, refer to `fps` */
+    unsigned int repeat_nr;
+
+    /* frames lost by the reader since it was opened, this one excluded */
+    unsigned long long lost_nr;
+
+    /* private, checked by `pollux_shm_reader_check` */
+    unsigned int slot;
+    unsigned int seq;
+} pollux_shm_frame_t;
+
+/* the reader side of a ring, in any process */
+typedef struct pollux_shm_reader_t pollux_shm_reader_t;
+
+/**
+ * @brief map a frame ring
+ * 
+ * @param[in] fd: the memfd, from `shm_fd_get` of the writer, passed
+ *  over a unix socket or opened as `/proc/<pid>/fd/<fd>`; the reader
+ *  keeps its own mapping, the descriptor may be closed afterwards
+ * @param[out] pp_reader: the reader
+ * 
+ * @return 0 on success, error code otherwise
+ * 
+ * @note the first frame read is the newest one already published
+ */
+int
+pollux_shm_reader_open(int fd, pollux_shm_reader_t **pp_reader);
+
+/**
+ * @brief unmap the ring and free the reader
+ * 
+ * @param[in] p_reader: the reader
+ */
+void
+pollux_shm_reader_close(pollux_shm_reader_t *p_reader);
+
+/**
+ * @brief get the next frame of the ring
+ * 
+ * @param[in] p_reader: the reader
+ * @param[out] p_frame: the frame, it points into the ring
+ * @param[in] timeout_ms: the maximum time to wait for a frame
+ * 
+ * @return 0 on success;
+ * 
+ *  `POLLUX_ERR_AGAIN` if no frame is published in time;
+ * 
+ *  `POLLUX_ERR_FILE_END` once the writer has ended the ring
+ *  and every frame is read;
+ * 
+ *  error code otherwise
+ * 
+ * @note the writer does not wait for the reader, the frame may be
+ *  overwritten at any time; call `pollux_shm_reader_check` after
+ *  the frame has been read or copied
+ */
+int
+pollux_shm_reader_next(pollux_shm_reader_t *p_reader,
+    pollux_shm_frame_t *p_frame, unsigned int timeout_ms);
+
+/**
+ * @brief check that a frame was not overwritten while it was read
+ * 
+ * @param[in] p_reader: the reader
+ * @param[in] p_frame: the frame from `pollux_shm_reader_next`
+ * 
+ * @return 0 if whatever was read from the frame so far is intact,
+ *  `POLLUX_ERR_AGAIN` if it has to be discarded
+ */
+int
+pollux_shm_reader_check(const pollux_shm_reader_t *p_reader,
+    const pollux_shm_frame_t *p_frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __POLLUX_SHM_H__
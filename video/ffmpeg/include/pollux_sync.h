@@ -0,0 +1,177 @@
+#ifndef __POLLUX_SYNC_H__
+#define __POLLUX_SYNC_H__
+
+#include "pollux_decode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* maximum number of handles of a sync group */
+#define POLLUX_SYNC_HANDLE_MAX (16)
+
+typedef struct {
+    /* number of handles, no more than `POLLUX_SYNC_HANDLE_MAX` */
+    unsigned int handle_nr;
+
+    /**
+     * the handles to align, `handle_nr` elements;
+     * `param_set` of every handle must be called before, and they
+     * must not be read by anyone else while they are in the group
+     */
+    pollux_decode_t **pp_handle;
+
+    /**
+     * offset in microseconds added to the timestamps of each handle
+     * before they are compared, `handle_nr` elements;
+     * `NULL`: the recordings start at the same time
+     */
+    const long long *p_offset_us;
+
+    /**
+     * the maximum difference in microseconds between the
+     * timestamps of the frames of a tuple, usually no more than
+     * half of the frame interval
+     */
+    long long tolerance_us;
+} pollux_sync_param_t;
+
+/**
+ * frames of all the handles with matching timestamps
+ */
+typedef struct {
+    /* number of handles */
+    unsigned int handle_nr;
+
+    /**
+     * the timestamp of the tuple on the shared clock, it is the
+     * latest timestamp among the frames, offsets included
+     */
+    long long pts_us;
+
+    /**
+     * the results, `handle_nr` elements, `pp_res[i]` belongs to
+     * `pp_handle[i]` of the `pollux_sync_param_t` struct
+     */
+    pollux_decode_result_t **pp_res;
+} pollux_sync_tuple_t;
+
+/**
+ * @details
+ * flow:
+ *  (1) param_set of each `pollux_decode_t`
+ *  (2) param_set   ->  pollux_sync_tuple_alloc
+ *  (3) tuple_get   ->  pollux_sync_tuple_free
+ *  (4) release
+ */
+typedef struct pollux_sync_t {
+    /* private data */
+    void *priv_data;
+
+    /**
+     * @brief set the handles of the sync group
+     * 
+     * @param[in] thiz: the handle of type `pollux_sync_t`
+     * @param[in] p_param: set parameters
+     * 
+     * @return 0 on success, error code otherwise
+     * 
+     * @note the tuples of the previous parameters no longer fit
+     */
+    int (*param_set)(struct pollux_sync_t *thiz,
+        const pollux_sync_param_t *p_param);
+
+    /**
+     * @brief release the resource of the sync group,
+     *  the handles themselves are left as they are
+     * 
+     * @param[in] thiz: the handle of type `pollux_sync_t`
+     * 
+     * @return 0 on success, error code otherwise
+     */
+    int (*release)(struct pollux_sync_t *thiz);
+
+    /**
+     * @brief get the next tuple of frames with matching timestamps
+     * 
+     * @param[in] thiz: the handle of type `pollux_sync_t`
+     * @param[out] p_tuple: the tuple from `pollux_sync_tuple_alloc`
+     * @param[in] timeout_ms: the maximum time to wait for the frames
+     * 
+     * @return 0 on success;
+     * 
+     *  `POLLUX_ERR_AGAIN` if no tuple is complete in time, the
+     *  frames already taken are kept for the next call;
+     * 
+     *  `POLLUX_ERR_FILE_END` / `POLLUX_ERR_DECODE_THD_EXIT` as soon as
+     *  one of the handles reports it, refer to `result_get`;
+     * 
+     *  error code otherwise
+     * 
+     * @note every handle keeps at most one frame in the group; a frame
+     *  older than the newest one by more than `tolerance_us` can no
+     *  longer be matched and is dropped, refer to `drop_nr_get`
+     */
+    int (*tuple_get)(struct pollux_sync_t *thiz,
+        pollux_sync_tuple_t *p_tuple, unsigned int timeout_ms);
+
+    /**
+     * @brief get the number of late frames dropped by the group
+     *  since the last `param_set`
+     * 
+     * @param[in] thiz: the handle of type `pollux_sync_t`
+     * @param[out] p_nr: the number of dropped frames
+     * 
+     * @return 0 on success, error code otherwise
+     */
+    int (*drop_nr_get)(struct pollux_sync_t *thiz,
+        unsigned long long *p_nr);
+} pollux_sync_t;
+
+/**
+ * @brief free the memory for the `pollux_sync_tuple_t` struct
+ * 
+ * @param[in] p_tuple: the pointer of `pollux_sync_tuple_t`
+ */
+void
+pollux_sync_tuple_free(pollux_sync_tuple_t *p_tuple);
+
+/**
+ * @brief allocate a `pollux_sync_tuple_t` struct,
+ *  the function `param_set` needs to be called before calling
+ *  this function
+ * 
+ * @param[in] p_handle: the handle of type `pollux_sync_t`
+ * @param[out] pp_tuple: the pointer of `pollux_sync_tuple_t`
+ * 
+ * @return 0 on success, error code otherwise
+ */
+int
+pollux_sync_tuple_alloc(pollux_sync_t *p_handle,
+    pollux_sync_tuple_t **pp_tuple);
+
+/**
+ * @brief deinit the pollux sync module
+ * 
+ * @param[in] p_handle: the handle of type `pollux_sync_t`
+ * 
+ * @return 0 on success, error code otherwise
+ */
+int
+pollux_sync_deinit(pollux_sync_t *p_handle);
+
+/**
+ * @brief init the pollux sync module
+ * 
+ * @param[in] pp_handle: the handle of type `pollux_sync_t`
+ * 
+ * @return 0 on success, error code otherwise
+ */
+int
+pollux_sync_init(pollux_sync_t **pp_handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __POLLUX_SYNC_H__
@@ -0,0 +1,286 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_alloc.h"
+#include "./internal/pollux_internal_sched.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+
+/**
+ * the smaller buffers of `POLLUX_PAGE_HUGE` stay on ordinary pages,
+ * rounding them up would waste more than it saves; `i_huge_free`
+ * tells the two apart by the size alone
+ */
+#define I_HUGE_MIN (INTERNAL_ALLOC_HUGE_SIZE / 2)
+
+/* the hugetlbfs pool ran out once, it is not tried again */
+static atomic_bool i_hugetlb_out;
+
+/**
+ * `p_user` of the default allocators: the NUMA node plus 1,
+ * `NULL` without a node
+ */
+static inline int
+i_node(void *p_user)
+{
+    return (int)(uintptr_t)p_user - 1;
+}
+
+static inline size_t
+i_align(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+static inline size_t
+i_page_align(size_t size)
+{
+    return i_align(size, (size_t)sysconf(_SC_PAGESIZE));
+}
+
+static inline size_t
+i_huge_align(size_t size)
+{
+    return i_align(size, INTERNAL_ALLOC_HUGE_SIZE);
+}
+
+/**
+ * @brief map `size` bytes (a multiple of the page) at an address
+ *  aligned to `alignment`, nothing is faulted in
+ */
+static void *
+i_map(size_t size, size_t alignment)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (alignment < page) alignment = page;
+
+    /* the slack to align the start, it is given back at once */
+    size_t map_size = size + alignment - page;
+    unsigned char *p = (unsigned char *)mmap(NULL, map_size,
+        PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if ((void *)p == MAP_FAILED) {
+        SIRIUS_ERROR("mmap: %d\n", errno);
+        return NULL;
+    }
+
+    uintptr_t mask = (uintptr_t)(alignment - 1);
+    unsigned char *p_start =
+        (unsigned char *)(((uintptr_t)p + mask) & ~mask);
+    if (p_start > p) munmap(p, (size_t)(p_start - p));
+    size_t tail = (size_t)((p + map_size) - (p_start + size));
+    if (tail) munmap(p_start + size, tail);
+
+    return p_start;
+}
+
+/**
+ * @brief prefer the node of `p_user` for a mapping of the allocator,
+ *  before anything is faulted in
+ */
+static void
+i_node_bind(void *p_user, void *ptr, size_t size)
+{
+    int node = i_node(p_user);
+    int ret = internal_sched_mem_bind(node, ptr, size);
+    /* not fatal, the pages then fault in where the toucher runs */
+    if (ret) SIRIUS_WARN("mbind, node %d: %s\n", node, strerror(ret));
+}
+
+/**
+ * @brief fault in the pages of a mapping, on the node it is bound to
+ */
+static void
+i_populate(void *ptr, size_t size)
+{
+#ifdef MADV_POPULATE_WRITE
+    if (!(madvise(ptr, size, MADV_POPULATE_WRITE))) return;
+#endif
+    /* before linux 5.14, one write per page does the same */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < size; off += page) {
+        ((volatile unsigned char *)ptr)[off] = 0;
+    }
+}
+
+static void *
+i_default_alloc(void *p_user, size_t size, size_t alignment)
+{
+    (void)p_user;
+
+    void *ptr = NULL;
+    return (posix_memalign(&ptr, alignment, size)) ? NULL : ptr;
+}
+
+static void
+i_default_free(void *p_user, void *ptr, size_t size)
+{
+    (void)p_user;
+    (void)size;
+
+    free(ptr);
+}
+
+/**
+ * the default allocator with a NUMA node: a mapping of its own per
+ * buffer, as a policy set on the heap would hold for whatever else
+ * the process puts there; the pages fault in on the node whichever
+ * thread touches them first
+ */
+static void *
+i_node_alloc(void *p_user, size_t size, size_t alignment)
+{
+    size = i_page_align(size);
+    void *p = i_map(size, alignment);
+    if (p) i_node_bind(p_user, p, size);
+    return p;
+}
+
+static void
+i_node_free(void *p_user, void *ptr, size_t size)
+{
+    (void)p_user;
+
+    if (munmap(ptr, i_page_align(size))) SIRIUS_ERROR("munmap: %d\n", errno);
+}
+
+/**
+ * @brief map `size` bytes (a multiple of the huge page) at an address
+ *  aligned to the huge page, ask for transparent huge pages, and
+ *  fault them in on the node of `p_user`
+ */
+static void *
+i_thp_map(void *p_user, size_t size)
+{
+    /* only the ranges aligned to the huge page get them */
+    void *p = i_map(size, INTERNAL_ALLOC_HUGE_SIZE);
+    if (!(p)) return NULL;
+
+    /* `EINVAL` with transparent huge pages disabled, the pages stay small */
+    if (madvise(p, size, MADV_HUGEPAGE)) {
+        SIRIUS_DEBG("madvise MADV_HUGEPAGE: %d\n", errno);
+    }
+    i_node_bind(p_user, p, size);
+    i_populate(p, size);
+
+    return p;
+}
+
+/**
+ * the kernel hands out zeroed pages in any case, unlike `calloc`
+ * nothing is written over them again
+ */
+static void *
+i_huge_alloc(void *p_user, size_t size, size_t alignment)
+{
+    if (size < I_HUGE_MIN) {
+        return (i_node(p_user) < 0) ? i_default_alloc(p_user, size, alignment) :
+            i_node_alloc(p_user, size, alignment);
+    }
+
+    /* the mappings are aligned to the huge page, above any `alignment` */
+    size = i_huge_align(size);
+    if (!(atomic_load_explicit(&i_hugetlb_out, memory_order_relaxed))) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+        flags |= 21 << MAP_HUGE_SHIFT;
+#endif
+        /* the huge pages are reserved here, it fails if the pool is short */
+        void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p != MAP_FAILED) {
+            /* not `MAP_POPULATE`, it faults them in on the caller's node */
+            i_node_bind(p_user, p, size);
+            i_populate(p, size);
+            return p;
+        }
+
+        if (!(atomic_exchange(&i_hugetlb_out, true))) {
+            SIRIUS_WARN("no hugetlbfs pages (%d), "
+                "transparent huge pages from now on\n", errno);
+        }
+    }
+
+    return i_thp_map(p_user, size);
+}
+
+static void
+i_huge_free(void *p_user, void *ptr, size_t size)
+{
+    if (size >= I_HUGE_MIN) {
+        if (munmap(ptr, i_huge_align(size)))
+            SIRIUS_ERROR("munmap: %d\n", errno);
+    } else if (i_node(p_user) < 0) {
+        i_default_free(p_user, ptr, size);
+    } else {
+        i_node_free(p_user, ptr, size);
+    }
+}
+
+hide_symbol void
+internal_alloc_set(pollux_allocator_t *p_dst,
+    const pollux_allocator_t *p_src, pollux_page_t page, int node)
+{
+    if (p_src && p_src->alloc && p_src->free) {
+        *p_dst = *p_src;
+        return;
+    }
+
+    if (page == POLLUX_PAGE_HUGE) {
+        p_dst->alloc = i_huge_alloc;
+        p_dst->free = i_huge_free;
+    } else if (node >= 0) {
+        p_dst->alloc = i_node_alloc;
+        p_dst->free = i_node_free;
+    } else {
+        p_dst->alloc = i_default_alloc;
+        p_dst->free = i_default_free;
+    }
+    p_dst->p_user = (node >= 0) ? (void *)(uintptr_t)(node + 1) : NULL;
+}
+
+hide_symbol bool
+internal_alloc_is_zeroed(const pollux_allocator_t *p_a, size_t size)
+{
+    if (p_a->alloc == i_node_alloc) return true;
+    /* the smaller ones come from the heap without a node */
+    return p_a->alloc == i_huge_alloc &&
+        (size >= I_HUGE_MIN || i_node(p_a->p_user) >= 0);
+}
+
+hide_symbol size_t
+internal_alloc_image(const pollux_allocator_t *p_a,
+    uint8_t *data[4], int linesize[4],
+    int width, int height, enum AVPixelFormat fmt, int alignment)
+{
+    int ret = av_image_get_buffer_size(fmt, width, height, alignment);
+    if (ret < 0) {
+        SIRIUS_ERROR("av_image_get_buffer_size: [%d]\n", ret);
+        return 0;
+    }
+
+    /* the same slack behind the image as `av_image_alloc` leaves */
+    size_t size = (size_t)ret + (size_t)alignment;
+    uint8_t *buf = (uint8_t *)internal_alloc(p_a, size, (size_t)alignment);
+    if (!(buf)) {
+        SIRIUS_ERROR("alloc: %zu\n", size);
+        return 0;
+    }
+
+    if (0 > av_image_fill_arrays(
+        data, linesize, buf, fmt, width, height, alignment)) {
+        SIRIUS_ERROR("av_image_fill_arrays\n");
+        internal_free(p_a, buf, size);
+        return 0;
+    }
+
+    return size;
+}
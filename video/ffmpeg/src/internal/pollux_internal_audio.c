@@ -0,0 +1,231 @@
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_audio.h"
+#include "./internal/pollux_internal_ffmpeg.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static enum AVSampleFormat
+i_sample_fmt(pollux_sample_fmt_t fmt)
+{
+    switch (fmt) {
+        case POLLUX_SAMPLE_FMT_S16: return AV_SAMPLE_FMT_S16;
+        case POLLUX_SAMPLE_FMT_S32: return AV_SAMPLE_FMT_S32;
+        case POLLUX_SAMPLE_FMT_F32: return AV_SAMPLE_FMT_FLT;
+        default: return AV_SAMPLE_FMT_NONE;
+    }
+}
+
+hide_symbol int
+internal_audio_open(internal_audio_t *p_a,
+    const internal_audio_param_t *p_param,
+    AVFormatContext *fmt_ctx, unsigned int video_index)
+{
+    p_a->fmt = i_sample_fmt(p_param->fmt);
+    if (p_a->fmt == AV_SAMPLE_FMT_NONE) {
+        SIRIUS_ERROR("sample fmt: %d\n", p_param->fmt);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+    p_a->pollux_fmt = p_param->fmt;
+
+    int ret = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_AUDIO,
+        -1, (int)video_index, NULL, 0);
+    if (ret < 0) {
+        SIRIUS_ERROR("no audio stream: [%d]\n", ret);
+        return POLLUX_ERR;
+    }
+    p_a->stream_index = (unsigned int)ret;
+    AVStream *st = fmt_ctx->streams[p_a->stream_index];
+    p_a->time_base = st->time_base;
+    const AVStream *vst = fmt_ctx->streams[video_index];
+    p_a->start_us = (vst->start_time == AV_NOPTS_VALUE) ? 0 :
+        av_rescale_q(vst->start_time, vst->time_base, AV_TIME_BASE_Q);
+
+    if (!(p_a->codec_ctx = internal_ffmpeg_decoder_create(st->codecpar)))
+        return POLLUX_ERR;
+    AVCodecContext *codec_ctx = p_a->codec_ctx;
+
+    if (p_param->channels) {
+        av_channel_layout_default(&(p_a->ch_layout), p_param->channels);
+    } else if (av_channel_layout_copy(
+        &(p_a->ch_layout), &(codec_ctx->ch_layout)) < 0) {
+        SIRIUS_ERROR("av_channel_layout_copy\n");
+        goto label_audio_close;
+    }
+    p_a->sample_rate = (p_param->sample_rate) ?
+        (int)(p_param->sample_rate) : codec_ctx->sample_rate;
+    p_a->sample_size =
+        av_get_bytes_per_sample(p_a->fmt) * p_a->ch_layout.nb_channels;
+
+    ret = swr_alloc_set_opts2(&(p_a->swr_ctx),
+        &(p_a->ch_layout), p_a->fmt, p_a->sample_rate,
+        &(codec_ctx->ch_layout), codec_ctx->sample_fmt,
+        codec_ctx->sample_rate, 0, NULL);
+    if (ret < 0 || (ret = swr_init(p_a->swr_ctx)) < 0) {
+        SIRIUS_ERROR("swr init: [%d]\n", ret);
+        goto label_audio_close;
+    }
+
+    if (!(p_a->frame = av_frame_alloc())) {
+        SIRIUS_ERROR("av_frame_alloc\n");
+        goto label_audio_close;
+    }
+
+    p_a->pts_next = 0;
+    atomic_store(&(p_a->head), 0);
+    atomic_store(&(p_a->tail), 0);
+    atomic_store(&(p_a->drop_nr), 0);
+
+    /* the demuxer discards everything but the video until now */
+    st->discard = AVDISCARD_DEFAULT;
+    SIRIUS_INFO("audio stream [%u]: %d Hz, %d channels -> %d Hz, %d\n",
+        p_a->stream_index, codec_ctx->sample_rate,
+        codec_ctx->ch_layout.nb_channels,
+        p_a->sample_rate, p_a->ch_layout.nb_channels);
+
+    return POLLUX_OK;
+
+label_audio_close:
+    internal_audio_close(p_a);
+    return POLLUX_ERR;
+}
+
+hide_symbol void
+internal_audio_close(internal_audio_t *p_a)
+{
+    av_frame_free(&(p_a->frame));
+    swr_free(&(p_a->swr_ctx));
+    avcodec_free_context(&(p_a->codec_ctx));
+    av_channel_layout_uninit(&(p_a->ch_layout));
+
+    for (unsigned int i = 0; i < INTERNAL_AUDIO_SLOT_NR; i++) {
+        free(p_a->slot[i].buf);
+        p_a->slot[i].buf = NULL;
+        p_a->slot[i].size = 0;
+    }
+}
+
+/**
+ * @brief resample the decoded samples into the next free slot
+ * 
+ * @param[in] in: the samples, `NULL` takes the samples still
+ *  buffered inside the resampler
+ * @param[in] pts: timestamp of `in` in the stream time base,
+ *  `AV_NOPTS_VALUE` continues from the previous chunk
+ */
+static void
+i_samples_publish(internal_audio_t *p_a,
+    const uint8_t * const *in, int in_nr, int64_t pts,
+    int64_t pts_base, int64_t pts_min)
+{
+    unsigned int head = atomic_load_explicit(
+        &(p_a->head), memory_order_relaxed);
+    if (head - atomic_load_explicit(&(p_a->tail), memory_order_acquire) >=
+        INTERNAL_AUDIO_SLOT_NR) {
+        atomic_fetch_add_explicit(&(p_a->drop_nr), 1, memory_order_relaxed);
+        return;
+    }
+
+    /* the slot is not visible to the consumer before `head` moves */
+    internal_audio_slot_t *p_s = &(p_a->slot[head % INTERNAL_AUDIO_SLOT_NR]);
+    int nr = swr_get_out_samples(p_a->swr_ctx, in_nr);
+    if (nr <= 0) return;
+    size_t size = (size_t)nr * p_a->sample_size;
+    if (p_s->size < size) {
+        unsigned char *buf = (unsigned char *)realloc(p_s->buf, size);
+        if (!(buf)) {
+            SIRIUS_ERROR("realloc\n");
+            return;
+        }
+        p_s->buf = buf;
+        p_s->size = size;
+    }
+
+    nr = swr_convert(p_a->swr_ctx, &(p_s->buf), nr, in, in_nr);
+    if (nr <= 0) return;
+
+    p_s->pts_us = (pts == AV_NOPTS_VALUE) ? p_a->pts_next : pts_base +
+        av_rescale_q(pts, p_a->time_base, AV_TIME_BASE_Q) - p_a->start_us;
+    p_a->pts_next = p_s->pts_us +
+        av_rescale(nr, AV_TIME_BASE, p_a->sample_rate);
+    if (p_a->pts_next <= pts_min) return;
+
+    p_s->sample_nr = (unsigned int)nr;
+    p_s->epoch = atomic_load_explicit(&(p_a->epoch), memory_order_relaxed);
+    atomic_store_explicit(&(p_a->head), head + 1, memory_order_release);
+}
+
+hide_symbol void
+internal_audio_decode(internal_audio_t *p_a, const AVPacket *pkt,
+    int64_t pts_base, int64_t pts_min)
+{
+    if (avcodec_send_packet(p_a->codec_ctx, pkt)) return;
+
+    AVFrame *frame = p_a->frame;
+    while (!(avcodec_receive_frame(p_a->codec_ctx, frame))) {
+        i_samples_publish(p_a,
+            (const uint8_t * const *)(frame->extended_data),
+            frame->nb_samples, frame->best_effort_timestamp,
+            pts_base, pts_min);
+        av_frame_unref(frame);
+    }
+    if (pkt) return;
+
+    /**
+     * drained, the tail of the stream still sits in the resampler;
+     * the decoder only accepts packets again after a flush
+     */
+    i_samples_publish(p_a, NULL, 0, AV_NOPTS_VALUE, pts_base, pts_min);
+    avcodec_flush_buffers(p_a->codec_ctx);
+}
+
+hide_symbol void
+internal_audio_flush(internal_audio_t *p_a, int64_t pts_us)
+{
+    avcodec_flush_buffers(p_a->codec_ctx);
+    /* drops the samples buffered inside the resampler */
+    if (swr_init(p_a->swr_ctx) < 0) SIRIUS_WARN("swr_init\n");
+
+    p_a->pts_next = pts_us;
+    atomic_fetch_add_explicit(&(p_a->epoch), 1, memory_order_release);
+}
+
+hide_symbol int
+internal_audio_take(internal_audio_t *p_a,
+    pollux_decode_audio_result_t *p_res)
+{
+    unsigned int tail = atomic_load_explicit(
+        &(p_a->tail), memory_order_relaxed);
+    unsigned int head, epoch;
+    internal_audio_slot_t *p_s;
+    for (;;) {
+        head = atomic_load_explicit(&(p_a->head), memory_order_acquire);
+        if (tail == head) return POLLUX_ERR_AGAIN;
+
+        p_s = &(p_a->slot[tail % INTERNAL_AUDIO_SLOT_NR]);
+        epoch = atomic_load_explicit(&(p_a->epoch), memory_order_acquire);
+        if (p_s->epoch == epoch) break;
+        /* published before a seek */
+        atomic_store_explicit(&(p_a->tail), ++tail, memory_order_release);
+    }
+
+    unsigned char *buf = p_res->buf;
+    size_t size = p_res->size;
+    p_res->buf = p_s->buf;
+    p_res->size = p_s->size;
+    p_s->buf = buf;
+    p_s->size = size;
+
+    p_res->sample_rate = (unsigned int)(p_a->sample_rate);
+    p_res->channels = (unsigned short)(p_a->ch_layout.nb_channels);
+    p_res->fmt = p_a->pollux_fmt;
+    p_res->sample_nr = p_s->sample_nr;
+    p_res->pts_us = p_s->pts_us;
+    p_res->drop_nr = atomic_load_explicit(
+        &(p_a->drop_nr), memory_order_relaxed);
+
+    atomic_store_explicit(&(p_a->tail), tail + 1, memory_order_release);
+    return POLLUX_OK;
+}
@@ -2,6 +2,11 @@
 #include "sirius_log.h"
 
 #include "./internal/pollux_internal_ffmpeg.h"
+#include "./internal/pollux_internal_probe.h"
+
+#include "libavutil/pixdesc.h"
+
+#include <stdbool.h>
 
 static inline void
 i_fmt_ctx_delete(AVFormatContext *fmt_ctx)
@@ -13,7 +18,7 @@ i_fmt_ctx_delete(AVFormatContext *fmt_ctx)
 
 static int
 i_fmt_ctx_create(AVFormatContext **fmt_ctx,
-    const char *p_file)
+    const internal_ffmpeg_param_t *p_m)
 {
     /**
      * allocate the `av` context,
@@ -24,23 +29,45 @@ i_fmt_ctx_create(AVFormatContext **fmt_ctx,
         return POLLUX_ERR_RESOURCE_REQUEST;
     }
 
+    AVDictionary *opts = NULL;
+    if (p_m->probesize > 0)
+        av_dict_set_int(&opts, "probesize", p_m->probesize, 0);
+    if (p_m->analyzeduration > 0)
+        av_dict_set_int(&opts, "analyzeduration", p_m->analyzeduration, 0);
+
+    /**
+     * a file probed before skips the format probe,
+     * the key is unusable for anything but a regular file
+     */
+    internal_probe_key_t key;
+    bool is_cacheable = !(internal_probe_key_get(p_m->src_file_path, &key));
+    const AVInputFormat *ifmt =
+        is_cacheable ? internal_probe_iformat(&key) : NULL;
+
     int ret;
     /**
      * open the input file, and request the appropriate resource
      * for the members in the `fmt_ctx` based on the file
      */
-    ret = avformat_open_input(fmt_ctx, p_file, NULL, NULL);
+    ret = avformat_open_input(fmt_ctx, p_m->src_file_path, ifmt, &opts);
+    av_dict_free(&opts);
     if (ret) {
         SIRIUS_ERROR("avformat_open_input: [%d]\n", ret);
         goto label_fmt_ctx_free;
     }
 
+    if (is_cacheable && !(internal_probe_apply(&key, *fmt_ctx))) {
+        SIRIUS_DEBG("probe cache hit: %s\n", p_m->src_file_path);
+        return POLLUX_OK;
+    }
+
     /* read information from input file, and fill them into `fmt_ctx` */
     ret = avformat_find_stream_info(*fmt_ctx, NULL);
     if (ret < 0) {
         SIRIUS_ERROR("avformat_find_stream_info: [%d]\n", ret);
         goto label_input_close;
     }
+    if (is_cacheable) internal_probe_store(&key, *fmt_ctx);
 
     return POLLUX_OK;
 
@@ -55,33 +82,44 @@ label_fmt_ctx_free:
 }
 
 /**
- * @brief find stream index based on `media_type`
+ * @brief find stream index based on `media_type`,
+ *  the other streams are discarded so that the demuxer
+ *  neither parses nor returns their packets
  * 
  * @param[out] p_stream: stream index
  * @param[in] fmt_ctx: format context
  * @param[in] media_type: media type, refer `AVMediaType`
+ * @param[in] wanted: index of the stream, -1 for the best one
+ * @param[in] discard_off: the other streams are kept
  * 
  * @return 0 if OK, error code otherwise
  */
 static inline int
 i_stream_get(unsigned int *p_stream,
     AVFormatContext *fmt_ctx,
-    enum AVMediaType media_type)
+    enum AVMediaType media_type, int wanted, bool discard_off)
 {
-    *p_stream = -1;
-    for (unsigned int i = 0;
-        i < fmt_ctx->nb_streams; i++) {
-        if (media_type ==
-            fmt_ctx->streams[i]->codecpar->codec_type) {
-            *p_stream = i;
-            break;
-        }
-    }
-    if (*p_stream == -1) {
+    if (wanted >= (int)(fmt_ctx->nb_streams) ||
+        (wanted >= 0 &&
+        fmt_ctx->streams[wanted]->codecpar->codec_type != media_type)) {
+        SIRIUS_ERROR("stream [%d] is not of media type [%d]\n",
+            wanted, media_type);
+        return POLLUX_ERR;
+    }
+
+    int ret = av_find_best_stream(fmt_ctx, media_type, wanted, -1, NULL, 0);
+    if (ret < 0) {
         SIRIUS_ERROR(
-            "media type [%d] not found\n", media_type);
+            "media type [%d] not found: [%d]\n", media_type, ret);
         return POLLUX_ERR;
     }
+    *p_stream = (unsigned int)ret;
+
+    if (discard_off) return POLLUX_OK;
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
+        fmt_ctx->streams[i]->discard =
+            (i == *p_stream) ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
 
     return POLLUX_OK;
 }
@@ -93,8 +131,8 @@ i_decoder_delete(AVCodecContext *codec_ctx)
     avcodec_free_context(&codec_ctx);
 }
 
-static AVCodecContext *
-i_decoder_create(AVCodecParameters *codec_param)
+hide_symbol AVCodecContext *
+internal_ffmpeg_decoder_create(const AVCodecParameters *codec_param)
 {
     /**
      * `codec_id` stands for the decoder used,
@@ -156,21 +194,21 @@ internal_ffmpeg_deinit(internal_ffmpeg_info_t *p_ffmpeg)
 }
 
 hide_symbol int
-internal_ffmpeg_init(const char *p_file,
+internal_ffmpeg_init(const internal_ffmpeg_param_t *p_m,
     enum AVMediaType media_type,
     internal_ffmpeg_info_t *p_ffmpeg)
 {
-    if(i_fmt_ctx_create(&(p_ffmpeg->fmt_ctx), p_file)) {
+    if(i_fmt_ctx_create(&(p_ffmpeg->fmt_ctx), p_m)) {
         return POLLUX_ERR;
     }
     AVFormatContext *fmt_ctx = p_ffmpeg->fmt_ctx;
 
-    if (i_stream_get(
-        &(p_ffmpeg->stream_index), fmt_ctx, AVMEDIA_TYPE_VIDEO)) {
+    if (i_stream_get(&(p_ffmpeg->stream_index),
+        fmt_ctx, media_type, p_m->stream_index, p_m->discard_off)) {
         goto label_fmt_ctx_del;
     }
 
-    p_ffmpeg->codec_ctx = i_decoder_create(
+    p_ffmpeg->codec_ctx = internal_ffmpeg_decoder_create(
             fmt_ctx->streams[p_ffmpeg->stream_index]->codecpar);
     if (!(p_ffmpeg->codec_ctx)) {
         goto label_fmt_ctx_del;
@@ -184,6 +222,111 @@ label_fmt_ctx_del:
     return POLLUX_ERR;
 }
 
+/**
+ * @brief the sws context converting frames of `src_w` x `src_h` in
+ *  `src_fmt`, the one in `*pp_sws` is kept if it already does
+ */
+static int
+i_sws_get(struct SwsContext **pp_sws,
+    int src_w, int src_h, enum AVPixelFormat src_fmt,
+    int width, int height, enum AVPixelFormat fmt)
+{
+    /**
+     * more than 8 bits per component, round accurately so that
+     * the extra precision of the source survives the conversion
+     */
+    const AVPixFmtDescriptor *p_desc = av_pix_fmt_desc_get(fmt);
+    int flags = SWS_BILINEAR;
+    if (p_desc && p_desc->comp[0].depth > 8) flags |= SWS_ACCURATE_RND;
+
+    /**
+     * allocate resource for `sws_ctx`
+     * `sws_ctx` is used for video pixel format conversion
+     * and image scaling operations
+     */
+    struct SwsContext *sws_ctx = sws_getCachedContext(*pp_sws,
+        src_w, src_h, src_fmt, width, height, fmt, flags, NULL, NULL, NULL);
+    if (!(sws_ctx)) {
+        SIRIUS_ERROR("sws_getCachedContext\n");
+        return POLLUX_ERR;
+    }
+
+    *pp_sws = sws_ctx;
+    return POLLUX_OK;
+}
+
+hide_symbol int
+internal_ffmpeg_sws_create(struct SwsContext **pp_sws,
+    const AVCodecContext *codec_ctx,
+    int width, int height, enum AVPixelFormat fmt)
+{
+    *pp_sws = NULL;
+    if (codec_ctx->width == width &&
+        codec_ctx->height == height &&
+        codec_ctx->pix_fmt == fmt) {
+        /* nothing to convert, the planes are copied line by line */
+        SIRIUS_INFO("the decoded frames are copied without sws\n");
+        return POLLUX_OK;
+    }
+
+    return i_sws_get(pp_sws, codec_ctx->width, codec_ctx->height,
+        codec_ctx->pix_fmt, width, height, fmt);
+}
+
+hide_symbol int64_t
+internal_ffmpeg_pts_us(const internal_ffmpeg_info_t *p_ffmpeg,
+    const AVFrame *p_frame)
+{
+    int64_t ts = p_frame->best_effort_timestamp;
+    if (ts == AV_NOPTS_VALUE) return AV_NOPTS_VALUE;
+
+    const AVStream *st = p_ffmpeg->fmt_ctx->streams[p_ffmpeg->stream_index];
+    if (st->start_time != AV_NOPTS_VALUE) ts -= st->start_time;
+    return av_rescale_q(ts, st->time_base, AV_TIME_BASE_Q);
+}
+
+hide_symbol int64_t
+internal_ffmpeg_duration_us(const internal_ffmpeg_info_t *p_ffmpeg,
+    const AVFrame *p_frame)
+{
+    const AVStream *st = p_ffmpeg->fmt_ctx->streams[p_ffmpeg->stream_index];
+    if (p_frame->duration > 0)
+        return av_rescale_q(p_frame->duration, st->time_base, AV_TIME_BASE_Q);
+
+    if (st->avg_frame_rate.num > 0 && st->avg_frame_rate.den > 0)
+        return av_rescale(AV_TIME_BASE,
+            st->avg_frame_rate.den, st->avg_frame_rate.num);
+
+    return 0;
+}
+
+hide_symbol int
+internal_ffmpeg_convert(struct SwsContext **pp_sws,
+    const AVFrame *p_src, AVFrame *p_dst,
+    int width, int height, enum AVPixelFormat fmt)
+{
+    /**
+     * checked on every frame, the size or the format of a stream
+     * may change at any frame, e.g. at a new sequence header
+     */
+    if (p_src->width == width && p_src->height == height &&
+        p_src->format == fmt) {
+        /* `memcpy` per line, which runs on the widest words available */
+        av_image_copy2(p_dst->data, p_dst->linesize,
+            p_src->data, p_src->linesize, p_src->format,
+            p_src->width, p_src->height);
+        return p_src->height;
+    }
+
+    if (i_sws_get(pp_sws, p_src->width, p_src->height,
+        (enum AVPixelFormat)(p_src->format), width, height, fmt))
+        return 0;
+
+    return sws_scale(*pp_sws,
+        (const uint8_t * const *)(p_src->data), p_src->linesize,
+        0, p_src->height, p_dst->data, p_dst->linesize);
+}
+
 hide_symbol void
 internal_ffmpeg_resource_free(internal_ffmpeg_info_t *p_ffmpeg)
 {
@@ -198,20 +341,9 @@ hide_symbol int
 internal_ffmpeg_resource_alloc(internal_ffmpeg_param_t *p_m,
     internal_ffmpeg_info_t *p_ffmpeg)
 {
-    AVCodecContext *codec_ctx = p_ffmpeg->codec_ctx;
-    /**
-     * allocate resource for `sws_ctx`
-     * `sws_ctx` is used for video pixel format conversion
-     * and image scaling operations
-     */
-    p_ffmpeg->sws_ctx = sws_getContext(
-        codec_ctx->width, codec_ctx->height, codec_ctx->pix_fmt,
-        p_m->width, p_m->height, p_m->fmt,
-        SWS_BILINEAR, NULL, NULL, NULL);
-    if (!(p_ffmpeg->sws_ctx)) {
-        SIRIUS_ERROR("sws_getContext\n");
+    if (internal_ffmpeg_sws_create(&(p_ffmpeg->sws_ctx),
+        p_ffmpeg->codec_ctx, p_m->width, p_m->height, p_m->fmt))
         return POLLUX_ERR;
-    }
 
     p_ffmpeg->frame = av_frame_alloc();
     if(!(p_ffmpeg->frame)) {
@@ -0,0 +1,44 @@
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_file.h"
+
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+hide_symbol int
+internal_file_stat(const char *p_path,
+    uint64_t *p_size, int64_t *p_mtime_ns)
+{
+    struct stat sb;
+    if (stat(p_path, &sb) || !(S_ISREG(sb.st_mode))) return POLLUX_ERR;
+
+    *p_size = (uint64_t)sb.st_size;
+    *p_mtime_ns = (int64_t)sb.st_mtim.tv_sec * 1000000000 +
+        sb.st_mtim.tv_nsec;
+    return POLLUX_OK;
+}
+
+hide_symbol int
+internal_file_replace(const char *p_path,
+    internal_file_write_t pfn_write, void *args)
+{
+    char tmp[PATH_MAX + 24];
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", p_path, (long)getpid());
+    FILE *fp = fopen(tmp, "wb");
+    if (!(fp)) {
+        SIRIUS_WARN("fopen: %s\n", tmp);
+        return POLLUX_ERR;
+    }
+
+    bool ok = pfn_write(fp, args);
+    ok = (fclose(fp) == 0) && ok;
+    if (!(ok) || rename(tmp, p_path)) {
+        SIRIUS_WARN("[%s] is not written\n", p_path);
+        remove(tmp);
+        return POLLUX_ERR;
+    }
+
+    return POLLUX_OK;
+}
@@ -1,31 +1,182 @@
 #include "./internal/pollux_internal_fmt.h"
 
+#include "libavutil/imgutils.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 static force_inline void
-i_result_444p(pollux_decode_result_t *p_res,
-    const AVFrame *p_frame)
+i_copy_444p(unsigned char *p_dst, const AVFrame *p_frame)
 {
-    p_res->fmt = POLLUX_FMT_444P;
-
     unsigned int y_size =
         p_frame->linesize[0] * p_frame->height;
 
-    memcpy(p_res->buf, p_frame->data[0], y_size);
-    memcpy(p_res->buf + y_size, p_frame->data[1], y_size);
-    memcpy(p_res->buf + (y_size << 1), p_frame->data[2], y_size);
+    memcpy(p_dst, p_frame->data[0], y_size);
+    memcpy(p_dst + y_size, p_frame->data[1], y_size);
+    memcpy(p_dst + (y_size << 1), p_frame->data[2], y_size);
 }
 
 static force_inline void
-i_result_y_uv(pollux_decode_result_t *p_res,
-    const AVFrame *p_frame, pollux_fmt_t fmt)
+i_copy_y_uv(unsigned char *p_dst, const AVFrame *p_frame)
 {
-    p_res->fmt = fmt;
-
     unsigned int y_size =
         p_frame->linesize[0] * p_frame->height;
     unsigned int uv_size = y_size >> 1;
 
-    memcpy(p_res->buf, p_frame->data[0], y_size);
-    memcpy(p_res->buf + y_size, p_frame->data[1], uv_size);
+    memcpy(p_dst, p_frame->data[0], y_size);
+    memcpy(p_dst + y_size, p_frame->data[1], uv_size);
+}
+
+/**
+ * @brief planar 4:2:0, the chroma planes are written with
+ *  half the line size of the luma plane
+ */
+static force_inline void
+i_copy_420p(unsigned char *p_dst, const AVFrame *p_frame)
+{
+    const int stride = p_frame->linesize[0];
+    const int c_stride = stride >> 1;
+    const int c_height = p_frame->height >> 1;
+    unsigned int y_size = stride * p_frame->height;
+    unsigned int c_size = c_stride * c_height;
+
+    memcpy(p_dst, p_frame->data[0], y_size);
+    /* the chroma line size of the cache may carry its own padding */
+    av_image_copy_plane(p_dst + y_size, c_stride,
+        p_frame->data[1], p_frame->linesize[1],
+        FFMIN(c_stride, p_frame->linesize[1]), c_height);
+    av_image_copy_plane(p_dst + y_size + c_size, c_stride,
+        p_frame->data[2], p_frame->linesize[2],
+        FFMIN(c_stride, p_frame->linesize[2]), c_height);
+}
+
+/**
+ * @brief interleave the three planes into `yuvyuv...` rows
+ *  without padding
+ */
+static force_inline void
+i_copy_444p_packed(unsigned char *restrict p_dst,
+    const AVFrame *p_frame)
+{
+    const int width = p_frame->width;
+    for (int y = 0; y < p_frame->height; y++) {
+        const unsigned char *restrict p_y =
+            p_frame->data[0] + y * p_frame->linesize[0];
+        const unsigned char *restrict p_u =
+            p_frame->data[1] + y * p_frame->linesize[1];
+        const unsigned char *restrict p_v =
+            p_frame->data[2] + y * p_frame->linesize[2];
+        unsigned char *restrict p_d = p_dst + y * width * 3;
+        for (int x = 0; x < width; x++) {
+            p_d[3 * x] = p_y[x];
+            p_d[3 * x + 1] = p_u[x];
+            p_d[3 * x + 2] = p_v[x];
+        }
+    }
+}
+
+/**
+ * @brief `p_dst[i] = p_src[i] * scale + bias`,
+ *  the conversion and the normalization in a single pass
+ */
+static force_inline void
+i_u8_to_f32(float *restrict p_dst,
+    const unsigned char *restrict p_src,
+    int n, float scale, float bias)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 v_scale = _mm_set1_ps(scale);
+    const __m128 v_bias = _mm_set1_ps(bias);
+    __m128i v8, v16;
+    for (; i + 16 <= n; i += 16) {
+        v8 = _mm_loadu_si128((const __m128i *)(p_src + i));
+
+        v16 = _mm_unpacklo_epi8(v8, zero);
+        _mm_storeu_ps(p_dst + i, _mm_add_ps(_mm_mul_ps(
+            _mm_cvtepi32_ps(_mm_unpacklo_epi16(v16, zero)),
+            v_scale), v_bias));
+        _mm_storeu_ps(p_dst + i + 4, _mm_add_ps(_mm_mul_ps(
+            _mm_cvtepi32_ps(_mm_unpackhi_epi16(v16, zero)),
+            v_scale), v_bias));
+
+        v16 = _mm_unpackhi_epi8(v8, zero);
+        _mm_storeu_ps(p_dst + i + 8, _mm_add_ps(_mm_mul_ps(
+            _mm_cvtepi32_ps(_mm_unpacklo_epi16(v16, zero)),
+            v_scale), v_bias));
+        _mm_storeu_ps(p_dst + i + 12, _mm_add_ps(_mm_mul_ps(
+            _mm_cvtepi32_ps(_mm_unpackhi_epi16(v16, zero)),
+            v_scale), v_bias));
+    }
+#endif
+    for (; i < n; i++) {
+        p_dst[i] = p_src[i] * scale + bias;
+    }
+}
+
+/**
+ * @brief planar `gbr` frame cache to normalized `rgb` float32 planes,
+ *  lines without padding (CHW)
+ */
+static force_inline void
+i_copy_rgb_f32(unsigned char *p_dst, const AVFrame *p_frame,
+    const internal_fmt_norm_t *p_norm)
+{
+    const int width = p_frame->width;
+    const int height = p_frame->height;
+    float *p_f = (float *)p_dst;
+    /* `AV_PIX_FMT_GBRP` stores the planes in the order g, b, r */
+    static const int plane[3] = {2, 0, 1};
+
+    for (int c = 0; c < 3; c++) {
+        const unsigned char *p_src = p_frame->data[plane[c]];
+        for (int y = 0; y < height; y++) {
+            i_u8_to_f32(p_f, p_src, width,
+                p_norm->scale[c], p_norm->bias[c]);
+            p_f += width;
+            p_src += p_frame->linesize[plane[c]];
+        }
+    }
+}
+
+/**
+ * @brief planar `gbr` frame cache to normalized `rgbrgb...` float32
+ *  pixels, lines without padding (HWC)
+ */
+static force_inline void
+i_copy_rgb_f32_packed(unsigned char *p_dst, const AVFrame *p_frame,
+    const internal_fmt_norm_t *p_norm)
+{
+    const int width = p_frame->width;
+    float *restrict p_f = (float *)p_dst;
+    for (int y = 0; y < p_frame->height; y++) {
+        const unsigned char *restrict p_r =
+            p_frame->data[2] + y * p_frame->linesize[2];
+        const unsigned char *restrict p_g =
+            p_frame->data[0] + y * p_frame->linesize[0];
+        const unsigned char *restrict p_b =
+            p_frame->data[1] + y * p_frame->linesize[1];
+        for (int x = 0; x < width; x++) {
+            p_f[0] = p_r[x] * p_norm->scale[0] + p_norm->bias[0];
+            p_f[1] = p_g[x] * p_norm->scale[1] + p_norm->bias[1];
+            p_f[2] = p_b[x] * p_norm->scale[2] + p_norm->bias[2];
+            p_f += 3;
+        }
+    }
+}
+
+hide_symbol void
+internal_fmt_norm_set(internal_fmt_norm_t *p_norm,
+    const float *p_mean, const float *p_std)
+{
+    float std;
+    for (int c = 0; c < 3; c++) {
+        std = (p_std[c] == 0.0f) ? 1.0f : p_std[c];
+        p_norm->scale[c] = 1.0f / (255.0f * std);
+        p_norm->bias[c] = -p_mean[c] / std;
+    }
 }
 
 hide_symbol inline bool
@@ -37,51 +188,163 @@ internal_fmt_convert(pollux_fmt_t src_fmt,
 #define F_444P *p_dst_fmt = AV_PIX_FMT_YUV444P;
 #define F_NV21 *p_dst_fmt = AV_PIX_FMT_NV21;
 #define F_NV12 *p_dst_fmt = AV_PIX_FMT_NV12;
+#define F_P010 *p_dst_fmt = AV_PIX_FMT_P010LE;
+#define F_420P10 *p_dst_fmt = AV_PIX_FMT_YUV420P10LE;
+#define F_444P16 *p_dst_fmt = AV_PIX_FMT_YUV444P16LE;
+#define F_RGBF32 *p_dst_fmt = AV_PIX_FMT_GBRP;
 #define F_DFT ret = false;
     INTERNAL_POLLUX_FMT_SWITCH(src_fmt);
 
 #undef F_DFT
+#undef F_RGBF32
+#undef F_444P16
+#undef F_420P10
+#undef F_P010
 #undef F_NV12
 #undef F_NV21
 #undef F_444P
     return ret;
 }
 
+hide_symbol inline bool
+internal_fmt_is_direct(enum AVPixelFormat fmt)
+{
+    return fmt != AV_PIX_FMT_GBRP;
+}
+
+hide_symbol inline unsigned int
+internal_fmt_stride(enum AVPixelFormat fmt,
+    int width, int linesize)
+{
+    /* the tensor formats are written without padding */
+    return (fmt == AV_PIX_FMT_GBRP) ?
+        width * sizeof(float) : linesize;
+}
+
+hide_symbol unsigned int
+internal_fmt_stride_of(enum AVPixelFormat fmt,
+    int width, int alignment)
+{
+    /* the line size `av_image_fill_arrays` gives the frame caches */
+    int linesize = av_image_get_linesize(fmt, width, 0);
+    if (linesize <= 0) return 0;
+    if (alignment > 1) linesize = FFALIGN(linesize, alignment);
+
+    return internal_fmt_stride(fmt, width, linesize);
+}
+
 hide_symbol inline unsigned int
 internal_fmt_size(enum AVPixelFormat fmt,
-    int linesize, int height)
+    int stride, int height)
 {
     int buf_size = 0;
 
-#define F_444P buf_size = linesize * height * 3;
-#define F_NV21 buf_size = linesize * height * 3 >> 1;
-#define F_NV12 buf_size = linesize * height * 3 >> 1;
+#define F_444P buf_size = stride * height * 3;
+#define F_NV21 buf_size = stride * height * 3 >> 1;
+#define F_NV12 buf_size = stride * height * 3 >> 1;
+#define F_P010 buf_size = stride * height * 3 >> 1;
+#define F_420P10 buf_size = stride * height * 3 >> 1;
+#define F_444P16 buf_size = stride * height * 3;
+#define F_RGBF32 buf_size = stride * height * 3;
 #define F_DFT buf_size = 0;
     INTERNAL_FFMPEG_FMT_SWITCH(fmt);
 
 #undef F_DFT
+#undef F_RGBF32
+#undef F_444P16
+#undef F_420P10
+#undef F_P010
 #undef F_NV12
 #undef F_NV21
 #undef F_444P
     return buf_size;
 }
 
+hide_symbol inline unsigned int
+internal_fmt_packed_size(enum AVPixelFormat fmt,
+    int width, int height)
+{
+    /* only the formats without chroma subsampling can be packed */
+    switch (fmt) {
+        case AV_PIX_FMT_YUV444P: return width * height * 3;
+        case AV_PIX_FMT_GBRP: return width * height * 3 * sizeof(float);
+        default: return 0;
+    }
+}
+
 hide_symbol inline int
-internal_fmt_img_result(pollux_decode_result_t *p_res,
+internal_fmt_img_copy(unsigned char *p_dst,
     const AVFrame *p_frame,
-    enum AVPixelFormat fmt)
+    enum AVPixelFormat fmt,
+    pollux_layout_t layout,
+    const internal_fmt_norm_t *p_norm)
 {
     int ret = POLLUX_OK;
 
-#define F_444P i_result_444p(p_res, p_frame);
-#define F_NV21 i_result_y_uv(p_res, p_frame, POLLUX_FMT_NV21);
-#define F_NV12 i_result_y_uv(p_res, p_frame, POLLUX_FMT_NV12);
+    if (layout == POLLUX_LAYOUT_PACKED) {
+        switch (fmt) {
+            case AV_PIX_FMT_YUV444P:
+                i_copy_444p_packed(p_dst, p_frame);
+                break;
+            case AV_PIX_FMT_GBRP:
+                i_copy_rgb_f32_packed(p_dst, p_frame, p_norm);
+                break;
+            default:
+                ret = POLLUX_ERR_UNSUPPORTED;
+                break;
+        }
+        return ret;
+    }
+
+#define F_444P i_copy_444p(p_dst, p_frame);
+#define F_NV21 i_copy_y_uv(p_dst, p_frame);
+#define F_NV12 i_copy_y_uv(p_dst, p_frame);
+#define F_P010 i_copy_y_uv(p_dst, p_frame);
+#define F_420P10 i_copy_420p(p_dst, p_frame);
+#define F_444P16 i_copy_444p(p_dst, p_frame);
+#define F_RGBF32 i_copy_rgb_f32(p_dst, p_frame, p_norm);
 #define F_DFT ret = POLLUX_ERR_INVALID_PARAMETER;
     INTERNAL_FFMPEG_FMT_SWITCH(fmt);
 
 #undef F_DFT
+#undef F_RGBF32
+#undef F_444P16
+#undef F_420P10
+#undef F_P010
 #undef F_NV12
 #undef F_NV21
 #undef F_444P
     return ret;
 }
+
+hide_symbol inline int
+internal_fmt_img_result(pollux_decode_result_t *p_res,
+    const AVFrame *p_frame,
+    enum AVPixelFormat fmt,
+    const internal_fmt_norm_t *p_norm)
+{
+    int ret = POLLUX_OK;
+
+#define F_444P p_res->fmt = POLLUX_FMT_444P;
+#define F_NV21 p_res->fmt = POLLUX_FMT_NV21;
+#define F_NV12 p_res->fmt = POLLUX_FMT_NV12;
+#define F_P010 p_res->fmt = POLLUX_FMT_P010;
+#define F_420P10 p_res->fmt = POLLUX_FMT_YUV420P10;
+#define F_444P16 p_res->fmt = POLLUX_FMT_YUV444P16;
+#define F_RGBF32 p_res->fmt = POLLUX_FMT_RGB_F32;
+#define F_DFT ret = POLLUX_ERR_INVALID_PARAMETER;
+    INTERNAL_FFMPEG_FMT_SWITCH(fmt);
+
+#undef F_DFT
+#undef F_RGBF32
+#undef F_444P16
+#undef F_420P10
+#undef F_P010
+#undef F_NV12
+#undef F_NV21
+#undef F_444P
+    if (ret) return ret;
+
+    return internal_fmt_img_copy(
+        p_res->buf, p_frame, fmt, POLLUX_LAYOUT_PLANAR, p_norm);
+}
@@ -0,0 +1,319 @@
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_kfidx.h"
+#include "./internal/pollux_internal_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define I_SIDECAR_MAGIC "PXKI"
+/* 2: the entries carry the decoding timestamps */
+#define I_SIDECAR_VERSION (2)
+
+/**
+ * header of the sidecar file, followed by `nr` entries;
+ * the size and the modification time tell whether the
+ * sidecar still belongs to the file
+ */
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t size;
+    int64_t mtime_ns;
+    uint64_t nr;
+} i_sidecar_hdr_t;
+
+/**
+ * @brief append a keyframe; one not after the last entry, e.g. in a
+ *  stream whose timestamps go back, is left out, so that the entries
+ *  stay in ascending order for the binary search
+ */
+static int
+i_entry_add(internal_kfidx_t *p_idx, int64_t ts, int64_t frame_nr)
+{
+    if (p_idx->nr && ts <= p_idx->p_entry[p_idx->nr - 1].ts)
+        return POLLUX_OK;
+
+    if (p_idx->nr == p_idx->cap) {
+        size_t cap = (p_idx->cap) ? p_idx->cap * 2 : 256;
+        internal_kf_entry_t *p = (internal_kf_entry_t *)
+            realloc(p_idx->p_entry, cap * sizeof(internal_kf_entry_t));
+        if (!(p)) {
+            SIRIUS_ERROR("realloc\n");
+            return POLLUX_ERR_MEMORY_ALLOC;
+        }
+        p_idx->p_entry = p;
+        p_idx->cap = cap;
+    }
+
+    p_idx->p_entry[p_idx->nr].ts = ts;
+    p_idx->p_entry[p_idx->nr].frame_nr = frame_nr;
+    p_idx->nr++;
+    return POLLUX_OK;
+}
+
+static inline void
+i_entry_clear(internal_kfidx_t *p_idx)
+{
+    free(p_idx->p_entry);
+    p_idx->p_entry = NULL;
+    p_idx->nr = 0;
+    p_idx->cap = 0;
+}
+
+/**
+ * @brief take the keyframes from the index of the demuxer, only if
+ *  it lists every frame, so that the frame numbers hold
+ */
+static int
+i_demuxer_load(internal_kfidx_t *p_idx, AVStream *st)
+{
+    int n = avformat_index_get_entries_count(st);
+    if (n <= 0 || st->nb_frames <= 0 || n < st->nb_frames)
+        return POLLUX_ERR;
+
+    const AVIndexEntry *e;
+    int64_t frame_nr = 0;
+    for (int i = 0; i < n; i++) {
+        if (!(e = avformat_index_get_entry(st, i))) break;
+        if (e->flags & AVINDEX_DISCARD_FRAME) continue;
+
+        if ((e->flags & AVINDEX_KEYFRAME) &&
+            i_entry_add(p_idx, e->timestamp, frame_nr)) {
+            i_entry_clear(p_idx);
+            return POLLUX_ERR;
+        }
+        frame_nr++;
+    }
+
+    return (p_idx->nr) ? POLLUX_OK : POLLUX_ERR;
+}
+
+/**
+ * @brief the entries are in ascending order of both fields,
+ *  the sidecar may come from anywhere
+ */
+static bool
+i_entry_is_sorted(const internal_kfidx_t *p_idx)
+{
+    for (size_t i = 1; i < p_idx->nr; i++) {
+        if (p_idx->p_entry[i].ts <= p_idx->p_entry[i - 1].ts ||
+            p_idx->p_entry[i].frame_nr <= p_idx->p_entry[i - 1].frame_nr)
+            return false;
+    }
+
+    return true;
+}
+
+static int
+i_file_stat(const char *p_file, i_sidecar_hdr_t *p_hdr)
+{
+    if (internal_file_stat(p_file, &(p_hdr->size), &(p_hdr->mtime_ns)))
+        return POLLUX_ERR;
+
+    memcpy(p_hdr->magic, I_SIDECAR_MAGIC, sizeof(p_hdr->magic));
+    p_hdr->version = I_SIDECAR_VERSION;
+    return POLLUX_OK;
+}
+
+static int
+i_sidecar_load(internal_kfidx_t *p_idx)
+{
+    i_sidecar_hdr_t want = {0}, hdr;
+    if (i_file_stat(p_idx->file, &want)) return POLLUX_ERR;
+
+    FILE *fp = fopen(p_idx->sidecar, "rb");
+    if (!(fp)) return POLLUX_ERR;
+
+    int ret = POLLUX_ERR;
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+        memcmp(hdr.magic, want.magic, sizeof(hdr.magic)) ||
+        hdr.version != want.version || hdr.size != want.size ||
+        hdr.mtime_ns != want.mtime_ns || hdr.nr == 0) {
+        SIRIUS_INFO("the sidecar [%s] is stale\n", p_idx->sidecar);
+        goto label_file_close;
+    }
+
+    p_idx->p_entry = (internal_kf_entry_t *)
+        malloc(hdr.nr * sizeof(internal_kf_entry_t));
+    if (!(p_idx->p_entry)) {
+        SIRIUS_ERROR("malloc\n");
+        goto label_file_close;
+    }
+    if (fread(p_idx->p_entry,
+        sizeof(internal_kf_entry_t), hdr.nr, fp) != hdr.nr) {
+        i_entry_clear(p_idx);
+        goto label_file_close;
+    }
+    p_idx->nr = p_idx->cap = hdr.nr;
+    if (!(i_entry_is_sorted(p_idx))) {
+        SIRIUS_WARN("the sidecar [%s] is not sorted\n", p_idx->sidecar);
+        i_entry_clear(p_idx);
+        goto label_file_close;
+    }
+    ret = POLLUX_OK;
+
+label_file_close:
+    fclose(fp);
+    return ret;
+}
+
+static bool
+i_sidecar_write(FILE *fp, void *args)
+{
+    internal_kfidx_t *p_idx = (internal_kfidx_t *)args;
+    i_sidecar_hdr_t hdr = {0};
+    if (i_file_stat(p_idx->file, &hdr)) return false;
+    hdr.nr = p_idx->nr;
+
+    return fwrite(&hdr, sizeof(hdr), 1, fp) == 1 &&
+        fwrite(p_idx->p_entry, sizeof(internal_kf_entry_t),
+            p_idx->nr, fp) == p_idx->nr;
+}
+
+/**
+ * @brief the interrupt callback of the scan, blocking I/O is
+ *  given up once `internal_kfidx_close` asks the scan to stop
+ */
+static int
+i_scan_interrupt(void *args)
+{
+    internal_kfidx_t *p_idx = (internal_kfidx_t *)args;
+    return atomic_load_explicit(&(p_idx->stop), memory_order_relaxed);
+}
+
+/**
+ * @brief read every packet of the file without decoding,
+ *  on a format context of its own
+ */
+static void *
+i_scan_thd(void *args)
+{
+    internal_kfidx_t *p_idx = (internal_kfidx_t *)args;
+    AVFormatContext *fmt_ctx = NULL;
+    AVPacket *pkt = NULL;
+
+    if (!(fmt_ctx = avformat_alloc_context())) {
+        SIRIUS_ERROR("avformat_alloc_context\n");
+        return NULL;
+    }
+    fmt_ctx->interrupt_callback.callback = i_scan_interrupt;
+    fmt_ctx->interrupt_callback.opaque = (void *)p_idx;
+    /* `fmt_ctx` is freed on failure */
+    if (avformat_open_input(&fmt_ctx, p_idx->file, NULL, NULL)) {
+        SIRIUS_ERROR("avformat_open_input\n");
+        return NULL;
+    }
+    if (p_idx->stream_index >= fmt_ctx->nb_streams ||
+        !(pkt = av_packet_alloc())) {
+        goto label_input_close;
+    }
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
+        if (i != p_idx->stream_index)
+            fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+    }
+
+    int64_t frame_nr = 0, ts;
+    while (!(atomic_load_explicit(&(p_idx->stop), memory_order_relaxed)) &&
+        av_read_frame(fmt_ctx, pkt) >= 0) {
+        if (pkt->stream_index == (int)(p_idx->stream_index)) {
+            /* the same timestamps as the index of the demuxer */
+            ts = (pkt->dts != AV_NOPTS_VALUE) ? pkt->dts : pkt->pts;
+            if ((pkt->flags & AV_PKT_FLAG_KEY) && ts != AV_NOPTS_VALUE &&
+                i_entry_add(p_idx, ts, frame_nr)) {
+                av_packet_unref(pkt);
+                break;
+            }
+            frame_nr++;
+        }
+        av_packet_unref(pkt);
+    }
+
+    if (!(atomic_load(&(p_idx->stop))) && p_idx->nr) {
+        SIRIUS_INFO("keyframe index: %zu keyframes, %lld frames\n",
+            p_idx->nr, (long long)frame_nr);
+        if (p_idx->sidecar[0])
+            (void)internal_file_replace(p_idx->sidecar, i_sidecar_write, p_idx);
+        atomic_store_explicit(&(p_idx->ready), true, memory_order_release);
+    }
+
+    av_packet_free(&pkt);
+
+label_input_close:
+    avformat_close_input(&fmt_ctx);
+    return NULL;
+}
+
+hide_symbol int
+internal_kfidx_open(internal_kfidx_t *p_idx,
+    AVFormatContext *fmt_ctx, unsigned int stream_index,
+    const char *p_file, const char *p_sidecar)
+{
+    AVStream *st = fmt_ctx->streams[stream_index];
+    memset(p_idx, 0, sizeof(internal_kfidx_t));
+    p_idx->stream_index = stream_index;
+    p_idx->time_base = st->time_base;
+    p_idx->start_time =
+        (st->start_time != AV_NOPTS_VALUE) ? st->start_time : 0;
+    strncpy(p_idx->file, p_file, sizeof(p_idx->file) - 1);
+    if (p_sidecar)
+        strncpy(p_idx->sidecar, p_sidecar, sizeof(p_idx->sidecar) - 1);
+
+    if (i_demuxer_load(p_idx, st) == POLLUX_OK ||
+        (p_idx->sidecar[0] && i_sidecar_load(p_idx) == POLLUX_OK)) {
+        atomic_store_explicit(&(p_idx->ready), true, memory_order_release);
+        return POLLUX_OK;
+    }
+
+    int ret = pthread_create(&(p_idx->thd), NULL, i_scan_thd, p_idx);
+    if (ret) {
+        SIRIUS_ERROR("pthread_create: %d\n", ret);
+        return POLLUX_ERR;
+    }
+    p_idx->thd_valid = true;
+
+    return POLLUX_OK;
+}
+
+hide_symbol void
+internal_kfidx_close(internal_kfidx_t *p_idx)
+{
+    if (p_idx->thd_valid) {
+        atomic_store(&(p_idx->stop), true);
+        pthread_join(p_idx->thd, NULL);
+        p_idx->thd_valid = false;
+    }
+
+    atomic_store(&(p_idx->ready), false);
+    i_entry_clear(p_idx);
+}
+
+#define I_KFIDX_FIND(p_idx, field, value) \
+    if (!(atomic_load_explicit(&((p_idx)->ready), memory_order_acquire)) || \
+        !((p_idx)->nr)) \
+        return NULL; \
+    size_t lo = 0, hi = (p_idx)->nr; \
+    while (hi - lo > 1) { \
+        size_t mid = lo + (hi - lo) / 2; \
+        if ((p_idx)->p_entry[mid].field <= (value)) { \
+            lo = mid; \
+        } else { \
+            hi = mid; \
+        } \
+    } \
+    return &((p_idx)->p_entry[lo]);
+
+hide_symbol const internal_kf_entry_t *
+internal_kfidx_by_ts(internal_kfidx_t *p_idx, int64_t ts)
+{
+    I_KFIDX_FIND(p_idx, ts, ts);
+}
+
+hide_symbol const internal_kf_entry_t *
+internal_kfidx_by_frame(internal_kfidx_t *p_idx, int64_t frame_nr)
+{
+    I_KFIDX_FIND(p_idx, frame_nr, frame_nr);
+}
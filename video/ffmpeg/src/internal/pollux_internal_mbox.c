@@ -0,0 +1,99 @@
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_mbox.h"
+
+#include <time.h>
+
+hide_symbol void
+internal_mbox_deinit(internal_mbox_t *p_mbox)
+{
+    pthread_cond_destroy(&(p_mbox->cond));
+    pthread_mutex_destroy(&(p_mbox->mtx));
+    p_mbox->p_elem = NULL;
+}
+
+hide_symbol int
+internal_mbox_init(internal_mbox_t *p_mbox)
+{
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr)) {
+        SIRIUS_ERROR("pthread_condattr_init\n");
+        return POLLUX_ERR_RESOURCE_REQUEST;
+    }
+    /* the wait timeout must not be affected by wall clock changes */
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    int ret = POLLUX_OK;
+    if (pthread_cond_init(&(p_mbox->cond), &attr)) {
+        SIRIUS_ERROR("pthread_cond_init\n");
+        ret = POLLUX_ERR_RESOURCE_REQUEST;
+        goto label_attr_destroy;
+    }
+    pthread_mutex_init(&(p_mbox->mtx), NULL);
+    p_mbox->p_elem = NULL;
+    p_mbox->kick = false;
+
+label_attr_destroy:
+    pthread_condattr_destroy(&attr);
+    return ret;
+}
+
+hide_symbol void *
+internal_mbox_put(internal_mbox_t *p_mbox, void *p_elem)
+{
+    pthread_mutex_lock(&(p_mbox->mtx));
+    void *p_old = p_mbox->p_elem;
+    p_mbox->p_elem = p_elem;
+    pthread_mutex_unlock(&(p_mbox->mtx));
+
+    pthread_cond_signal(&(p_mbox->cond));
+    return p_old;
+}
+
+hide_symbol void *
+internal_mbox_get(internal_mbox_t *p_mbox, unsigned int timeout_ms)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&(p_mbox->mtx));
+    while (!(p_mbox->p_elem) && !(p_mbox->kick)) {
+        if (pthread_cond_timedwait(
+            &(p_mbox->cond), &(p_mbox->mtx), &ts)) break;
+    }
+    void *p_elem = p_mbox->p_elem;
+    p_mbox->p_elem = NULL;
+    p_mbox->kick = false;
+    pthread_mutex_unlock(&(p_mbox->mtx));
+
+    return p_elem;
+}
+
+hide_symbol void
+internal_mbox_kick(internal_mbox_t *p_mbox)
+{
+    pthread_mutex_lock(&(p_mbox->mtx));
+    p_mbox->kick = true;
+    pthread_mutex_unlock(&(p_mbox->mtx));
+
+    pthread_cond_broadcast(&(p_mbox->cond));
+}
+
+hide_symbol void *
+internal_mbox_reset(internal_mbox_t *p_mbox)
+{
+    pthread_mutex_lock(&(p_mbox->mtx));
+    void *p_elem = p_mbox->p_elem;
+    p_mbox->p_elem = NULL;
+    p_mbox->kick = false;
+    pthread_mutex_unlock(&(p_mbox->mtx));
+
+    return p_elem;
+}
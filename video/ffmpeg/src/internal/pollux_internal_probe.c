@@ -0,0 +1,622 @@
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_probe.h"
+#include "./internal/pollux_internal_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <sys/uio.h>
+
+#define I_PROBE_MAGIC "PXPC"
+#define I_PROBE_VERSION (1)
+
+typedef struct {
+    AVCodecParameters *par;
+    AVRational time_base;
+    AVRational avg_frame_rate;
+    AVRational r_frame_rate;
+    int64_t start_time;
+    int64_t duration;
+    int64_t nb_frames;
+} i_probe_stream_t;
+
+typedef struct {
+    char *p_path;
+    uint64_t size;
+    int64_t mtime_ns;
+
+    /* short name of the input format */
+    char iformat[32];
+    /* start time and duration of the format context */
+    int64_t start_time;
+    int64_t duration;
+
+    unsigned int stream_nr;
+    i_probe_stream_t *p_stream;
+
+    /* the last use, the least recently used entry is evicted first */
+    unsigned long long used;
+} i_probe_entry_t;
+
+/**
+ * records of the cache file, native byte order,
+ * the file is only meant for the machine that wrote it
+ */
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_nr;
+} i_probe_file_hdr_t;
+
+typedef struct {
+    uint32_t path_len;
+    uint32_t stream_nr;
+    uint64_t size;
+    int64_t mtime_ns;
+    int64_t start_time;
+    int64_t duration;
+    char iformat[32];
+} i_probe_entry_rec_t;
+
+typedef struct {
+    int32_t codec_type, codec_id;
+    uint32_t codec_tag;
+    int32_t format;
+    int64_t bit_rate;
+    int32_t bits_per_coded_sample, bits_per_raw_sample;
+    int32_t profile, level;
+    int32_t width, height;
+    int32_t sar_num, sar_den;
+    int32_t fr_num, fr_den;
+    int32_t field_order, color_range, color_primaries;
+    int32_t color_trc, color_space, chroma_location;
+    int32_t video_delay;
+    int32_t ch_order, ch_nb;
+    uint64_t ch_mask;
+    int32_t sample_rate, block_align, frame_size;
+    int32_t initial_padding, trailing_padding, seek_preroll;
+    int32_t extradata_size;
+
+    int32_t tb_num, tb_den;
+    int32_t afr_num, afr_den;
+    int32_t rfr_num, rfr_den;
+    int64_t start_time, duration, nb_frames;
+} i_probe_stream_rec_t;
+
+static struct {
+    pthread_mutex_t mtx;
+
+    /* `nr` entries in use, room for `max` */
+    i_probe_entry_t *p_entry;
+    unsigned int nr;
+    unsigned int max;
+
+    /* use counter */
+    unsigned long long clock;
+
+    /* the cache file, empty if none */
+    char file[PATH_MAX];
+    /**
+     * the cache file is behind the entries; `writing` is set while
+     * a thread writes it outside the mutex, refer to `i_file_flush`
+     */
+    bool dirty;
+    bool writing;
+} i_probe = {
+    .mtx = PTHREAD_MUTEX_INITIALIZER,
+    .max = INTERNAL_PROBE_ENTRY_NR,
+};
+
+static void
+i_entry_clear(i_probe_entry_t *p_e)
+{
+    for (unsigned int i = 0; i < p_e->stream_nr; i++) {
+        avcodec_parameters_free(&(p_e->p_stream[i].par));
+    }
+    free(p_e->p_stream);
+    free(p_e->p_path);
+    memset(p_e, 0, sizeof(i_probe_entry_t));
+}
+
+/**
+ * @brief drop the entry at `index`, the last entry takes its place
+ */
+static void
+i_entry_remove(unsigned int index)
+{
+    i_entry_clear(&(i_probe.p_entry[index]));
+    if (index != --(i_probe.nr)) {
+        i_probe.p_entry[index] = i_probe.p_entry[i_probe.nr];
+        memset(&(i_probe.p_entry[i_probe.nr]), 0, sizeof(i_probe_entry_t));
+    }
+}
+
+static void
+i_entry_evict(void)
+{
+    unsigned int lru = 0;
+    for (unsigned int i = 1; i < i_probe.nr; i++) {
+        if (i_probe.p_entry[i].used < i_probe.p_entry[lru].used) lru = i;
+    }
+    i_entry_remove(lru);
+}
+
+/**
+ * @brief find the entry of a file, `i_probe.mtx` must be held
+ * 
+ * @return the entry, `NULL` on a miss; a stale entry of the path
+ *  is dropped on the way
+ */
+static i_probe_entry_t *
+i_entry_find(const internal_probe_key_t *p_key)
+{
+    i_probe_entry_t *p_e;
+    for (unsigned int i = 0; i < i_probe.nr; i++) {
+        p_e = &(i_probe.p_entry[i]);
+        if (strcmp(p_e->p_path, p_key->p_path)) continue;
+
+        if (p_e->size == p_key->size && p_e->mtime_ns == p_key->mtime_ns) {
+            p_e->used = ++(i_probe.clock);
+            return p_e;
+        }
+        i_entry_remove(i);
+        return NULL;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief a cleared entry for a new file, `i_probe.mtx` must be held
+ */
+static i_probe_entry_t *
+i_entry_new(void)
+{
+    if (i_probe.max == 0) return NULL;
+
+    if (!(i_probe.p_entry)) {
+        i_probe.p_entry = (i_probe_entry_t *)
+            calloc(i_probe.max, sizeof(i_probe_entry_t));
+        if (!(i_probe.p_entry)) {
+            SIRIUS_ERROR("calloc\n");
+            return NULL;
+        }
+    }
+    if (i_probe.nr == i_probe.max) i_entry_evict();
+
+    i_probe_entry_t *p_e = &(i_probe.p_entry[i_probe.nr++]);
+    p_e->used = ++(i_probe.clock);
+    return p_e;
+}
+
+static void
+i_rec_from_stream(i_probe_stream_rec_t *p_r, const i_probe_stream_t *p_s)
+{
+    const AVCodecParameters *p = p_s->par;
+    memset(p_r, 0, sizeof(i_probe_stream_rec_t));
+    p_r->codec_type = p->codec_type;
+    p_r->codec_id = p->codec_id;
+    p_r->codec_tag = p->codec_tag;
+    p_r->format = p->format;
+    p_r->bit_rate = p->bit_rate;
+    p_r->bits_per_coded_sample = p->bits_per_coded_sample;
+    p_r->bits_per_raw_sample = p->bits_per_raw_sample;
+    p_r->profile = p->profile;
+    p_r->level = p->level;
+    p_r->width = p->width;
+    p_r->height = p->height;
+    p_r->sar_num = p->sample_aspect_ratio.num;
+    p_r->sar_den = p->sample_aspect_ratio.den;
+    p_r->fr_num = p->framerate.num;
+    p_r->fr_den = p->framerate.den;
+    p_r->field_order = p->field_order;
+    p_r->color_range = p->color_range;
+    p_r->color_primaries = p->color_primaries;
+    p_r->color_trc = p->color_trc;
+    p_r->color_space = p->color_space;
+    p_r->chroma_location = p->chroma_location;
+    p_r->video_delay = p->video_delay;
+    /* a custom channel map is not kept, only the number of channels */
+    p_r->ch_order = (p->ch_layout.order == AV_CHANNEL_ORDER_CUSTOM) ?
+        AV_CHANNEL_ORDER_UNSPEC : p->ch_layout.order;
+    p_r->ch_nb = p->ch_layout.nb_channels;
+    if (p->ch_layout.order == AV_CHANNEL_ORDER_NATIVE ||
+        p->ch_layout.order == AV_CHANNEL_ORDER_AMBISONIC)
+        p_r->ch_mask = p->ch_layout.u.mask;
+    p_r->sample_rate = p->sample_rate;
+    p_r->block_align = p->block_align;
+    p_r->frame_size = p->frame_size;
+    p_r->initial_padding = p->initial_padding;
+    p_r->trailing_padding = p->trailing_padding;
+    p_r->seek_preroll = p->seek_preroll;
+    p_r->extradata_size = p->extradata_size;
+
+    p_r->tb_num = p_s->time_base.num;
+    p_r->tb_den = p_s->time_base.den;
+    p_r->afr_num = p_s->avg_frame_rate.num;
+    p_r->afr_den = p_s->avg_frame_rate.den;
+    p_r->rfr_num = p_s->r_frame_rate.num;
+    p_r->rfr_den = p_s->r_frame_rate.den;
+    p_r->start_time = p_s->start_time;
+    p_r->duration = p_s->duration;
+    p_r->nb_frames = p_s->nb_frames;
+}
+
+static int
+i_rec_to_stream(i_probe_stream_t *p_s, const i_probe_stream_rec_t *p_r)
+{
+    AVCodecParameters *p = p_s->par = avcodec_parameters_alloc();
+    if (!(p)) return POLLUX_ERR_MEMORY_ALLOC;
+
+    p->codec_type = p_r->codec_type;
+    p->codec_id = p_r->codec_id;
+    p->codec_tag = p_r->codec_tag;
+    p->format = p_r->format;
+    p->bit_rate = p_r->bit_rate;
+    p->bits_per_coded_sample = p_r->bits_per_coded_sample;
+    p->bits_per_raw_sample = p_r->bits_per_raw_sample;
+    p->profile = p_r->profile;
+    p->level = p_r->level;
+    p->width = p_r->width;
+    p->height = p_r->height;
+    p->sample_aspect_ratio = (AVRational){p_r->sar_num, p_r->sar_den};
+    p->framerate = (AVRational){p_r->fr_num, p_r->fr_den};
+    p->field_order = p_r->field_order;
+    p->color_range = p_r->color_range;
+    p->color_primaries = p_r->color_primaries;
+    p->color_trc = p_r->color_trc;
+    p->color_space = p_r->color_space;
+    p->chroma_location = p_r->chroma_location;
+    p->video_delay = p_r->video_delay;
+    p->ch_layout.order = p_r->ch_order;
+    p->ch_layout.nb_channels = p_r->ch_nb;
+    if (p_r->ch_order == AV_CHANNEL_ORDER_NATIVE ||
+        p_r->ch_order == AV_CHANNEL_ORDER_AMBISONIC)
+        p->ch_layout.u.mask = p_r->ch_mask;
+    p->sample_rate = p_r->sample_rate;
+    p->block_align = p_r->block_align;
+    p->frame_size = p_r->frame_size;
+    p->initial_padding = p_r->initial_padding;
+    p->trailing_padding = p_r->trailing_padding;
+    p->seek_preroll = p_r->seek_preroll;
+
+    p_s->time_base = (AVRational){p_r->tb_num, p_r->tb_den};
+    p_s->avg_frame_rate = (AVRational){p_r->afr_num, p_r->afr_den};
+    p_s->r_frame_rate = (AVRational){p_r->rfr_num, p_r->rfr_den};
+    p_s->start_time = p_r->start_time;
+    p_s->duration = p_r->duration;
+    p_s->nb_frames = p_r->nb_frames;
+
+    return POLLUX_OK;
+}
+
+/**
+ * @brief write the entries, `i_probe.mtx` must be held
+ */
+static bool
+i_file_write(FILE *fp, void *args)
+{
+    i_probe_file_hdr_t hdr = {0};
+    memcpy(hdr.magic, I_PROBE_MAGIC, sizeof(hdr.magic));
+    hdr.version = I_PROBE_VERSION;
+    hdr.entry_nr = i_probe.nr;
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1;
+
+    i_probe_entry_t *p_e;
+    i_probe_entry_rec_t er;
+    i_probe_stream_rec_t sr;
+    for (unsigned int i = 0; ok && i < i_probe.nr; i++) {
+        p_e = &(i_probe.p_entry[i]);
+        memset(&er, 0, sizeof(er));
+        er.path_len = (uint32_t)strlen(p_e->p_path);
+        er.stream_nr = p_e->stream_nr;
+        er.size = p_e->size;
+        er.mtime_ns = p_e->mtime_ns;
+        er.start_time = p_e->start_time;
+        er.duration = p_e->duration;
+        memcpy(er.iformat, p_e->iformat, sizeof(er.iformat));
+        ok = fwrite(&er, sizeof(er), 1, fp) == 1 &&
+            fwrite(p_e->p_path, 1, er.path_len, fp) == er.path_len;
+
+        for (unsigned int j = 0; ok && j < p_e->stream_nr; j++) {
+            i_rec_from_stream(&sr, &(p_e->p_stream[j]));
+            ok = fwrite(&sr, sizeof(sr), 1, fp) == 1 &&
+                fwrite(p_e->p_stream[j].par->extradata, 1,
+                    sr.extradata_size, fp) == (size_t)(sr.extradata_size);
+        }
+    }
+
+    return ok;
+}
+
+static bool
+i_buf_write(FILE *fp, void *args)
+{
+    const struct iovec *p_v = (const struct iovec *)args;
+    return fwrite(p_v->iov_base, 1, p_v->iov_len, fp) == p_v->iov_len;
+}
+
+/**
+ * @brief bring the cache file up to date with the entries,
+ *  `i_probe.mtx` must be held, it is dropped while the file is written
+ * 
+ * the entries are copied to memory under the mutex and written without
+ * it, so that the other handles are not held up by the disk; the
+ * changes made meanwhile are left to the thread already writing, which
+ * writes again until nothing is left
+ */
+static void
+i_file_flush(void)
+{
+    i_probe.dirty = true;
+    if (i_probe.writing) return;
+
+    char file[PATH_MAX];
+    struct iovec v;
+    FILE *fp;
+    bool ok;
+    i_probe.writing = true;
+    while (i_probe.dirty && i_probe.file[0]) {
+        i_probe.dirty = false;
+        strcpy(file, i_probe.file);
+
+        v.iov_base = NULL;
+        if (!(fp = open_memstream((char **)&(v.iov_base), &(v.iov_len)))) {
+            SIRIUS_ERROR("open_memstream\n");
+            break;
+        }
+        ok = i_file_write(fp, NULL);
+        ok = (fclose(fp) == 0) && ok;
+
+        pthread_mutex_unlock(&(i_probe.mtx));
+        if (ok) (void)internal_file_replace(file, i_buf_write, &v);
+        free(v.iov_base);
+        pthread_mutex_lock(&(i_probe.mtx));
+    }
+    i_probe.writing = false;
+}
+
+static int
+i_file_entry_load(FILE *fp, i_probe_entry_t *p_e)
+{
+    i_probe_entry_rec_t er;
+    if (fread(&er, sizeof(er), 1, fp) != 1 ||
+        er.path_len == 0 || er.path_len >= PATH_MAX)
+        return POLLUX_ERR;
+
+    if (!(p_e->p_path = (char *)calloc(1, er.path_len + 1)) ||
+        fread(p_e->p_path, 1, er.path_len, fp) != er.path_len)
+        return POLLUX_ERR;
+    p_e->size = er.size;
+    p_e->mtime_ns = er.mtime_ns;
+    p_e->start_time = er.start_time;
+    p_e->duration = er.duration;
+    memcpy(p_e->iformat, er.iformat, sizeof(p_e->iformat));
+    p_e->iformat[sizeof(p_e->iformat) - 1] = '\0';
+
+    p_e->p_stream = (i_probe_stream_t *)
+        calloc(er.stream_nr, sizeof(i_probe_stream_t));
+    if (!(p_e->p_stream)) return POLLUX_ERR;
+
+    i_probe_stream_rec_t sr;
+    AVCodecParameters *p;
+    for (unsigned int j = 0; j < er.stream_nr; j++) {
+        if (fread(&sr, sizeof(sr), 1, fp) != 1 || sr.extradata_size < 0 ||
+            i_rec_to_stream(&(p_e->p_stream[j]), &sr))
+            return POLLUX_ERR;
+        p_e->stream_nr = j + 1;
+
+        if (!(sr.extradata_size)) continue;
+        p = p_e->p_stream[j].par;
+        p->extradata = (uint8_t *)av_mallocz(
+            sr.extradata_size + AV_INPUT_BUFFER_PADDING_SIZE);
+        if (!(p->extradata) ||
+            fread(p->extradata, 1, sr.extradata_size, fp) !=
+            (size_t)(sr.extradata_size))
+            return POLLUX_ERR;
+        p->extradata_size = sr.extradata_size;
+    }
+
+    return POLLUX_OK;
+}
+
+/**
+ * @brief load the cache file, `i_probe.mtx` must be held
+ */
+static void
+i_file_load(void)
+{
+    FILE *fp = fopen(i_probe.file, "rb");
+    if (!(fp)) return;
+
+    i_probe_file_hdr_t hdr;
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+        memcmp(hdr.magic, I_PROBE_MAGIC, sizeof(hdr.magic)) ||
+        hdr.version != I_PROBE_VERSION) {
+        SIRIUS_WARN("the probe cache [%s] is not valid\n", i_probe.file);
+        goto label_file_close;
+    }
+
+    i_probe_entry_t *p_e;
+    internal_probe_key_t key;
+    for (unsigned int i = 0; i < hdr.entry_nr; i++) {
+        if (!(p_e = i_entry_new())) break;
+        if (i_file_entry_load(fp, p_e)) {
+            SIRIUS_WARN("the probe cache [%s] is truncated\n", i_probe.file);
+            i_entry_remove(i_probe.nr - 1);
+            break;
+        }
+
+        /* the files changed since then are forgotten at once */
+        if (internal_probe_key_get(p_e->p_path, &key) ||
+            key.size != p_e->size || key.mtime_ns != p_e->mtime_ns) {
+            i_entry_remove(i_probe.nr - 1);
+        }
+    }
+    SIRIUS_INFO("probe cache: %u files\n", i_probe.nr);
+
+label_file_close:
+    fclose(fp);
+}
+
+hide_symbol int
+internal_probe_config(unsigned int entry_nr, const char *p_file)
+{
+    pthread_mutex_lock(&(i_probe.mtx));
+
+    while (i_probe.nr > entry_nr) i_entry_evict();
+    if (i_probe.p_entry && entry_nr != i_probe.max) {
+        i_probe_entry_t *p = NULL;
+        if (entry_nr && !(p = (i_probe_entry_t *)
+            realloc(i_probe.p_entry, entry_nr * sizeof(i_probe_entry_t)))) {
+            SIRIUS_ERROR("realloc\n");
+            pthread_mutex_unlock(&(i_probe.mtx));
+            return POLLUX_ERR_MEMORY_ALLOC;
+        }
+        if (!(p)) free(i_probe.p_entry);
+        /* `i_entry_new` takes the new room as cleared */
+        if (entry_nr > i_probe.max) {
+            memset(p + i_probe.max, 0,
+                (entry_nr - i_probe.max) * sizeof(i_probe_entry_t));
+        }
+        i_probe.p_entry = p;
+    }
+    i_probe.max = entry_nr;
+
+    i_probe.file[0] = '\0';
+    if (p_file && entry_nr) {
+        strncpy(i_probe.file, p_file, sizeof(i_probe.file) - 1);
+        i_file_load();
+    }
+
+    pthread_mutex_unlock(&(i_probe.mtx));
+    return POLLUX_OK;
+}
+
+hide_symbol int
+internal_probe_key_get(const char *p_path, internal_probe_key_t *p_key)
+{
+    if (internal_file_stat(p_path, &(p_key->size), &(p_key->mtime_ns)))
+        return POLLUX_ERR;
+
+    p_key->p_path = p_path;
+    return POLLUX_OK;
+}
+
+hide_symbol const AVInputFormat *
+internal_probe_iformat(const internal_probe_key_t *p_key)
+{
+    const AVInputFormat *p_fmt = NULL;
+    pthread_mutex_lock(&(i_probe.mtx));
+    i_probe_entry_t *p_e = i_entry_find(p_key);
+    if (p_e && p_e->iformat[0]) p_fmt = av_find_input_format(p_e->iformat);
+    pthread_mutex_unlock(&(i_probe.mtx));
+
+    return p_fmt;
+}
+
+hide_symbol int
+internal_probe_apply(const internal_probe_key_t *p_key,
+    AVFormatContext *fmt_ctx)
+{
+    int ret = POLLUX_ERR;
+    pthread_mutex_lock(&(i_probe.mtx));
+    i_probe_entry_t *p_e = i_entry_find(p_key);
+    if (!(p_e) || p_e->stream_nr != fmt_ctx->nb_streams)
+        goto label_mtx_unlock;
+
+    /* the container header must agree before anything is touched */
+    for (unsigned int i = 0; i < p_e->stream_nr; i++) {
+        if (p_e->p_stream[i].time_base.num !=
+            fmt_ctx->streams[i]->time_base.num ||
+            p_e->p_stream[i].time_base.den !=
+            fmt_ctx->streams[i]->time_base.den)
+            goto label_mtx_unlock;
+    }
+
+    AVStream *st;
+    const i_probe_stream_t *p_s;
+    for (unsigned int i = 0; i < p_e->stream_nr; i++) {
+        st = fmt_ctx->streams[i];
+        p_s = &(p_e->p_stream[i]);
+        if (avcodec_parameters_copy(st->codecpar, p_s->par) < 0) {
+            SIRIUS_ERROR("avcodec_parameters_copy\n");
+            goto label_mtx_unlock;
+        }
+        st->avg_frame_rate = p_s->avg_frame_rate;
+        st->r_frame_rate = p_s->r_frame_rate;
+        st->start_time = p_s->start_time;
+        st->duration = p_s->duration;
+        st->nb_frames = p_s->nb_frames;
+    }
+    fmt_ctx->start_time = p_e->start_time;
+    fmt_ctx->duration = p_e->duration;
+    ret = POLLUX_OK;
+
+label_mtx_unlock:
+    pthread_mutex_unlock(&(i_probe.mtx));
+    return ret;
+}
+
+hide_symbol void
+internal_probe_store(const internal_probe_key_t *p_key,
+    const AVFormatContext *fmt_ctx)
+{
+    pthread_mutex_lock(&(i_probe.mtx));
+
+    i_probe_entry_t *p_e = i_entry_find(p_key);
+    if (p_e) {
+        i_entry_clear(p_e);
+    } else if (!(p_e = i_entry_new())) {
+        goto label_mtx_unlock;
+    }
+    p_e->used = ++(i_probe.clock);
+
+    if (!(p_e->p_path = strdup(p_key->p_path)) ||
+        !(p_e->p_stream = (i_probe_stream_t *)
+        calloc(fmt_ctx->nb_streams, sizeof(i_probe_stream_t)))) {
+        SIRIUS_ERROR("memory allocation\n");
+        goto label_entry_remove;
+    }
+    p_e->size = p_key->size;
+    p_e->mtime_ns = p_key->mtime_ns;
+    if (fmt_ctx->iformat && fmt_ctx->iformat->name)
+        strncpy(p_e->iformat, fmt_ctx->iformat->name,
+            sizeof(p_e->iformat) - 1);
+    p_e->start_time = fmt_ctx->start_time;
+    p_e->duration = fmt_ctx->duration;
+
+    AVStream *st;
+    i_probe_stream_t *p_s;
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
+        st = fmt_ctx->streams[i];
+        p_s = &(p_e->p_stream[i]);
+        if (!(p_s->par = avcodec_parameters_alloc()) ||
+            avcodec_parameters_copy(p_s->par, st->codecpar) < 0) {
+            SIRIUS_ERROR("avcodec_parameters_copy\n");
+            avcodec_parameters_free(&(p_s->par));
+            goto label_entry_remove;
+        }
+        p_e->stream_nr = i + 1;
+        p_s->time_base = st->time_base;
+        p_s->avg_frame_rate = st->avg_frame_rate;
+        p_s->r_frame_rate = st->r_frame_rate;
+        p_s->start_time = st->start_time;
+        p_s->duration = st->duration;
+        p_s->nb_frames = st->nb_frames;
+    }
+
+    if (i_probe.file[0]) i_file_flush();
+    goto label_mtx_unlock;
+
+label_entry_remove:
+    i_entry_remove((unsigned int)(p_e - i_probe.p_entry));
+
+label_mtx_unlock:
+    pthread_mutex_unlock(&(i_probe.mtx));
+}
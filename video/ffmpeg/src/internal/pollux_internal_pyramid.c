@@ -0,0 +1,90 @@
+#include "./internal/pollux_internal_pyramid.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief halve one line pair, `p_dst[x]` is the rounded average
+ *  of the 2x2 block at `2x` of the lines `p_s0` and `p_s1`
+ */
+static force_inline void
+i_box_line(unsigned char *restrict p_dst,
+    const unsigned char *restrict p_s0,
+    const unsigned char *restrict p_s1, int width)
+{
+    int x = 0;
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    const __m128i two = _mm_set1_epi16(2);
+    __m128i a, b, lo, hi;
+    /* 32 source pixels of each line give 16 destination pixels */
+    for (; x + 16 <= width; x += 16) {
+        a = _mm_loadu_si128((const __m128i *)(p_s0 + 2 * x));
+        b = _mm_loadu_si128((const __m128i *)(p_s1 + 2 * x));
+        lo = _mm_add_epi16(
+            _mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8)),
+            _mm_add_epi16(_mm_and_si128(b, mask), _mm_srli_epi16(b, 8)));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+
+        a = _mm_loadu_si128((const __m128i *)(p_s0 + 2 * x + 16));
+        b = _mm_loadu_si128((const __m128i *)(p_s1 + 2 * x + 16));
+        hi = _mm_add_epi16(
+            _mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8)),
+            _mm_add_epi16(_mm_and_si128(b, mask), _mm_srli_epi16(b, 8)));
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+
+        _mm_storeu_si128((__m128i *)(p_dst + x), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; x < width; x++) {
+        p_dst[x] = (p_s0[2 * x] + p_s0[2 * x + 1] +
+            p_s1[2 * x] + p_s1[2 * x + 1] + 2) >> 2;
+    }
+}
+
+hide_symbol unsigned int
+internal_pyramid_layout(pollux_decode_level_t *p_level,
+    unsigned int level_nr, int width, int height, int stride,
+    unsigned int base_size)
+{
+    unsigned int size = base_size;
+
+    p_level[0].width = width;
+    p_level[0].height = height;
+    p_level[0].stride = stride;
+    p_level[0].offset = 0;
+    for (unsigned int i = 1; i < level_nr; i++) {
+        width >>= 1;
+        height >>= 1;
+        if (width == 0 || height == 0) return 0;
+
+        p_level[i].width = width;
+        p_level[i].height = height;
+        p_level[i].stride = width;
+        p_level[i].offset = size;
+        size += width * height;
+    }
+
+    return size;
+}
+
+hide_symbol void
+internal_pyramid_build(unsigned char *p_buf,
+    const pollux_decode_level_t *p_level, unsigned int level_nr)
+{
+    const pollux_decode_level_t *p_src, *p_dst;
+    const unsigned char *p_s;
+    unsigned char *p_d;
+    for (unsigned int i = 1; i < level_nr; i++) {
+        p_src = &(p_level[i - 1]);
+        p_dst = &(p_level[i]);
+        p_s = p_buf + p_src->offset;
+        p_d = p_buf + p_dst->offset;
+        for (int y = 0; y < p_dst->height; y++) {
+            i_box_line(p_d, p_s, p_s + p_src->stride, p_dst->width);
+            p_s += p_src->stride << 1;
+            p_d += p_dst->stride;
+        }
+    }
+}
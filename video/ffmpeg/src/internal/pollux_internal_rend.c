@@ -0,0 +1,186 @@
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_rend.h"
+#include "./internal/pollux_internal_ffmpeg.h"
+
+#include "libavutil/imgutils.h"
+
+hide_symbol void
+internal_rend_deinit(internal_rend_t *p_rend)
+{
+    if (p_rend->h_que_free && p_rend->h_que_res)
+        internal_rend_data_free(p_rend);
+
+#define QUE_DEL(q) \
+    if (q) { \
+        if (sirius_que_del(q)) { \
+            SIRIUS_ERROR("sirius_que_del\n"); \
+        } else { \
+            q = NULL; \
+        } \
+    }
+    QUE_DEL(p_rend->h_que_res);
+    QUE_DEL(p_rend->h_que_free);
+#undef QUE_DEL
+
+    pthread_mutex_destroy(&(p_rend->mtx));
+}
+
+hide_symbol int
+internal_rend_init(internal_rend_t *p_rend)
+{
+    pthread_mutex_init(&(p_rend->mtx), NULL);
+
+    sirius_que_cr_t cr = {0};
+    /* one more for the `NULL` of `internal_rend_kick` */
+    cr.elem_nr = INTERNAL_REND_FRAME_NR + 1;
+    cr.que_type = SIRIUS_QUE_TYPE_MTX;
+#define QUE_CR(q) \
+    if (sirius_que_cr(&cr, &(q))) { \
+        SIRIUS_ERROR("sirius_que_cr\n"); \
+        goto label_deinit; \
+    }
+    QUE_CR(p_rend->h_que_free);
+    QUE_CR(p_rend->h_que_res);
+#undef QUE_CR
+
+    return POLLUX_OK;
+
+label_deinit:
+    internal_rend_deinit(p_rend);
+    return POLLUX_ERR_RESOURCE_REQUEST;
+}
+
+hide_symbol void
+internal_rend_data_free(internal_rend_t *p_rend)
+{
+    for (unsigned int i = 0; i < INTERNAL_REND_FRAME_NR; i++) {
+        if (!(p_rend->p_frame[i])) continue;
+
+        if (p_rend->p_frame[i]->data[0]) {
+            internal_free(&(p_rend->alloc),
+                p_rend->p_frame[i]->data[0], p_rend->frame_size);
+        }
+        av_frame_free(&(p_rend->p_frame[i]));
+    }
+
+    (void)sirius_que_reset(p_rend->h_que_free);
+    (void)sirius_que_reset(p_rend->h_que_res);
+}
+
+hide_symbol int
+internal_rend_data_alloc(internal_rend_t *p_rend,
+    const pollux_allocator_t *p_alloc)
+{
+    internal_rend_data_free(p_rend);
+    p_rend->alloc = *p_alloc;
+
+    AVFrame *p_f;
+    size_t size;
+    internal_rend_param_t *p_pm = &(p_rend->param);
+    for (unsigned int i = 0; i < INTERNAL_REND_FRAME_NR; i++) {
+        if (!(p_f = p_rend->p_frame[i] = av_frame_alloc())) {
+            SIRIUS_ERROR("av_frame_alloc\n");
+            goto label_data_free;
+        }
+        p_f->opaque = (void *)(intptr_t)i;
+        size = internal_alloc_image(&(p_rend->alloc),
+            p_f->data, p_f->linesize, p_pm->width, p_pm->height,
+            p_pm->fmt, (int)(p_pm->alignment));
+        if (!(size)) goto label_data_free;
+        p_rend->frame_size = size;
+
+        if (sirius_que_put(
+            p_rend->h_que_free, (size_t)p_f, SIRIUS_QUE_TIMEOUT_NONE)) {
+            SIRIUS_ERROR("sirius_que_put\n");
+            goto label_data_free;
+        }
+    }
+
+    p_pm->stride = internal_fmt_stride(p_pm->fmt,
+        p_pm->width, p_rend->p_frame[0]->linesize[0]);
+
+    return POLLUX_OK;
+
+label_data_free:
+    internal_rend_data_free(p_rend);
+    return POLLUX_ERR;
+}
+
+hide_symbol void
+internal_rend_sws_free(internal_rend_t *p_rend)
+{
+    sws_freeContext(p_rend->sws_ctx);
+    p_rend->sws_ctx = NULL;
+}
+
+hide_symbol int
+internal_rend_sws_create(internal_rend_t *p_rend,
+    const AVCodecContext *codec_ctx)
+{
+    internal_rend_param_t *p_pm = &(p_rend->param);
+    return internal_ffmpeg_sws_create(&(p_rend->sws_ctx),
+        codec_ctx, p_pm->width, p_pm->height, p_pm->fmt);
+}
+
+hide_symbol void
+internal_rend_push(internal_rend_t *p_rend, const AVFrame *p_src,
+    const internal_frame_meta_t *p_meta)
+{
+    AVFrame *avf = NULL;
+    if ((sirius_que_get(p_rend->h_que_free,
+        (size_t *)&avf, SIRIUS_QUE_TIMEOUT_NONE) || !(avf)) &&
+        /* every cache is waiting for the consumer, recycle the oldest */
+        (sirius_que_get(p_rend->h_que_res,
+        (size_t *)&avf, SIRIUS_QUE_TIMEOUT_NONE) || !(avf)))
+        return;
+
+    internal_rend_param_t *p_pm = &(p_rend->param);
+    avf->height = internal_ffmpeg_convert(&(p_rend->sws_ctx),
+        p_src, avf, p_pm->width, p_pm->height, p_pm->fmt);
+    if (avf->height <= 0) {
+        internal_rend_recycle(p_rend, avf);
+        return;
+    }
+    avf->width = p_pm->width;
+    avf->format = p_pm->fmt;
+    p_rend->meta[(intptr_t)(avf->opaque)] = *p_meta;
+    sirius_que_put(p_rend->h_que_res, (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE);
+}
+
+hide_symbol AVFrame *
+internal_rend_take(internal_rend_t *p_rend, unsigned int timeout_ms)
+{
+    AVFrame *avf = NULL;
+    if (sirius_que_get(p_rend->h_que_res, (size_t *)&avf, timeout_ms))
+        return NULL;
+    return avf;
+}
+
+hide_symbol void
+internal_rend_recycle(internal_rend_t *p_rend, AVFrame *p_frame)
+{
+    if (sirius_que_put(p_rend->h_que_free,
+        (size_t)p_frame, SIRIUS_QUE_TIMEOUT_NONE)) {
+        SIRIUS_WARN("sirius_que_put\n");
+    }
+}
+
+hide_symbol void
+internal_rend_kick(internal_rend_t *p_rend)
+{
+    if (p_rend->h_que_res) {
+        (void)sirius_que_put(p_rend->h_que_res, 0, SIRIUS_QUE_TIMEOUT_NONE);
+    }
+}
+
+hide_symbol void
+internal_rend_flush(internal_rend_t *p_rend)
+{
+    AVFrame *avf;
+    while (!(sirius_que_get(p_rend->h_que_res,
+        (size_t *)&avf, SIRIUS_QUE_TIMEOUT_NONE))) {
+        if (avf) internal_rend_recycle(p_rend, avf);
+    }
+}
@@ -0,0 +1,265 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_sched.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+/* priority of `POLLUX_PRIORITY_REALTIME` on `SCHED_RR` */
+#define I_RT_PRIORITY (10)
+
+#define I_NODE_PATH "/sys/devices/system/node/"
+#define I_NODE_WORD_BITS (8 * sizeof(unsigned long))
+
+/* the next node of `POLLUX_NUMA_AUTO` */
+static atomic_uint i_node_turn;
+
+/**
+ * the weights of the nice values -20 ... 19 in the CFS scheduler,
+ * refer to `sched_prio_to_weight` of the kernel
+ */
+static const unsigned int i_nice_weight[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+    9548, 7620, 6100, 4904, 3906,
+    3121, 2501, 1991, 1586, 1277,
+    1024, 820, 655, 526, 423,
+    335, 272, 215, 172, 137,
+    110, 87, 70, 56, 45,
+    36, 29, 23, 18, 15,
+};
+
+/**
+ * @brief the nice value whose weight is the nearest to `share`
+ */
+static int
+i_share_nice(unsigned int share)
+{
+    unsigned int i = 0;
+    while (i < 39 && i_nice_weight[i + 1] >= share) i++;
+    /* between the weights `i` and `i + 1`, the nearer one by ratio */
+    if (i < 39 && (unsigned long long)share * share <
+        (unsigned long long)i_nice_weight[i] * i_nice_weight[i + 1]) i++;
+
+    return (int)i - 20;
+}
+
+/**
+ * @brief parse a list like "0-3,8-11\n" of `path` into the bits
+ *  of `p_mask`, `bit_nr` bits at most
+ * 
+ * @return the number of bits set, -1 if the file can not be read
+ *  or is not a list
+ */
+static int
+i_list_parse(const char *path, unsigned long long *p_mask,
+    unsigned int bit_nr)
+{
+    FILE *fp = fopen(path, "re");
+    if (!(fp)) return -1;
+
+    char buf[4096];
+    size_t len = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    buf[len] = '\0';
+
+    int nr = 0;
+    char *p = buf, *p_end;
+    memset(p_mask, 0, (bit_nr / 64) * sizeof(unsigned long long));
+    while (*p && *p != '\n') {
+        unsigned long first = strtoul(p, &p_end, 10), last = first;
+        if (p_end == p) return -1;
+        if (*p_end == '-') {
+            p = p_end + 1;
+            last = strtoul(p, &p_end, 10);
+            if (p_end == p || last < first) return -1;
+        }
+        for (unsigned long i = first; i <= last && i < bit_nr; i++) {
+            p_mask[i / 64] |= 1ULL << (i % 64);
+            nr++;
+        }
+        p = (*p_end == ',') ? p_end + 1 : p_end;
+    }
+
+    return nr;
+}
+
+/**
+ * @brief pick the node of `numa`, refer to `pollux_decode_sched_t`,
+ *  and the CPUs of it unless the CPUs are set already
+ */
+static int
+i_node_set(internal_sched_param_t *p_param, int numa)
+{
+    if (numa < POLLUX_NUMA_AUTO ||
+        numa > POLLUX_NUMA_NODE(INTERNAL_SCHED_NODE_NR - 1)) {
+        SIRIUS_ERROR("numa: %d\n", numa);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+
+    unsigned long long online;
+    int nr = i_list_parse(I_NODE_PATH "online",
+        &online, INTERNAL_SCHED_NODE_NR);
+    int node = -1;
+    if (numa == POLLUX_NUMA_AUTO) {
+        /* nothing to spread over */
+        if (nr <= 1) return POLLUX_OK;
+
+        /* a handle stays where it is, its threads and memory with it */
+        node = p_param->auto_node;
+        if (node < 0 || !(online & (1ULL << node))) {
+            unsigned int turn =
+                atomic_fetch_add(&i_node_turn, 1) % (unsigned int)nr;
+            for (node = 0; node < INTERNAL_SCHED_NODE_NR; node++) {
+                if ((online & (1ULL << node)) && !(turn--)) break;
+            }
+            p_param->auto_node = node;
+        }
+    } else {
+        node = numa - POLLUX_NUMA_NODE(0);
+        if (nr <= 0 || !(online & (1ULL << node))) {
+            SIRIUS_ERROR("numa node %d is not online\n", node);
+            return POLLUX_ERR_INVALID_PARAMETER;
+        }
+    }
+    p_param->node = node;
+
+    if (!(p_param->has_cpus)) {
+        /* a node of memory only has no CPUs, the thread is left alone */
+        char path[64];
+        snprintf(path, sizeof(path), I_NODE_PATH "node%d/cpulist", node);
+        p_param->has_cpus = i_list_parse(path,
+            p_param->cpu_mask, INTERNAL_SCHED_CPU_NR) > 0;
+    }
+    SIRIUS_DEBG("numa node: %d\n", node);
+
+    return POLLUX_OK;
+}
+
+hide_symbol int
+internal_sched_param_set(internal_sched_param_t *p_param,
+    const pollux_decode_sched_t *p_sched)
+{
+    if (p_sched->priority < 0 || p_sched->priority >= POLLUX_PRIORITY_MAX) {
+        SIRIUS_ERROR("priority: %d\n", p_sched->priority);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+    p_param->priority = p_sched->priority;
+
+    switch (p_param->priority) {
+        case POLLUX_PRIORITY_BACKGROUND: p_param->nice = 10; break;
+        case POLLUX_PRIORITY_HIGH: p_param->nice = -5; break;
+        /* the fallback when `SCHED_RR` is not allowed */
+        case POLLUX_PRIORITY_REALTIME: p_param->nice = -5; break;
+        default: p_param->nice = 0; break;
+    }
+    if (p_sched->cpu_share) p_param->nice = i_share_nice(p_sched->cpu_share);
+
+    p_param->has_cpus = false;
+    memset(p_param->cpu_mask, 0, sizeof(p_param->cpu_mask));
+    if (p_sched->cpu_nr && !(p_sched->p_cpu)) {
+        SIRIUS_ERROR("cpu_nr: %u, no cpus\n", p_sched->cpu_nr);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+    for (unsigned int i = 0; i < p_sched->cpu_nr; i++) {
+        if (p_sched->p_cpu[i] >= INTERNAL_SCHED_CPU_NR) {
+            SIRIUS_ERROR("cpu: %u\n", p_sched->p_cpu[i]);
+            return POLLUX_ERR_INVALID_PARAMETER;
+        }
+        p_param->cpu_mask[p_sched->p_cpu[i] / 64] |=
+            1ULL << (p_sched->p_cpu[i] % 64);
+        p_param->has_cpus = true;
+    }
+
+    p_param->node = -1;
+    if (p_sched->numa != POLLUX_NUMA_NONE)
+        return i_node_set(p_param, p_sched->numa);
+
+    return POLLUX_OK;
+}
+
+hide_symbol void
+internal_sched_apply(const internal_sched_param_t *p_param)
+{
+    pthread_t self = pthread_self();
+    int ret;
+    if (p_param->has_cpus) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (unsigned int i = 0;
+            i < INTERNAL_SCHED_CPU_NR && i < CPU_SETSIZE; i++) {
+            if (p_param->cpu_mask[i / 64] & (1ULL << (i % 64)))
+                CPU_SET(i, &cpus);
+        }
+        if ((ret = pthread_setaffinity_np(self, sizeof(cpus), &cpus)))
+            SIRIUS_WARN("pthread_setaffinity_np: %s\n", strerror(ret));
+    }
+
+    if (p_param->node >= 0) {
+        /* preferred, not bound: a full node falls back to the others */
+        unsigned long mask[INTERNAL_SCHED_NODE_NR / I_NODE_WORD_BITS] = {0};
+        mask[p_param->node / I_NODE_WORD_BITS] =
+            1UL << (p_param->node % I_NODE_WORD_BITS);
+        if (syscall(SYS_set_mempolicy, MPOL_PREFERRED,
+            mask, INTERNAL_SCHED_NODE_NR + 1))
+            SIRIUS_WARN("set_mempolicy: %s\n", strerror(errno));
+    }
+
+    struct sched_param sp = {0};
+    switch (p_param->priority) {
+        case POLLUX_PRIORITY_REALTIME:
+            sp.sched_priority = I_RT_PRIORITY;
+            ret = pthread_setschedparam(self, SCHED_RR, &sp);
+            if (!(ret)) return;
+            SIRIUS_WARN("SCHED_RR: %s, high priority instead\n",
+                strerror(ret));
+            break;
+        case POLLUX_PRIORITY_BACKGROUND:
+            ret = pthread_setschedparam(self, SCHED_BATCH, &sp);
+            if (ret) SIRIUS_WARN("SCHED_BATCH: %s\n", strerror(ret));
+            break;
+        default: break;
+    }
+
+    /* on linux the nice value belongs to the thread, not the process */
+    if (p_param->nice &&
+        setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), p_param->nice)) {
+        SIRIUS_WARN("setpriority %d: %s\n", p_param->nice, strerror(errno));
+    }
+}
+
+hide_symbol int
+internal_sched_mem_bind(int node, void *ptr, size_t size)
+{
+    if (node < 0 || !(ptr)) return 0;
+
+    /* only whole pages, the pages around belong to other memory */
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t)ptr + page - 1) & ~(page - 1);
+    uintptr_t end = ((uintptr_t)ptr + size) & ~(page - 1);
+    if (end <= start) return 0;
+
+    unsigned long mask[INTERNAL_SCHED_NODE_NR / I_NODE_WORD_BITS] = {0};
+    mask[node / I_NODE_WORD_BITS] = 1UL << (node % I_NODE_WORD_BITS);
+    /* the pages touched already are migrated, the others fault in there */
+    if (syscall(SYS_mbind, (void *)start, (unsigned long)(end - start),
+        MPOL_PREFERRED, mask, INTERNAL_SCHED_NODE_NR + 1, MPOL_MF_MOVE))
+        return errno;
+
+    return 0;
+}
@@ -0,0 +1,379 @@
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_seg.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int
+i_seg_interrupt(void *args)
+{
+    internal_seg_t *p_seg = (internal_seg_t *)args;
+    return atomic_load_explicit(&(p_seg->stop), memory_order_relaxed);
+}
+
+static inline bool
+i_seg_stopped(internal_seg_t *p_seg)
+{
+    return atomic_load_explicit(&(p_seg->stop), memory_order_relaxed);
+}
+
+/**
+ * @brief an idle decoded frame of the thread
+ * 
+ * @return the frame, `NULL` once stopped
+ */
+static AVFrame *
+i_frame_idle_get(internal_seg_thd_t *p_t)
+{
+    AVFrame *avf;
+    while (!(i_seg_stopped(p_t->p_seg))) {
+        if (!(sirius_que_get(p_t->h_que_free, (size_t *)&avf, 1000)) && avf)
+            return avf;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief decode segment `n` into the output queue of the thread
+ * 
+ * @return 0 at the end of the segment or once stopped, error code if
+ *  the input could not be sought to or read, the frames decoded until
+ *  then are delivered
+ */
+static int
+i_seg_decode(internal_seg_thd_t *p_t, unsigned int n)
+{
+    internal_seg_t *p_seg = p_t->p_seg;
+    internal_ffmpeg_info_t *p_ffmpeg = &(p_t->ffmpeg);
+    AVFormatContext *fmt_ctx = p_ffmpeg->fmt_ctx;
+    AVCodecContext *codec_ctx = p_ffmpeg->codec_ctx;
+    AVPacket *pkt = p_ffmpeg->pkt;
+    AVFrame *frame = p_ffmpeg->frame;
+    int64_t start = p_seg->p_start[n];
+    int64_t end = (n + 1 < p_seg->seg_nr) ? p_seg->p_start[n + 1] : INT64_MAX;
+
+    /* the input of the first segment is at the start of the file */
+    if (n) {
+        int64_t ts = start - p_seg->margin;
+        if (avformat_seek_file(fmt_ctx,
+            p_ffmpeg->stream_index, INT64_MIN, ts, ts, 0) < 0) {
+            SIRIUS_ERROR("avformat_seek_file, segment: %u\n", n);
+            return POLLUX_ERR;
+        }
+        avcodec_flush_buffers(codec_ctx);
+    }
+
+    AVFrame *avf;
+    bool is_eof = false;
+    /* the timestamp of the last frame that had one */
+    int64_t t_ns, ts, last_ts = AV_NOPTS_VALUE;
+    int ret, err = POLLUX_OK;
+    while (!(i_seg_stopped(p_seg))) {
+        t_ns = internal_stats_now_ns();
+        ret = av_read_frame(fmt_ctx, pkt);
+        t_ns = internal_stats_stage(p_seg->p_stats, POLLUX_STAGE_READ, t_ns);
+        if (ret < 0 && ret != AVERROR(EAGAIN)) {
+            /**
+             * the end of the file, or an input that failed, the
+             * decoder is drained all the same; a stop interrupts
+             * the input, that is not a failure
+             */
+            if (ret != AVERROR_EOF && !(i_seg_stopped(p_seg))) {
+                SIRIUS_ERROR("av_read_frame: %d, segment: %u\n", ret, n);
+                err = POLLUX_ERR;
+            }
+            is_eof = true;
+        } else if (ret < 0 || pkt->stream_index != p_ffmpeg->stream_index) {
+            av_packet_unref(pkt);
+            continue;
+        } else {
+            atomic_fetch_add_explicit(
+                &(p_seg->p_stats->packet_nr), 1, memory_order_relaxed);
+        }
+
+        /* at the end of the file, the decoder is drained */
+        ret = avcodec_send_packet(codec_ctx, is_eof ? NULL : pkt);
+        t_ns = internal_stats_stage(p_seg->p_stats, POLLUX_STAGE_SEND, t_ns);
+        av_packet_unref(pkt);
+        if (ret < 0 && !(is_eof)) continue;
+
+        for (;;) {
+            ret = avcodec_receive_frame(codec_ctx, frame);
+            t_ns = internal_stats_stage(
+                p_seg->p_stats, POLLUX_STAGE_RECEIVE, t_ns);
+            if (ret) break;
+            atomic_fetch_add_explicit(
+                &(p_seg->p_stats->decode_nr), 1, memory_order_relaxed);
+
+            /**
+             * the frames come out in presentation order, the ones
+             * before the start belong to the previous segment, and
+             * from the first one after the end on to the next one;
+             * a frame without a timestamp goes with the one before
+             * it, so that exactly one of the overlapping segments
+             * has it, the previous one if there is none since the seek
+             */
+            ts = frame->best_effort_timestamp;
+            if (ts == AV_NOPTS_VALUE) {
+                ts = last_ts;
+            } else {
+                last_ts = ts;
+            }
+            if (ts != AV_NOPTS_VALUE && ts >= end) {
+                av_frame_unref(frame);
+                return POLLUX_OK;
+            }
+            if (n && (ts == AV_NOPTS_VALUE || ts < start)) {
+                av_frame_unref(frame);
+                continue;
+            }
+
+            if (!(avf = i_frame_idle_get(p_t))) {
+                av_frame_unref(frame);
+                return POLLUX_OK;
+            }
+            av_frame_move_ref(avf, frame);
+            (void)sirius_que_put(p_t->h_que_out,
+                (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE);
+        }
+
+        if (is_eof) return err;
+    }
+
+    return POLLUX_OK;
+}
+
+static void *
+i_seg_thd(void *args)
+{
+    internal_seg_thd_t *p_t = (internal_seg_thd_t *)args;
+    internal_seg_t *p_seg = p_t->p_seg;
+    internal_sched_apply(&(p_seg->p_m->sched));
+
+    AVFrame *avf;
+    int ret;
+    for (unsigned int n = p_t->index; n < p_seg->seg_nr; n += p_seg->thd_nr) {
+        p_seg->p_ret[n] = ret = i_seg_decode(p_t, n);
+
+        /* a frame without data closes the segment */
+        if (!(avf = i_frame_idle_get(p_t))) break;
+        (void)sirius_que_put(p_t->h_que_out,
+            (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE);
+        /* the delivery ends at this segment */
+        if (ret) break;
+    }
+
+    return NULL;
+}
+
+static void
+i_thd_free(internal_seg_thd_t *p_t)
+{
+    internal_ffmpeg_resource_free(&(p_t->ffmpeg));
+    if (p_t->ffmpeg.fmt_ctx) internal_ffmpeg_deinit(&(p_t->ffmpeg));
+    memset(&(p_t->ffmpeg), 0, sizeof(internal_ffmpeg_info_t));
+
+    for (unsigned int i = 0; i < INTERNAL_SEG_FRAME_NR; i++) {
+        av_frame_free(&(p_t->p_frame[i]));
+    }
+    if (p_t->h_que_free) (void)sirius_que_del(p_t->h_que_free);
+    if (p_t->h_que_out) (void)sirius_que_del(p_t->h_que_out);
+    p_t->h_que_free = NULL;
+    p_t->h_que_out = NULL;
+}
+
+static int
+i_thd_alloc(internal_seg_thd_t *p_t)
+{
+    const internal_ffmpeg_param_t *p_m = p_t->p_seg->p_m;
+    sirius_que_cr_t cr = {0};
+    /* one more for the `NULL` of `internal_seg_stop` */
+    cr.elem_nr = INTERNAL_SEG_FRAME_NR + 1;
+    cr.que_type = SIRIUS_QUE_TYPE_MTX;
+    if (sirius_que_cr(&cr, &(p_t->h_que_free)) ||
+        sirius_que_cr(&cr, &(p_t->h_que_out))) {
+        SIRIUS_ERROR("sirius_que_cr\n");
+        return POLLUX_ERR_RESOURCE_REQUEST;
+    }
+    for (unsigned int i = 0; i < INTERNAL_SEG_FRAME_NR; i++) {
+        if (!(p_t->p_frame[i] = av_frame_alloc())) {
+            SIRIUS_ERROR("av_frame_alloc\n");
+            return POLLUX_ERR_MEMORY_ALLOC;
+        }
+        (void)sirius_que_put(p_t->h_que_free,
+            (size_t)(p_t->p_frame[i]), SIRIUS_QUE_TIMEOUT_NONE);
+    }
+
+    /* the probe cache makes the inputs after the first one cheap */
+    internal_ffmpeg_info_t *p_ffmpeg = &(p_t->ffmpeg);
+    if (internal_ffmpeg_init(p_m, AVMEDIA_TYPE_VIDEO, p_ffmpeg))
+        return POLLUX_ERR;
+    p_ffmpeg->fmt_ctx->interrupt_callback.callback = i_seg_interrupt;
+    p_ffmpeg->fmt_ctx->interrupt_callback.opaque = (void *)(p_t->p_seg);
+    if (!(p_ffmpeg->pkt = av_packet_alloc()) ||
+        !(p_ffmpeg->frame = av_frame_alloc())) {
+        SIRIUS_ERROR("av_packet_alloc / av_frame_alloc\n");
+        return POLLUX_ERR_MEMORY_ALLOC;
+    }
+
+    return POLLUX_OK;
+}
+
+/**
+ * @brief the start of each segment, of equal duration
+ */
+static int
+i_seg_cut(internal_seg_t *p_seg, const internal_ffmpeg_info_t *p_main,
+    unsigned int seg_nr)
+{
+    const AVFormatContext *fmt_ctx = p_main->fmt_ctx;
+    const AVStream *st = fmt_ctx->streams[p_main->stream_index];
+    if (!(fmt_ctx->pb) || !(fmt_ctx->pb->seekable)) {
+        SIRIUS_WARN("the input cannot seek\n");
+        return POLLUX_ERR_UNSUPPORTED;
+    }
+
+    int64_t begin = (st->start_time == AV_NOPTS_VALUE) ? 0 : st->start_time;
+    int64_t dur = st->duration;
+    if ((dur == AV_NOPTS_VALUE || dur <= 0) && fmt_ctx->duration > 0)
+        dur = av_rescale_q(fmt_ctx->duration, AV_TIME_BASE_Q, st->time_base);
+    if (dur == AV_NOPTS_VALUE || dur <= 0) {
+        SIRIUS_WARN("the duration is unknown\n");
+        return POLLUX_ERR_UNSUPPORTED;
+    }
+
+    /* the reorder delay of the decoder, plus one frame */
+    AVRational frame_dur = (st->avg_frame_rate.num > 0) ?
+        av_inv_q(st->avg_frame_rate) : (AVRational){1, 1};
+    p_seg->margin = av_rescale_q(st->codecpar->video_delay + 1,
+        frame_dur, st->time_base);
+
+    if (!(p_seg->p_start = (int64_t *)malloc(seg_nr * sizeof(int64_t))) ||
+        !(p_seg->p_ret = (int *)calloc(seg_nr, sizeof(int)))) {
+        SIRIUS_ERROR("malloc\n");
+        return POLLUX_ERR_MEMORY_ALLOC;
+    }
+    p_seg->seg_nr = seg_nr;
+    for (unsigned int i = 0; i < seg_nr; i++) {
+        p_seg->p_start[i] = begin + av_rescale(dur, i, seg_nr);
+    }
+
+    return POLLUX_OK;
+}
+
+hide_symbol int
+internal_seg_open(internal_seg_t *p_seg,
+    const internal_ffmpeg_param_t *p_m, const internal_ffmpeg_info_t *p_main,
+    unsigned int thd_nr, internal_stats_t *p_stats)
+{
+    memset(p_seg, 0, sizeof(internal_seg_t));
+    if (thd_nr == 0 || thd_nr > INTERNAL_SEG_THD_MAX)
+        return POLLUX_ERR_INVALID_PARAMETER;
+    p_seg->p_m = p_m;
+    p_seg->p_stats = p_stats;
+    atomic_store(&(p_seg->stop), false);
+
+    int ret = i_seg_cut(p_seg, p_main, thd_nr * INTERNAL_SEG_PER_THD);
+    if (ret) goto label_seg_close;
+
+    internal_seg_thd_t *p_t;
+    for (unsigned int i = 0; i < thd_nr; i++) {
+        p_t = &(p_seg->thd[i]);
+        p_t->p_seg = p_seg;
+        p_t->index = i;
+        p_seg->thd_nr = i + 1;
+        if ((ret = i_thd_alloc(p_t))) goto label_seg_close;
+    }
+
+    for (unsigned int i = 0; i < thd_nr; i++) {
+        p_t = &(p_seg->thd[i]);
+        ret = pthread_create(&(p_t->thd), NULL, i_seg_thd, (void *)p_t);
+        if (ret) {
+            SIRIUS_ERROR("pthread_create: %d\n", ret);
+            ret = POLLUX_ERR_RESOURCE_REQUEST;
+            goto label_seg_close;
+        }
+        p_t->thd_valid = true;
+    }
+    SIRIUS_INFO("%u segments on %u threads\n", p_seg->seg_nr, thd_nr);
+
+    return POLLUX_OK;
+
+label_seg_close:
+    internal_seg_close(p_seg);
+    return ret;
+}
+
+hide_symbol void
+internal_seg_stop(internal_seg_t *p_seg)
+{
+    atomic_store_explicit(&(p_seg->stop), true, memory_order_relaxed);
+
+    /* the waits of the threads and of the reader end at once */
+    internal_seg_thd_t *p_t;
+    for (unsigned int i = 0; i < p_seg->thd_nr; i++) {
+        p_t = &(p_seg->thd[i]);
+        if (p_t->h_que_free) (void)sirius_que_put(
+            p_t->h_que_free, 0, SIRIUS_QUE_TIMEOUT_NONE);
+        if (p_t->h_que_out) (void)sirius_que_put(
+            p_t->h_que_out, 0, SIRIUS_QUE_TIMEOUT_NONE);
+    }
+}
+
+hide_symbol void
+internal_seg_close(internal_seg_t *p_seg)
+{
+    internal_seg_stop(p_seg);
+
+    internal_seg_thd_t *p_t;
+    for (unsigned int i = 0; i < p_seg->thd_nr; i++) {
+        p_t = &(p_seg->thd[i]);
+        if (p_t->thd_valid) {
+            pthread_join(p_t->thd, NULL);
+            p_t->thd_valid = false;
+        }
+    }
+
+    /* every frame is back with its thread, the queues only hold them */
+    for (unsigned int i = 0; i < p_seg->thd_nr; i++) {
+        i_thd_free(&(p_seg->thd[i]));
+    }
+    p_seg->thd_nr = 0;
+
+    free(p_seg->p_start);
+    free(p_seg->p_ret);
+    p_seg->p_start = NULL;
+    p_seg->p_ret = NULL;
+    p_seg->seg_nr = 0;
+}
+
+hide_symbol AVFrame *
+internal_seg_take(internal_seg_t *p_seg, unsigned int seg)
+{
+    internal_seg_thd_t *p_t = &(p_seg->thd[seg % p_seg->thd_nr]);
+
+    AVFrame *avf;
+    while (!(i_seg_stopped(p_seg))) {
+        if (sirius_que_get(p_t->h_que_out, (size_t *)&avf, 1000) || !(avf))
+            continue;
+        if (avf->buf[0]) return avf;
+
+        /* the end of the segment */
+        (void)sirius_que_put(p_t->h_que_free,
+            (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE);
+        return NULL;
+    }
+
+    return NULL;
+}
+
+hide_symbol void
+internal_seg_recycle(internal_seg_t *p_seg, unsigned int seg, AVFrame *avf)
+{
+    av_frame_unref(avf);
+    (void)sirius_que_put(p_seg->thd[seg % p_seg->thd_nr].h_que_free,
+        (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE);
+}
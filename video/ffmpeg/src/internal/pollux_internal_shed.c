@@ -0,0 +1,57 @@
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_shed.h"
+
+hide_symbol void
+internal_shed_reset(internal_shed_t *p_shed,
+    const internal_shed_param_t *p_param)
+{
+    p_shed->param = *p_param;
+    atomic_store_explicit(
+        &(p_shed->level), POLLUX_SHED_NONE, memory_order_relaxed);
+    atomic_store_explicit(&(p_shed->late_avg_us), 0, memory_order_relaxed);
+    p_shed->hold_nr = INTERNAL_SHED_HOLD_NR;
+}
+
+/**
+ * @brief the decoder settings of a level
+ */
+static void
+i_level_apply(AVCodecContext *codec_ctx, pollux_shed_level_t level)
+{
+    codec_ctx->skip_loop_filter = (level >= POLLUX_SHED_LOOP_FILTER) ?
+        AVDISCARD_ALL : AVDISCARD_DEFAULT;
+    codec_ctx->skip_frame = (level >= POLLUX_SHED_NONREF) ?
+        AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+}
+
+hide_symbol void
+internal_shed_update(internal_shed_t *p_shed,
+    AVCodecContext *codec_ctx, int64_t late_us)
+{
+    int64_t avg = atomic_load_explicit(
+        &(p_shed->late_avg_us), memory_order_relaxed);
+    avg += (late_us - avg) / 8;
+    atomic_store_explicit(&(p_shed->late_avg_us), avg, memory_order_relaxed);
+
+    if (!(p_shed->param.is_enable)) return;
+    if (p_shed->hold_nr) {
+        p_shed->hold_nr--;
+        return;
+    }
+
+    /* the gap between the thresholds keeps the level from flapping */
+    int level = internal_shed_level(p_shed);
+    if (avg > p_shed->param.late_us && level < POLLUX_SHED_MAX - 1) {
+        level++;
+    } else if (avg < p_shed->param.late_us / 4 && level > POLLUX_SHED_NONE) {
+        level--;
+    } else {
+        return;
+    }
+
+    i_level_apply(codec_ctx, (pollux_shed_level_t)level);
+    atomic_store_explicit(&(p_shed->level), level, memory_order_relaxed);
+    p_shed->hold_nr = INTERNAL_SHED_HOLD_NR;
+    SIRIUS_INFO("shed level: %d, late: %lld us\n", level, (long long)avg);
+}
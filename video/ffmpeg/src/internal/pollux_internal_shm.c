@@ -0,0 +1,200 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_shm.h"
+#include "./internal/pollux_internal_ffmpeg.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+_Static_assert(offsetof(pollux_shm_header_t, head) == 128 &&
+    sizeof(pollux_shm_header_t) == 192, "layout of pollux_shm_header_t");
+_Static_assert(sizeof(pollux_shm_slot_t) == 64,
+    "layout of pollux_shm_slot_t");
+
+static inline size_t
+i_page_align(size_t size, size_t page)
+{
+    return (size + page - 1) / page * page;
+}
+
+/**
+ * @brief wake up every reader waiting on `head`, in any process
+ */
+static void
+i_head_wake(pollux_shm_header_t *p_hdr)
+{
+    if (syscall(SYS_futex, &(p_hdr->head), FUTEX_WAKE,
+        INT_MAX, NULL, NULL, 0) < 0) {
+        SIRIUS_WARN("futex wake: %d\n", errno);
+    }
+}
+
+hide_symbol int
+internal_shm_open(internal_shm_t *p_shm,
+    const internal_shm_param_t *p_param,
+    enum AVPixelFormat fmt, pollux_fmt_t pollux_fmt,
+    unsigned short width, unsigned short height, int alignment)
+{
+    int frame_size = av_image_get_buffer_size(fmt, width, height, alignment);
+    if (frame_size <= 0) {
+        SIRIUS_ERROR("av_image_get_buffer_size: [%d]\n", frame_size);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+
+    /* the header and the slot array share the first pages */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t slot_offset = sizeof(pollux_shm_header_t);
+    size_t data_offset = i_page_align(slot_offset +
+        p_param->slot_nr * sizeof(pollux_shm_slot_t), page);
+    size_t slot_size = i_page_align((size_t)frame_size, page);
+    size_t size = data_offset + p_param->slot_nr * slot_size;
+
+    p_shm->fd = memfd_create(p_param->name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (p_shm->fd < 0) {
+        SIRIUS_ERROR("memfd_create: %d\n", errno);
+        return POLLUX_ERR_RESOURCE_REQUEST;
+    }
+    if (ftruncate(p_shm->fd, (off_t)size)) {
+        SIRIUS_ERROR("ftruncate: %d\n", errno);
+        goto label_fd_close;
+    }
+    /* the readers may rely on the size they mapped */
+    if (fcntl(p_shm->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW)) {
+        SIRIUS_WARN("F_ADD_SEALS: %d\n", errno);
+    }
+
+    void *p = mmap(NULL, size,
+        PROT_READ | PROT_WRITE, MAP_SHARED, p_shm->fd, 0);
+    if (p == MAP_FAILED) {
+        SIRIUS_ERROR("mmap: %d\n", errno);
+        goto label_fd_close;
+    }
+    p_shm->p_hdr = (pollux_shm_header_t *)p;
+    p_shm->p_slot = (pollux_shm_slot_t *)((unsigned char *)p + slot_offset);
+    p_shm->p_data = (unsigned char *)p + data_offset;
+
+    /* the memfd starts out zeroed, `head` and every `seq` are 0 */
+    pollux_shm_header_t *p_hdr = p_shm->p_hdr;
+    p_hdr->slot_nr = p_param->slot_nr;
+    p_hdr->width = width;
+    p_hdr->height = height;
+    p_hdr->fmt = pollux_fmt;
+    p_hdr->frame_size = (uint64_t)frame_size;
+    p_hdr->slot_offset = slot_offset;
+    p_hdr->data_offset = data_offset;
+    p_hdr->slot_size = slot_size;
+    p_hdr->region_size = size;
+    p_hdr->writer_pid = (int32_t)getpid();
+
+    uint8_t *data[4];
+    int linesize[4];
+    if (0 > av_image_fill_arrays(data, linesize,
+        p_shm->p_data, fmt, width, height, alignment)) {
+        SIRIUS_ERROR("av_image_fill_arrays\n");
+        goto label_shm_unmap;
+    }
+    for (unsigned int i = 0; i < 4; i++) {
+        p_hdr->linesize[i] = (data[i]) ? linesize[i] : 0;
+        p_hdr->plane_offset[i] =
+            (data[i]) ? (uint32_t)(data[i] - p_shm->p_data) : 0;
+    }
+    p_hdr->version = POLLUX_SHM_VERSION;
+    /* the readers check the magic first, it is written last */
+    __atomic_store_n(&(p_hdr->magic), POLLUX_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    SIRIUS_INFO("frame ring [%d]: %u slots of %zu bytes\n",
+        p_shm->fd, p_param->slot_nr, slot_size);
+    return POLLUX_OK;
+
+label_shm_unmap:
+    munmap(p, size);
+    p_shm->p_hdr = NULL;
+
+label_fd_close:
+    close(p_shm->fd);
+    p_shm->fd = -1;
+    return POLLUX_ERR_RESOURCE_REQUEST;
+}
+
+hide_symbol void
+internal_shm_close(internal_shm_t *p_shm)
+{
+    if (!(p_shm->p_hdr)) return;
+
+    internal_shm_end(p_shm);
+    munmap(p_shm->p_hdr, p_shm->p_hdr->region_size);
+    p_shm->p_hdr = NULL;
+    p_shm->p_slot = NULL;
+    p_shm->p_data = NULL;
+    close(p_shm->fd);
+    p_shm->fd = -1;
+}
+
+hide_symbol unsigned int
+internal_shm_begin(internal_shm_t *p_shm)
+{
+    pollux_shm_header_t *p_hdr = p_shm->p_hdr;
+    uint32_t head = __atomic_load_n(&(p_hdr->head), __ATOMIC_RELAXED);
+    unsigned int index = head % p_hdr->slot_nr;
+    pollux_shm_slot_t *p_s = &(p_shm->p_slot[index]);
+
+    /* odd, the readers of the previous frame of the slot see the change */
+    __atomic_store_n(&(p_s->seq), p_s->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    return index;
+}
+
+hide_symbol void
+internal_shm_publish(internal_shm_t *p_shm,
+    const internal_frame_meta_t *p_meta)
+{
+    pollux_shm_header_t *p_hdr = p_shm->p_hdr;
+    uint32_t head = __atomic_load_n(&(p_hdr->head), __ATOMIC_RELAXED);
+    pollux_shm_slot_t *p_s = &(p_shm->p_slot[head % p_hdr->slot_nr]);
+
+    p_s->frame_nr = head;
+    p_s->pts_us = p_meta->pts_us;
+    p_s->frame_idx = (uint64_t)(p_meta->frame_idx);
+    p_s->repeat_nr = (uint32_t)(p_meta->repeat_nr);
+    __atomic_store_n(&(p_s->seq), p_s->seq + 1, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&(p_hdr->head), head + 1, __ATOMIC_RELEASE);
+    i_head_wake(p_hdr);
+}
+
+hide_symbol void
+internal_shm_abort(internal_shm_t *p_shm)
+{
+    pollux_shm_header_t *p_hdr = p_shm->p_hdr;
+    uint32_t head = __atomic_load_n(&(p_hdr->head), __ATOMIC_RELAXED);
+    pollux_shm_slot_t *p_s = &(p_shm->p_slot[head % p_hdr->slot_nr]);
+
+    /**
+     * even again, the change is seen by the readers of the previous
+     * frame of the slot; `head` does not move, so the slot is read
+     * by nobody until the next frame in it is published
+     */
+    __atomic_store_n(&(p_s->seq), p_s->seq + 1, __ATOMIC_RELEASE);
+}
+
+hide_symbol void
+internal_shm_end(internal_shm_t *p_shm)
+{
+    if (!(p_shm->p_hdr)) return;
+
+    __atomic_store_n(&(p_shm->p_hdr->state),
+        POLLUX_SHM_STATE_END, __ATOMIC_RELEASE);
+    i_head_wake(p_shm->p_hdr);
+}
@@ -0,0 +1,145 @@
+#include "./internal/pollux_internal_stats.h"
+
+#include <time.h>
+
+hide_symbol int64_t
+internal_stats_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static inline unsigned int
+i_bucket_index(uint64_t ns)
+{
+    if (ns < INTERNAL_HIST_SUB_NR) return (unsigned int)ns;
+
+    /* the power of 2, and the sub-bucket below it */
+    unsigned int e = 63 - __builtin_clzll(ns);
+    unsigned int sub = (unsigned int)
+        (ns >> (e - INTERNAL_HIST_SUB_BITS)) & (INTERNAL_HIST_SUB_NR - 1);
+    unsigned int idx =
+        (e - INTERNAL_HIST_SUB_BITS + 1) * INTERNAL_HIST_SUB_NR + sub;
+
+    return (idx < INTERNAL_HIST_BUCKET_NR) ?
+        idx : INTERNAL_HIST_BUCKET_NR - 1;
+}
+
+/**
+ * @brief the largest value of a bucket
+ */
+static inline uint64_t
+i_bucket_value(unsigned int idx)
+{
+    if (idx < INTERNAL_HIST_SUB_NR) return idx;
+
+    unsigned int e = idx / INTERNAL_HIST_SUB_NR + INTERNAL_HIST_SUB_BITS - 1;
+    unsigned int sub = idx % INTERNAL_HIST_SUB_NR;
+    uint64_t width = 1ULL << (e - INTERNAL_HIST_SUB_BITS);
+
+    return ((uint64_t)(INTERNAL_HIST_SUB_NR + sub) + 1) * width - 1;
+}
+
+static void
+i_hist_add(internal_hist_t *p_hist, uint64_t ns)
+{
+    atomic_fetch_add_explicit(
+        &(p_hist->bucket[i_bucket_index(ns)]), 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&(p_hist->count), 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&(p_hist->total_ns), ns, memory_order_relaxed);
+
+    unsigned long long max = atomic_load_explicit(
+        &(p_hist->max_ns), memory_order_relaxed);
+    while (ns > max && !(atomic_compare_exchange_weak_explicit(
+        &(p_hist->max_ns), &max, ns,
+        memory_order_relaxed, memory_order_relaxed)));
+}
+
+/**
+ * @brief the value at quantile `q`, no more than the maximum
+ */
+static uint64_t
+i_hist_quantile(const internal_hist_t *p_hist,
+    unsigned long long count, uint64_t max, double q)
+{
+    unsigned long long rank = (unsigned long long)(q * count), sum = 0;
+    if (rank == 0) rank = 1;
+    for (unsigned int i = 0; i < INTERNAL_HIST_BUCKET_NR; i++) {
+        sum += atomic_load_explicit(
+            &(p_hist->bucket[i]), memory_order_relaxed);
+        if (sum >= rank) {
+            uint64_t v = i_bucket_value(i);
+            return (v < max) ? v : max;
+        }
+    }
+
+    return max;
+}
+
+hide_symbol void
+internal_stats_reset(internal_stats_t *p_stats)
+{
+    atomic_store_explicit(&(p_stats->packet_nr), 0, memory_order_relaxed);
+    atomic_store_explicit(&(p_stats->decode_nr), 0, memory_order_relaxed);
+    atomic_store_explicit(&(p_stats->deliver_nr), 0, memory_order_relaxed);
+
+    internal_hist_t *p_hist;
+    for (unsigned int i = 0; i < POLLUX_STAGE_MAX; i++) {
+        p_hist = &(p_stats->hist[i]);
+        for (unsigned int j = 0; j < INTERNAL_HIST_BUCKET_NR; j++) {
+            atomic_store_explicit(
+                &(p_hist->bucket[j]), 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&(p_hist->count), 0, memory_order_relaxed);
+        atomic_store_explicit(&(p_hist->total_ns), 0, memory_order_relaxed);
+        atomic_store_explicit(&(p_hist->max_ns), 0, memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&(p_stats->start_ns),
+        internal_stats_now_ns(), memory_order_relaxed);
+}
+
+hide_symbol int64_t
+internal_stats_stage(internal_stats_t *p_stats,
+    pollux_stage_t stage, int64_t start_ns)
+{
+    int64_t now_ns = internal_stats_now_ns();
+    i_hist_add(&(p_stats->hist[stage]),
+        (now_ns > start_ns) ? (uint64_t)(now_ns - start_ns) : 0);
+
+    return now_ns;
+}
+
+hide_symbol void
+internal_stats_get(const internal_stats_t *p_stats,
+    pollux_decode_stats_t *p_out)
+{
+    p_out->elapsed_us = (internal_stats_now_ns() - atomic_load_explicit(
+        &(p_stats->start_ns), memory_order_relaxed)) / 1000;
+    p_out->packet_nr = atomic_load_explicit(
+        &(p_stats->packet_nr), memory_order_relaxed);
+    p_out->decode_nr = atomic_load_explicit(
+        &(p_stats->decode_nr), memory_order_relaxed);
+    p_out->deliver_nr = atomic_load_explicit(
+        &(p_stats->deliver_nr), memory_order_relaxed);
+    p_out->decode_fps = (p_out->elapsed_us > 0) ?
+        (double)(p_out->decode_nr) * 1000000 / p_out->elapsed_us : 0;
+
+    const internal_hist_t *p_hist;
+    pollux_decode_stage_stats_t *p_st;
+    for (unsigned int i = 0; i < POLLUX_STAGE_MAX; i++) {
+        p_hist = &(p_stats->hist[i]);
+        p_st = &(p_out->stage[i]);
+        p_st->count = atomic_load_explicit(
+            &(p_hist->count), memory_order_relaxed);
+        p_st->total_ns = atomic_load_explicit(
+            &(p_hist->total_ns), memory_order_relaxed);
+        p_st->max_ns = atomic_load_explicit(
+            &(p_hist->max_ns), memory_order_relaxed);
+        p_st->p50_ns = i_hist_quantile(
+            p_hist, p_st->count, p_st->max_ns, 0.50);
+        p_st->p99_ns = i_hist_quantile(
+            p_hist, p_st->count, p_st->max_ns, 0.99);
+    }
+}
@@ -0,0 +1,199 @@
+#include "pollux_erron.h"
+#include "sirius_log.h"
+
+#include "./internal/pollux_internal_trace.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+hide_symbol void
+internal_trace_close(internal_trace_t *p_trace)
+{
+    for (unsigned int i = 0; i < INTERNAL_TRACE_THD_MAX; i++) {
+        free(p_trace->ring[i].slot);
+        p_trace->ring[i].slot = NULL;
+    }
+}
+
+hide_symbol void
+internal_trace_reset(internal_trace_t *p_trace)
+{
+    internal_trace_ring_t *p_ring;
+    for (unsigned int i = 0; i < INTERNAL_TRACE_THD_MAX; i++) {
+        p_ring = &(p_trace->ring[i]);
+        if (!(p_ring->slot)) continue;
+        for (unsigned int j = 0; j < INTERNAL_TRACE_EVENT_NR; j++) {
+            atomic_store_explicit(
+                &(p_ring->slot[j].seq), 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&(p_ring->head), 0, memory_order_release);
+    }
+}
+
+hide_symbol void
+internal_trace_add(internal_trace_t *p_trace, internal_trace_thd_t thd,
+    internal_trace_ev_t ev, int64_t start_ns, int64_t end_ns, int64_t arg)
+{
+    internal_trace_ring_t *p_ring = &(p_trace->ring[thd]);
+    if (unlikely(!(p_ring->slot))) return;
+
+    unsigned long long pos = atomic_load_explicit(
+        &(p_ring->head), memory_order_relaxed);
+    internal_trace_slot_t *p_s =
+        &(p_ring->slot[pos & (INTERNAL_TRACE_EVENT_NR - 1)]);
+
+    atomic_store_explicit(&(p_s->seq), 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    p_s->start_ns = start_ns;
+    p_s->end_ns = end_ns;
+    p_s->arg = arg;
+    p_s->ev = ev;
+    atomic_store_explicit(&(p_s->seq), pos + 1, memory_order_release);
+    atomic_store_explicit(&(p_ring->head), pos + 1, memory_order_release);
+}
+
+#ifdef POLLUX_TRACE_ENABLE
+
+static const char *i_ev_name[INTERNAL_TRACE_EV_MAX] = {
+    "read", "send", "receive", "scale", "enqueue", "copy", "dequeue",
+};
+
+static const char *i_thd_name[INTERNAL_TRACE_THD_RENDITION] = {
+    "decode", "consumer",
+};
+
+hide_symbol int
+internal_trace_open(internal_trace_t *p_trace)
+{
+    for (unsigned int i = 0; i < INTERNAL_TRACE_THD_MAX; i++) {
+        p_trace->ring[i].slot = (internal_trace_slot_t *)calloc(
+            INTERNAL_TRACE_EVENT_NR, sizeof(internal_trace_slot_t));
+        if (!(p_trace->ring[i].slot)) {
+            SIRIUS_ERROR("calloc\n");
+            internal_trace_close(p_trace);
+            return POLLUX_ERR_MEMORY_ALLOC;
+        }
+        atomic_store(&(p_trace->ring[i].head), 0);
+    }
+
+    return POLLUX_OK;
+}
+
+/**
+ * @brief copy the event at `pos`
+ * 
+ * @return true if it was not overwritten meanwhile
+ */
+static bool
+i_slot_read(const internal_trace_ring_t *p_ring,
+    unsigned long long pos, internal_trace_slot_t *p_out)
+{
+    internal_trace_slot_t *p_s =
+        &(p_ring->slot[pos & (INTERNAL_TRACE_EVENT_NR - 1)]);
+    if (atomic_load_explicit(&(p_s->seq), memory_order_acquire) != pos + 1)
+        return false;
+
+    p_out->start_ns = p_s->start_ns;
+    p_out->end_ns = p_s->end_ns;
+    p_out->arg = p_s->arg;
+    p_out->ev = p_s->ev;
+    atomic_thread_fence(memory_order_acquire);
+
+    return atomic_load_explicit(
+        &(p_s->seq), memory_order_relaxed) == pos + 1 &&
+        (unsigned int)(p_out->ev) < INTERNAL_TRACE_EV_MAX;
+}
+
+hide_symbol int
+internal_trace_dump(internal_trace_t *p_trace, const char *p_file)
+{
+    FILE *fp = fopen(p_file, "w");
+    if (!(fp)) {
+        SIRIUS_ERROR("fopen: %s\n", p_file);
+        return POLLUX_ERR;
+    }
+
+    int pid = (int)getpid();
+    unsigned long long nr = 0;
+    bool is_first = true;
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (unsigned int i = 0; i < INTERNAL_TRACE_THD_MAX; i++) {
+        fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+            "\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"",
+            is_first ? "" : ",", pid, i);
+        if (i < INTERNAL_TRACE_THD_RENDITION) {
+            fprintf(fp, "%s\"}}", i_thd_name[i]);
+        } else {
+            fprintf(fp, "rendition %u\"}}",
+                i - INTERNAL_TRACE_THD_RENDITION + 1);
+        }
+        is_first = false;
+    }
+
+    internal_trace_ring_t *p_ring;
+    internal_trace_slot_t ev;
+    unsigned long long head, pos;
+    for (unsigned int i = 0; i < INTERNAL_TRACE_THD_MAX; i++) {
+        p_ring = &(p_trace->ring[i]);
+        if (!(p_ring->slot)) continue;
+
+        head = atomic_load_explicit(&(p_ring->head), memory_order_acquire);
+        pos = (head > INTERNAL_TRACE_EVENT_NR) ?
+            head - INTERNAL_TRACE_EVENT_NR : 0;
+        for (; pos < head; pos++) {
+            /* overwritten by the writer since `head` was read */
+            if (!(i_slot_read(p_ring, pos, &ev))) continue;
+
+            /* the timestamps of Chrome traces are in microseconds */
+            fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"pollux\","
+                "\"ph\":\"X\",\"pid\":%d,\"tid\":%u,"
+                "\"ts\":%lld.%03lld,\"dur\":%lld.%03lld",
+                i_ev_name[ev.ev], pid, i,
+                (long long)(ev.start_ns / 1000),
+                (long long)(ev.start_ns % 1000),
+                (long long)((ev.end_ns - ev.start_ns) / 1000),
+                (long long)((ev.end_ns - ev.start_ns) % 1000));
+            if (ev.arg >= 0) {
+                fprintf(fp, ",\"args\":{\"frame\":%lld}",
+                    (long long)(ev.arg));
+            }
+            fputc('}', fp);
+            nr++;
+        }
+    }
+    fprintf(fp, "\n]}\n");
+
+    int ret = POLLUX_OK;
+    if (fclose(fp)) {
+        SIRIUS_ERROR("fclose: %s\n", p_file);
+        ret = POLLUX_ERR;
+    }
+    SIRIUS_DEBG("%llu trace events written to %s\n", nr, p_file);
+
+    return ret;
+}
+
+#else
+
+hide_symbol int
+internal_trace_open(internal_trace_t *p_trace)
+{
+    for (unsigned int i = 0; i < INTERNAL_TRACE_THD_MAX; i++) {
+        p_trace->ring[i].slot = NULL;
+        atomic_store(&(p_trace->ring[i].head), 0);
+    }
+
+    return POLLUX_OK;
+}
+
+hide_symbol int
+internal_trace_dump(internal_trace_t *p_trace, const char *p_file)
+{
+    (void)p_trace;
+    (void)p_file;
+    return POLLUX_ERR_UNSUPPORTED;
+}
+
+#endif
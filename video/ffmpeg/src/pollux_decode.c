@@ -6,12 +6,26 @@
 #include "./internal/pollux_internal_thread.h"
 #include "./internal/pollux_internal_fmt.h"
 #include "./internal/pollux_internal_ffmpeg.h"
+#include "./internal/pollux_internal_mbox.h"
+#include "./internal/pollux_internal_pyramid.h"
+#include "./internal/pollux_internal_rend.h"
+#include "./internal/pollux_internal_kfidx.h"
+#include "./internal/pollux_internal_probe.h"
+#include "./internal/pollux_internal_audio.h"
+#include "./internal/pollux_internal_stats.h"
+#include "./internal/pollux_internal_trace.h"
+#include "./internal/pollux_internal_shed.h"
+#include "./internal/pollux_internal_seg.h"
+#include "./internal/pollux_internal_shm.h"
+#include "./internal/pollux_internal_alloc.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
 
 typedef struct {
     /* thread id */
@@ -19,6 +33,11 @@ typedef struct {
 
     /* thread state */
     pollux_internal_thd_state_t state;
+    /**
+     * the thread terminated on an error, not at the end of the file,
+     * it is set before `state`; refer to `i_thd_end_ret`
+     */
+    bool is_failed;
 } i_pollux_thd_t;
 
 typedef struct {
@@ -26,8 +45,62 @@ typedef struct {
     sirius_que_handle h_que_free;
     /* queue handle, result */
     sirius_que_handle h_que_res;
+    /* mailbox, used in `POLLUX_DELIVERY_MAILBOX` mode */
+    internal_mbox_t mbox;
     /* av_frame cache address */
     AVFrame *p_frame_nv21[INTERNAL_FRAME_NR];
+    /* the data of the frame caches is owned by the caller or by `shm` */
+    bool frame_ext;
+    /**
+     * the ring the frame caches live in when `slot_nr` of the `shm`
+     * parameter is set, frame cache `i` is slot `i`
+     */
+    internal_shm_t shm;
+    /**
+     * the allocator and the size of the data of each frame cache,
+     * kept from the allocation to the free
+     */
+    pollux_allocator_t frame_alloc;
+    size_t frame_size;
+    /**
+     * generation of the frame cache data, it is increased each time
+     * the data is allocated, so that stale tokens are rejected
+     */
+    atomic_uint frame_gen;
+    /**
+     * the frame caches out with the caller, retained by the callback
+     * or borrowed; `frame_release` clears the flag, so that a cache
+     * is given back to `h_que_free` only once
+     */
+    atomic_bool frame_held[INTERNAL_FRAME_NR];
+    /* the values of each frame cache, refer to `i_frame_meta` */
+    internal_frame_meta_t frame_meta[INTERNAL_FRAME_NR];
+    /* number of frames dropped since the last `param_set` */
+    atomic_ullong drop_nr;
+    /**
+     * event file descriptor in semaphore mode,
+     * its counter is not less than the number of ready results
+     */
+    int evt_fd;
+    /* the number of ready results announced on `evt_fd` */
+    atomic_uint ready_nr;
+
+    /**
+     * counters and latency histograms of the pipeline,
+     * updated without locks, refer to `stats_get`
+     */
+    internal_stats_t stats;
+    /* timeline of the pipeline events, empty without `POLLUX_TRACE` */
+    internal_trace_t trace;
+    /* load shedding, driven by the decoding thread */
+    internal_shed_t shed;
+
+    /**
+     * threads decoding segments of the file in parallel, open while
+     * `seg_on` is set; the decoding thread only delivers their frames
+     */
+    internal_seg_t seg;
+    bool seg_on;
 
     /* format parameter */
     internal_ffmpeg_param_t param;
@@ -37,13 +110,857 @@ typedef struct {
     /* ffmpeg parameters */
     internal_ffmpeg_info_t ffmpeg;
 
+    /* additional renditions, `rend_nr` of them are in use */
+    internal_rend_t rend[POLLUX_RENDITION_MAX];
+    unsigned int rend_nr;
+
+    /**
+     * the frame served again for the output ticks it stands for,
+     * refer to `repeat_nr`; `hold_nr` ticks are left
+     */
+    AVFrame *p_hold;
+    unsigned int hold_nr;
+    /* the time of the first tick of `p_hold` */
+    int64_t hold_us;
+
+    /* keyframe index of the stream, refer to `seek` */
+    internal_kfidx_t kfidx;
+
+    /**
+     * audio output, open while `audio_on` is set;
+     * `audio_mtx` only keeps `audio_get` away from `param_set`
+     * and `release`, the decoding thread never takes it
+     */
+    internal_audio_t audio;
+    bool audio_on;
+    pthread_mutex_t audio_mtx;
+
+    /**
+     * seek request, the decoding thread performs it and
+     * clears `seek_pending` under `seek_mtx`
+     */
+    pthread_mutex_t seek_mtx;
+    pthread_cond_t seek_cond;
+    atomic_bool seek_pending;
+    long long seek_target;
+    pollux_seek_t seek_mode;
+    int seek_ret;
+
     /* result mutex */
     pthread_mutex_t mtx;
+    /**
+     * the number of `param_set` / `release` calls waiting for `mtx`,
+     * the consumers stop waiting for frames while it is not 0
+     */
+    atomic_uint closing;
 
     /* information of the decode thread */
     i_pollux_thd_t thd;
+    /* wakes up the decoding thread from pacing, refer to `i_thd_wake` */
+    pthread_mutex_t wake_mtx;
+    pthread_cond_t wake_cond;
 } i_pollux_t;
 
+typedef struct {
+    /* the clock has been started */
+    bool started;
+    /* the monotonic time when the frame at `pts_us` was due */
+    int64_t wall_us;
+    /* the presentation time the clock was started at */
+    int64_t pts_us;
+} i_pollux_pace_t;
+
+/**
+ * timeline of the decoding thread, it is reset by `seek`
+ */
+typedef struct {
+    /**
+     * `pts_base` moves the timestamps of each loop behind the
+     * previous one, `pts_next` stands in for missing timestamps
+     */
+    int64_t pts_base;
+    int64_t pts_next;
+    /* index of the next decoded frame */
+    unsigned long long frame_idx;
+
+    /* the next output tick of the rate conversion, unused if `fps` is 0 */
+    int64_t tick;
+    /* decoding pace */
+    i_pollux_pace_t pace;
+    /* a frame has passed since the reset, `pts_next` follows it */
+    bool has_frame;
+    /**
+     * frames for which the index still steps over the gaps in the
+     * timestamps, refer to `i_timeline_gap`; it runs on for a while
+     * after the discarding stops, for the frames still in the decoder
+     */
+    unsigned int gap_nr;
+
+    /**
+     * frames decoded after a seek but not delivered, either the next
+     * `skip_nr` frames, or the frames before `skip_pts_us`
+     * (`AV_NOPTS_VALUE` if none)
+     */
+    unsigned long long skip_nr;
+    int64_t skip_pts_us;
+    /**
+     * a seek found no keyframe in the index, the index of the first
+     * frame decoded is worked out from its timestamp
+     */
+    bool is_idx_pending;
+} i_pollux_timeline_t;
+
+/**
+ * @brief announce `nr` more ready results on the event descriptor,
+ *  it is always called before the results are published, so that
+ *  the counter never falls behind the results
+ */
+static inline void
+i_notify_post(i_pollux_t *p_g, unsigned int nr)
+{
+    uint64_t v = nr;
+    atomic_fetch_add_explicit(&(p_g->ready_nr), nr, memory_order_relaxed);
+    if (write(p_g->evt_fd, &v, sizeof(v)) != sizeof(v)) {
+        SIRIUS_WARN("eventfd write\n");
+    }
+}
+
+/**
+ * @brief withdraw `nr` ready results from the event descriptor
+ */
+static inline void
+i_notify_consume(i_pollux_t *p_g, unsigned int nr)
+{
+    uint64_t v;
+    atomic_fetch_sub_explicit(&(p_g->ready_nr), nr, memory_order_relaxed);
+    while (nr--) {
+        if (read(p_g->evt_fd, &v, sizeof(v)) != sizeof(v)) {
+            SIRIUS_WARN("eventfd read\n");
+        }
+    }
+}
+
+/**
+ * @brief withdraw all the pending notifications
+ */
+static inline void
+i_notify_reset(i_pollux_t *p_g)
+{
+    uint64_t v;
+    while (read(p_g->evt_fd, &v, sizeof(v)) == sizeof(v));
+    atomic_store_explicit(&(p_g->ready_nr), 0, memory_order_relaxed);
+}
+
+/**
+ * @brief close a timed stage, in the statistics and in the trace
+ * 
+ * @param[in] arg: index of the frame, -1 if none
+ * 
+ * @return the end of the stage
+ */
+static inline int64_t
+i_stage_end(i_pollux_t *p_g, internal_trace_thd_t thd,
+    pollux_stage_t stage, int64_t start_ns, int64_t arg)
+{
+    int64_t end_ns = internal_stats_stage(&(p_g->stats), stage, start_ns);
+    INTERNAL_TRACE(&(p_g->trace), thd,
+        (internal_trace_ev_t)stage, start_ns, end_ns, arg);
+
+    return end_ns;
+}
+
+/**
+ * @brief the values of a frame cache, refer to `frame_meta`
+ */
+static inline internal_frame_meta_t *
+i_frame_meta(i_pollux_t *p_g, const AVFrame *avf)
+{
+    return &(p_g->frame_meta[(intptr_t)(avf->opaque)]);
+}
+
+/**
+ * @brief what the consumer gets once the decoding thread terminated
+ */
+static inline int
+i_thd_end_ret(const i_pollux_t *p_g)
+{
+    return (p_g->param.is_loop || p_g->thd.is_failed) ?
+        POLLUX_ERR_DECODE_THD_EXIT : POLLUX_ERR_FILE_END;
+}
+
+/**
+ * @brief get an idle frame cache for the decoding thread
+ * 
+ * @return the frame cache, `NULL` if no cache is available in time
+ */
+static AVFrame *
+i_frame_idle_get(i_pollux_t *p_g)
+{
+    AVFrame *avf = NULL;
+    if (p_g->param.delivery == POLLUX_DELIVERY_FIFO &&
+        p_g->param.drop == POLLUX_DROP_OLDEST) {
+        /* a `NULL` here is the wakeup of the teardown, it is not lost */
+        if (!(sirius_que_get(p_g->h_que_free,
+            (size_t *)&avf, SIRIUS_QUE_TIMEOUT_NONE)))
+            return avf;
+
+        /* every cache is waiting for the consumer, recycle the oldest */
+        if (!(sirius_que_get(p_g->h_que_res,
+            (size_t *)&avf, SIRIUS_QUE_TIMEOUT_NONE))) {
+            if (avf) {
+                i_notify_consume(p_g, i_frame_meta(p_g, avf)->repeat_nr);
+                atomic_fetch_add_explicit(
+                    &(p_g->drop_nr), 1, memory_order_relaxed);
+                return avf;
+            }
+            /* the `NULL` of `i_consumer_kick`, it is the consumer's */
+            (void)sirius_que_put(p_g->h_que_res, 0, SIRIUS_QUE_TIMEOUT_NONE);
+        }
+    }
+
+    if (sirius_que_get(p_g->h_que_free, (size_t *)&avf, 1000))
+        return NULL;
+    return avf;
+}
+
+/**
+ * @brief hand a converted frame over to the consumer
+ */
+static void
+i_frame_deliver(i_pollux_t *p_g, AVFrame *avf)
+{
+    i_notify_post(p_g, i_frame_meta(p_g, avf)->repeat_nr);
+
+    if (p_g->param.delivery == POLLUX_DELIVERY_MAILBOX) {
+        AVFrame *p_old = internal_mbox_put(&(p_g->mbox), avf);
+        if (p_old) {
+            /* the slot was already announced */
+            i_notify_consume(p_g, i_frame_meta(p_g, p_old)->repeat_nr);
+            atomic_fetch_add_explicit(
+                &(p_g->drop_nr), 1, memory_order_relaxed);
+            sirius_que_put(p_g->h_que_free,
+                (size_t)p_old, SIRIUS_QUE_TIMEOUT_NONE);
+        }
+        return;
+    }
+
+    sirius_que_put(p_g->h_que_res, (size_t)avf, 1000);
+}
+
+/**
+ * @brief take a converted frame for the consumer
+ * 
+ * @return the frame, `NULL` if no frame is available in time
+ */
+static AVFrame *
+i_frame_take(i_pollux_t *p_g, unsigned int timeout_ms)
+{
+    if (atomic_load_explicit(&(p_g->closing), memory_order_relaxed))
+        timeout_ms = 0;
+
+    AVFrame *avf = NULL;
+    if (p_g->param.delivery == POLLUX_DELIVERY_MAILBOX) {
+        avf = (AVFrame *)internal_mbox_get(&(p_g->mbox), timeout_ms);
+    } else if (sirius_que_get(
+        p_g->h_que_res, (size_t *)&avf, timeout_ms)) {
+        avf = NULL;
+    }
+
+    if (avf) i_notify_consume(p_g, 1);
+    return avf;
+}
+
+/**
+ * @brief take the frame of the next output tick, it is either
+ *  a new frame or the held one repeated,
+ *  give it back by `i_tick_done` after it is read
+ * 
+ * @return the frame, `NULL` if no frame is available in time
+ */
+static AVFrame *
+i_tick_take(i_pollux_t *p_g, unsigned int timeout_ms)
+{
+    if (p_g->p_hold) {
+        i_notify_consume(p_g, 1);
+        return p_g->p_hold;
+    }
+
+    int64_t t_ns = INTERNAL_TRACE_NOW();
+    AVFrame *avf = i_frame_take(p_g, timeout_ms);
+    if (avf) {
+        INTERNAL_TRACE(&(p_g->trace), INTERNAL_TRACE_THD_CONSUMER,
+            INTERNAL_TRACE_EV_DEQUEUE, t_ns, INTERNAL_TRACE_NOW(),
+            (int64_t)(i_frame_meta(p_g, avf)->frame_idx));
+        p_g->p_hold = avf;
+        p_g->hold_nr = i_frame_meta(p_g, avf)->repeat_nr;
+        p_g->hold_us = i_frame_meta(p_g, avf)->pts_us;
+    }
+    return avf;
+}
+
+static void
+i_tick_done(i_pollux_t *p_g, AVFrame *avf)
+{
+    internal_frame_meta_t *p_meta = i_frame_meta(p_g, avf);
+    if (--(p_g->hold_nr)) {
+        /**
+         * the same picture, one tick later; counted from the first
+         * tick, so that the rounding of `1 / fps` does not add up
+         */
+        p_meta->pts_us = p_g->hold_us + av_rescale_q(
+            p_meta->repeat_nr - p_g->hold_nr,
+            (AVRational){1, p_g->param.fps}, AV_TIME_BASE_Q);
+        return;
+    }
+
+    p_g->p_hold = NULL;
+    if (sirius_que_put(p_g->h_que_free,
+        (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE)) {
+        SIRIUS_WARN("sirius_que_put\n");
+    }
+}
+
+static inline int64_t
+i_tick_us(int64_t tick, unsigned short fps)
+{
+    return tick * AV_TIME_BASE / fps;
+}
+
+/**
+ * @brief the first tick at or after `t_us`
+ */
+static inline int64_t
+i_tick_at(int64_t t_us, unsigned short fps)
+{
+    if (t_us <= 0) return 0;
+    return (t_us * fps + AV_TIME_BASE - 1) / AV_TIME_BASE;
+}
+
+/**
+ * @brief count the output ticks a frame stands for, they are the
+ *  ticks before the end of the frame not taken by the previous one
+ * 
+ * @param[in,out] p_tick: the next tick, negative before the first frame
+ * @param[out] p_first_us: the time of the first tick of the frame
+ * 
+ * @return the number of ticks, 0 if the frame is not shown at all;
+ *  no more than `fps`, a longer frame is cut to one second
+ */
+static unsigned int
+i_tick_count(int64_t *p_tick, unsigned short fps,
+    int64_t pts_us, int64_t end_us, int64_t *p_first_us)
+{
+    /**
+     * the first frame, or the timestamps jumped more than a second
+     * either way (a broken or spliced stream): the ticks start over
+     * at the frame instead of filling or skipping the gap
+     */
+    if (*p_tick < 0 ||
+        i_tick_us(*p_tick, fps) > end_us + AV_TIME_BASE ||
+        i_tick_us(*p_tick, fps) < pts_us - AV_TIME_BASE) {
+        *p_tick = i_tick_at(pts_us, fps);
+    }
+
+    int64_t nr = i_tick_at(end_us, fps) - *p_tick;
+    if (nr <= 0) nr = 0;
+    if (nr > fps) nr = fps;
+
+    *p_first_us = i_tick_us(*p_tick, fps);
+    *p_tick += nr;
+    return (unsigned int)nr;
+}
+
+/**
+ * @brief the due time of the frame at `pts_us` on the monotonic clock
+ * 
+ * @return false if the clock was restarted at the frame, it is on time
+ */
+static bool
+i_pace_due(i_pollux_pace_t *p_pace, int64_t pts_us,
+    int64_t *p_now_us, int64_t *p_due_us)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    *p_now_us = (int64_t)ts.tv_sec * AV_TIME_BASE + ts.tv_nsec / 1000;
+    *p_due_us = p_pace->wall_us + (pts_us - p_pace->pts_us);
+
+    /**
+     * the first frame, or more than a second away from the clock,
+     * the timestamps jumped or the decoder fell that far behind;
+     * restart the clock instead of sleeping, bursting or dropping
+     */
+    if (!(p_pace->started) || *p_due_us - *p_now_us > AV_TIME_BASE ||
+        *p_now_us - *p_due_us > AV_TIME_BASE) {
+        p_pace->started = true;
+        p_pace->wall_us = *p_now_us;
+        p_pace->pts_us = pts_us;
+        *p_due_us = *p_now_us;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief wait until the presentation time of the frame, so that the
+ *  source is decoded at its native rate; `i_thd_wake` cuts it short
+ * 
+ * @return how late the frame was, unit: microsecond;
+ *  negative if it was early, 0 if the clock was restarted
+ */
+static int64_t
+i_frame_pace(i_pollux_t *p_g, i_pollux_pace_t *p_pace, int64_t pts_us)
+{
+    struct timespec ts;
+    int64_t now_us, due_us;
+    if (!(i_pace_due(p_pace, pts_us, &now_us, &due_us))) return 0;
+    if (due_us <= now_us) return now_us - due_us;
+
+    ts.tv_sec = due_us / AV_TIME_BASE;
+    ts.tv_nsec = (due_us % AV_TIME_BASE) * 1000;
+    pthread_mutex_lock(&(p_g->wake_mtx));
+    while (p_g->thd.state == INTERNAL_THD_STATE_RUNNING &&
+        !(atomic_load_explicit(&(p_g->seek_pending), memory_order_acquire))) {
+        if (pthread_cond_timedwait(
+            &(p_g->wake_cond), &(p_g->wake_mtx), &ts)) break;
+    }
+    pthread_mutex_unlock(&(p_g->wake_mtx));
+
+    return now_us - due_us;
+}
+
+/**
+ * @brief how late the frame at `pts_us` already is, without waiting;
+ *  the clock is restarted the same way as by `i_frame_pace`, so that
+ *  a decoder too far behind lets a frame through again
+ * 
+ * @return unit: microsecond, not positive if it is on time
+ */
+static int64_t
+i_pace_late_us(i_pollux_pace_t *p_pace, int64_t pts_us)
+{
+    int64_t now_us, due_us;
+    if (!(i_pace_due(p_pace, pts_us, &now_us, &due_us))) return 0;
+    return now_us - due_us;
+}
+
+/**
+ * @brief move the clock by the time the consumer held up the decoding
+ *  thread, waiting for a frame cache or in the delivery; it is not
+ *  the lateness of the decoding, and must not shed load
+ * 
+ * @param[in] hold_ns: below a millisecond it is the hand-over itself,
+ *  which the clock must not drift by
+ */
+static inline void
+i_pace_hold(i_pollux_pace_t *p_pace, int64_t hold_ns)
+{
+    if (p_pace->started && hold_ns >= 1000000)
+        p_pace->wall_us += hold_ns / 1000;
+}
+
+/**
+ * @brief wake up the decoding thread from pacing, the reason,
+ *  a new thread state or a seek request, must be set before
+ */
+static void
+i_thd_wake(i_pollux_t *p_g)
+{
+    pthread_mutex_lock(&(p_g->wake_mtx));
+    pthread_cond_broadcast(&(p_g->wake_cond));
+    pthread_mutex_unlock(&(p_g->wake_mtx));
+}
+
+/**
+ * @brief the interrupt callback of the format context,
+ *  blocking I/O is given up once the thread is asked to exit
+ */
+static int
+i_thd_interrupt(void *args)
+{
+    i_pollux_t *p_g = (i_pollux_t *)args;
+    return p_g->thd.state == INTERNAL_THD_STATE_EXITING;
+}
+
+/**
+ * @brief make the consumers waiting in `mtx` return at once,
+ *  so that `param_set` / `release` get it without delay;
+ *  undone by `i_consumer_unkick`
+ */
+static void
+i_consumer_kick(i_pollux_t *p_g)
+{
+    atomic_fetch_add_explicit(&(p_g->closing), 1, memory_order_relaxed);
+
+    /**
+     * the `NULL` is taken as a timeout, a stale one is
+     * cleared when the frame data are freed
+     */
+    (void)sirius_que_put(p_g->h_que_res, 0, SIRIUS_QUE_TIMEOUT_NONE);
+    internal_mbox_kick(&(p_g->mbox));
+    /**
+     * `rend_nr` does not change while a consumer waits in a rendition,
+     * the queues of all the renditions live as long as the handle
+     */
+    for (unsigned int i = 0; i < p_g->rend_nr; i++) {
+        internal_rend_kick(&(p_g->rend[i]));
+    }
+}
+
+/**
+ * @brief keep the consumers of the renditions away, after
+ *  `i_consumer_kick` and with `p_g->mtx` held
+ */
+static void
+i_rend_lock(i_pollux_t *p_g)
+{
+    for (unsigned int i = 0; i < POLLUX_RENDITION_MAX; i++) {
+        pthread_mutex_lock(&(p_g->rend[i].mtx));
+    }
+}
+
+static void
+i_rend_unlock(i_pollux_t *p_g)
+{
+    for (unsigned int i = 0; i < POLLUX_RENDITION_MAX; i++) {
+        pthread_mutex_unlock(&(p_g->rend[i].mtx));
+    }
+}
+
+static inline void
+i_consumer_unkick(i_pollux_t *p_g)
+{
+    atomic_fetch_sub_explicit(&(p_g->closing), 1, memory_order_relaxed);
+}
+
+static inline int
+i_frame_token(i_pollux_t *p_g, const AVFrame *avf)
+{
+    unsigned int gen = atomic_load_explicit(
+        &(p_g->frame_gen), memory_order_acquire);
+    return (int)((gen % (INT_MAX / INTERNAL_FRAME_NR)) *
+        INTERNAL_FRAME_NR + (intptr_t)(avf->opaque));
+}
+
+/**
+ * @brief mark a frame cache as out with the caller,
+ *  refer to `frame_held`
+ */
+static inline void
+i_frame_hold(i_pollux_t *p_g, const AVFrame *avf)
+{
+    atomic_store_explicit(&(p_g->frame_held[(intptr_t)(avf->opaque)]),
+        true, memory_order_release);
+}
+
+/**
+ * @brief take a frame cache back from the caller
+ * 
+ * @return true if it was out with the caller, only then it may be
+ *  given back to `h_que_free`
+ */
+static inline bool
+i_frame_unhold(i_pollux_t *p_g, const AVFrame *avf)
+{
+    return atomic_exchange_explicit(
+        &(p_g->frame_held[(intptr_t)(avf->opaque)]),
+        false, memory_order_acq_rel);
+}
+
+/**
+ * @brief hand a converted frame over to the frame ready callback
+ */
+static void
+i_frame_callback(i_pollux_t *p_g, AVFrame *avf)
+{
+    pollux_decode_frame_view_t view = {0};
+    view.width = avf->width;
+    view.height = avf->height;
+    view.fmt = p_g->param.pollux_fmt;
+    for (unsigned int i = 0; i < 4; i++) {
+        view.data[i] = avf->data[i];
+        view.linesize[i] = avf->linesize[i];
+    }
+    view.index = (unsigned int)(intptr_t)(avf->opaque);
+    view.token = i_frame_token(p_g, avf);
+    view.pts_us = i_frame_meta(p_g, avf)->pts_us;
+    view.frame_idx = i_frame_meta(p_g, avf)->frame_idx;
+    view.repeat_nr = i_frame_meta(p_g, avf)->repeat_nr;
+
+    /* before the call, the callback may release the frame itself */
+    i_frame_hold(p_g, avf);
+    if (p_g->param.on_frame(&view, p_g->param.p_user) !=
+        POLLUX_FRAME_RETAIN && i_frame_unhold(p_g, avf)) {
+        sirius_que_put(p_g->h_que_free,
+            (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE);
+    }
+}
+
+/**
+ * @brief step the index over the frames the decoder discarded to shed
+ *  load; `AVDISCARD_NONREF` leaves no trace of them but the gap in the
+ *  timestamps, and `frame_idx` must go on counting the frames of the
+ *  stream, as the keyframe index does
+ */
+static void
+i_timeline_gap(i_pollux_timeline_t *p_tl, const AVCodecContext *codec_ctx,
+    int64_t pts_us, int64_t dur_us)
+{
+    if (codec_ctx->skip_frame >= AVDISCARD_NONREF) {
+        p_tl->gap_nr = INTERNAL_SHED_HOLD_NR;
+    } else if (p_tl->gap_nr) {
+        p_tl->gap_nr--;
+    } else {
+        return;
+    }
+
+    int64_t gap_us = pts_us - p_tl->pts_next;
+    /* half a frame or less is the jitter of the timestamps */
+    if (p_tl->has_frame && dur_us > 0 && gap_us > dur_us / 2)
+        p_tl->frame_idx += (gap_us + dur_us / 2) / dur_us;
+}
+
+static void
+i_timeline_reset(i_pollux_timeline_t *p_tl,
+    int64_t pts_us, unsigned long long frame_idx)
+{
+    memset(p_tl, 0, sizeof(i_pollux_timeline_t));
+    p_tl->pts_next = pts_us;
+    p_tl->frame_idx = frame_idx;
+    p_tl->tick = -1;
+    p_tl->skip_pts_us = AV_NOPTS_VALUE;
+}
+
+/**
+ * @brief give every delivered frame not yet taken back to the decoder
+ */
+static void
+i_frame_flush(i_pollux_t *p_g)
+{
+    AVFrame *avf;
+    while (!(sirius_que_get(p_g->h_que_res,
+        (size_t *)&avf, SIRIUS_QUE_TIMEOUT_NONE))) {
+        if (!(avf)) continue;
+        i_notify_consume(p_g, i_frame_meta(p_g, avf)->repeat_nr);
+        sirius_que_put(p_g->h_que_free, (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE);
+    }
+
+    if ((avf = (AVFrame *)internal_mbox_reset(&(p_g->mbox)))) {
+        i_notify_consume(p_g, i_frame_meta(p_g, avf)->repeat_nr);
+        sirius_que_put(p_g->h_que_free, (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE);
+    }
+
+    for (unsigned int i = 0; i < p_g->rend_nr; i++) {
+        internal_rend_flush(&(p_g->rend[i]));
+    }
+}
+
+/**
+ * @brief perform the seek request in the decoding thread
+ */
+static void
+i_seek_run(i_pollux_t *p_g, i_pollux_timeline_t *p_tl)
+{
+    internal_ffmpeg_info_t *p_ffmpeg = &(p_g->ffmpeg);
+    AVStream *st = p_ffmpeg->fmt_ctx->streams[p_ffmpeg->stream_index];
+    internal_kfidx_t *p_idx = &(p_g->kfidx);
+
+    pthread_mutex_lock(&(p_g->seek_mtx));
+    long long target = p_g->seek_target;
+    pollux_seek_t mode = p_g->seek_mode;
+    /* the frames of the old position delivered since `seek` flushed */
+    i_frame_flush(p_g);
+
+    const internal_kf_entry_t *p_kf = NULL;
+    int64_t ts, frame_nr = -1;
+    if (mode == POLLUX_SEEK_FRAME) {
+        if ((p_kf = internal_kfidx_by_frame(p_idx, target))) {
+            frame_nr = p_kf->frame_nr;
+        } else if (st->avg_frame_rate.num > 0) {
+            /* no index yet, the frame rate turns the frame into a time */
+            target = av_rescale(target, (int64_t)AV_TIME_BASE *
+                st->avg_frame_rate.den, st->avg_frame_rate.num);
+            mode = POLLUX_SEEK_ACCURATE;
+        } else {
+            p_g->seek_ret = POLLUX_ERR_UNSUPPORTED;
+            goto label_seek_done;
+        }
+    }
+
+    if (mode == POLLUX_SEEK_FRAME) {
+        ts = p_kf->ts;
+        i_timeline_reset(p_tl, 0, frame_nr);
+        p_tl->skip_nr = target - frame_nr;
+    } else {
+        ts = av_rescale_q(target, AV_TIME_BASE_Q, st->time_base) +
+            p_idx->start_time;
+        if ((p_kf = internal_kfidx_by_ts(p_idx, ts))) {
+            ts = p_kf->ts;
+            frame_nr = p_kf->frame_nr;
+        }
+        /**
+         * without the keyframe the decoding starts somewhere before
+         * `target`, the index of the target would be too high
+         */
+        i_timeline_reset(p_tl, target,
+            (frame_nr < 0) ? 0 : (unsigned long long)frame_nr);
+        p_tl->is_idx_pending = (frame_nr < 0);
+        if (mode == POLLUX_SEEK_ACCURATE) p_tl->skip_pts_us = target;
+    }
+
+    /* the keyframe at or before `ts` */
+    if (avformat_seek_file(p_ffmpeg->fmt_ctx,
+        p_ffmpeg->stream_index, INT64_MIN, ts, ts, 0) < 0) {
+        SIRIUS_ERROR("avformat_seek_file\n");
+        p_g->seek_ret = POLLUX_ERR;
+        goto label_seek_done;
+    }
+    avcodec_flush_buffers(p_ffmpeg->codec_ctx);
+    if (p_g->audio_on) internal_audio_flush(&(p_g->audio), p_tl->pts_next);
+    p_g->seek_ret = POLLUX_OK;
+
+label_seek_done:
+    atomic_store_explicit(&(p_g->seek_pending), false, memory_order_release);
+    pthread_cond_broadcast(&(p_g->seek_cond));
+    pthread_mutex_unlock(&(p_g->seek_mtx));
+}
+
+/**
+ * @brief take a decoded frame through the timeline, the conversion
+ *  and the delivery
+ * 
+ * @param[in] is_paced: wait for the presentation time of the frame,
+ *  and shed load when it is late
+ */
+static void
+i_frame_output(i_pollux_t *p_g, i_pollux_timeline_t *p_tl,
+    AVFrame *frame, bool is_paced)
+{
+    internal_ffmpeg_param_t *p_m = &(p_g->param);
+    internal_ffmpeg_info_t *p_ffmpeg = &(p_g->ffmpeg);
+    const internal_trace_thd_t thd = INTERNAL_TRACE_THD_DECODE;
+
+    AVFrame *avf;
+    internal_frame_meta_t meta;
+    int64_t pts_us, tick_us, dur_us, t_ns, late_us;
+
+    pts_us = internal_ffmpeg_pts_us(p_ffmpeg, frame);
+    pts_us = (pts_us == AV_NOPTS_VALUE) ?
+        p_tl->pts_next : p_tl->pts_base + pts_us;
+    if (p_tl->is_idx_pending) {
+        /* the first frame after a seek without the index */
+        const AVStream *st =
+            p_ffmpeg->fmt_ctx->streams[p_ffmpeg->stream_index];
+        p_tl->frame_idx = (st->avg_frame_rate.num > 0 && pts_us > 0) ?
+            (unsigned long long)av_rescale(pts_us, st->avg_frame_rate.num,
+                (int64_t)AV_TIME_BASE * st->avg_frame_rate.den) : 0;
+        p_tl->is_idx_pending = false;
+    }
+    dur_us = internal_ffmpeg_duration_us(p_ffmpeg, frame);
+    if (is_paced) i_timeline_gap(p_tl, p_ffmpeg->codec_ctx, pts_us, dur_us);
+    if (dur_us <= 0 && p_m->fps) dur_us = i_tick_us(1, p_m->fps);
+    p_tl->pts_next = pts_us + dur_us;
+    p_tl->has_frame = true;
+    meta.frame_idx = p_tl->frame_idx++;
+
+    /* on the way from the keyframe to the target of a seek */
+    if (p_tl->skip_nr) {
+        p_tl->skip_nr--;
+        return;
+    }
+    if (p_tl->skip_pts_us != AV_NOPTS_VALUE) {
+        if (pts_us < p_tl->skip_pts_us) return;
+        p_tl->skip_pts_us = AV_NOPTS_VALUE;
+    }
+
+    /**
+     * a frame covering no output tick is dropped before it is
+     * converted, one covering several is converted once and
+     * repeated by the consumer
+     */
+    meta.repeat_nr = 1;
+    meta.pts_us = pts_us;
+    if (p_m->fps) {
+        meta.repeat_nr = i_tick_count(&(p_tl->tick), p_m->fps,
+            pts_us, p_tl->pts_next, &tick_us);
+        if (!(meta.repeat_nr)) return;
+        meta.pts_us = tick_us;
+        /* only the newest frame counts in a mailbox */
+        if (p_m->delivery == POLLUX_DELIVERY_MAILBOX) meta.repeat_nr = 1;
+    }
+
+    /* already past its due time, the conversion only adds to it */
+    if (is_paced &&
+        internal_shed_level(&(p_g->shed)) >= POLLUX_SHED_CONVERT &&
+        (late_us = i_pace_late_us(&(p_tl->pace), pts_us)) > 0) {
+        internal_shed_update(&(p_g->shed), p_ffmpeg->codec_ctx, late_us);
+        atomic_fetch_add_explicit(
+            &(p_g->drop_nr), 1, memory_order_relaxed);
+        return;
+    }
+
+    /**
+     * the frame cache is requested after the frame is received,
+     * so that no cache is held or recycled for nothing;
+     * the ring never waits, the next slot is always taken
+     */
+    t_ns = internal_stats_now_ns();
+    avf = (p_g->shm.p_hdr) ?
+        p_g->p_frame_nv21[internal_shm_begin(&(p_g->shm))] :
+        i_frame_idle_get(p_g);
+    if (is_paced)
+        i_pace_hold(&(p_tl->pace), internal_stats_now_ns() - t_ns);
+    if (avf) {
+        t_ns = internal_stats_now_ns();
+        avf->height = internal_ffmpeg_convert(&(p_ffmpeg->sws_ctx),
+            frame, avf, p_m->width, p_m->height, p_m->fmt);
+        avf->width = p_m->width;
+        avf->format = p_m->fmt;
+        *i_frame_meta(p_g, avf) = meta;
+        i_stage_end(p_g, thd,
+            POLLUX_STAGE_CONVERT, t_ns, (int64_t)(meta.frame_idx));
+    }
+    /* not converted, the cache is given back, the slot unpublished */
+    if (avf && avf->height <= 0) {
+        if (p_g->shm.p_hdr) {
+            internal_shm_abort(&(p_g->shm));
+        } else {
+            sirius_que_put(
+                p_g->h_que_free, (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE);
+        }
+        atomic_fetch_add_explicit(
+            &(p_g->drop_nr), 1, memory_order_relaxed);
+        avf = NULL;
+    }
+    if (avf) {
+        /* the pacing wait is on purpose, it is not counted */
+        if (is_paced) {
+            late_us = i_frame_pace(p_g, &(p_tl->pace), pts_us);
+            internal_shed_update(
+                &(p_g->shed), p_ffmpeg->codec_ctx, late_us);
+        }
+        t_ns = internal_stats_now_ns();
+        if (p_g->shm.p_hdr) {
+            internal_shm_publish(&(p_g->shm), &meta);
+        } else if (p_m->on_frame) {
+            i_frame_callback(p_g, avf);
+        } else {
+            i_frame_deliver(p_g, avf);
+        }
+        t_ns = i_stage_end(p_g, thd,
+            POLLUX_STAGE_DELIVER, t_ns, (int64_t)(meta.frame_idx)) - t_ns;
+        /* the pace is kept after the frame, the consumer took the time */
+        if (is_paced) i_pace_hold(&(p_tl->pace), t_ns);
+        atomic_fetch_add_explicit(
+            &(p_g->stats.deliver_nr), 1, memory_order_relaxed);
+    }
+
+    /* the same decoded frame, only the conversion is repeated */
+    for (unsigned int i = 0; i < p_g->rend_nr; i++) {
+        internal_rend_push(&(p_g->rend[i]), frame, &meta);
+    }
+}
+
 static int
 i_stream_decode_thd(void *args)
 {
@@ -52,18 +969,27 @@ i_stream_decode_thd(void *args)
     internal_ffmpeg_info_t *p_ffmpeg = &(p_g->ffmpeg);
     AVFormatContext *fmt_ctx = p_ffmpeg->fmt_ctx;
     AVCodecContext *codec_ctx = p_ffmpeg->codec_ctx;
-    struct SwsContext *sws_ctx = p_ffmpeg->sws_ctx;
     AVFrame *frame = p_ffmpeg->frame;
     AVPacket *pkt = p_ffmpeg->pkt;
     i_pollux_thd_t *p_thd = &(p_g->thd);
 
-    const int interval_ms = 1000 / p_m->fps;
-    struct timespec start, end;
-    long elapsed_ms, sleep_ms;
-    AVFrame *avf;
+    int ret;
+    int64_t t_ns;
+    internal_stats_t *p_stats = &(p_g->stats);
+    const internal_trace_thd_t thd = INTERNAL_TRACE_THD_DECODE;
+    i_pollux_timeline_t tl;
+    i_timeline_reset(&tl, 0, 0);
+    internal_sched_apply(&(p_m->sched));
     while (p_thd->state == INTERNAL_THD_STATE_RUNNING) {
-        clock_gettime(CLOCK_MONOTONIC, &start);
-        if (av_read_frame(fmt_ctx, pkt) == AVERROR_EOF) {
+        if (atomic_load_explicit(&(p_g->seek_pending), memory_order_acquire))
+            i_seek_run(p_g, &tl);
+
+        t_ns = internal_stats_now_ns();
+        ret = av_read_frame(fmt_ctx, pkt);
+        t_ns = i_stage_end(p_g, thd, POLLUX_STAGE_READ, t_ns, -1);
+        if (ret == AVERROR_EOF) {
+            if (p_g->audio_on) internal_audio_decode(
+                &(p_g->audio), NULL, tl.pts_base, tl.skip_pts_us);
             if (unlikely(!(p_m->is_loop))) goto label_thd_terminal;
             if (avformat_seek_file(fmt_ctx, p_ffmpeg->stream_index,
                     0, 0, 0, AVSEEK_FLAG_BACKWARD) < 0) {
@@ -71,36 +997,36 @@ i_stream_decode_thd(void *args)
                 goto label_thd_terminal;
             }
             SIRIUS_INFO("video loop\n");
+            tl.pts_base = tl.pts_next;
             goto label_continue;
         }
 
-        if ((pkt->stream_index != p_ffmpeg->stream_index) ||
-            /* send packet to the decoder */
-            avcodec_send_packet(codec_ctx, pkt))
+        /* the audio takes the same pass, it is neither paced nor dropped */
+        if (p_g->audio_on && pkt->stream_index == p_g->audio.stream_index) {
+            internal_audio_decode(
+                &(p_g->audio), pkt, tl.pts_base, tl.skip_pts_us);
             goto label_continue;
+        }
 
-        if (sirius_que_get(
-            p_g->h_que_free, (size_t *)&avf, 1000) || !(avf))
+        if (pkt->stream_index != p_ffmpeg->stream_index)
             goto label_continue;
-        if (likely(avcodec_receive_frame(codec_ctx, frame) == 0)) {
-            avf->height = sws_scale(
-                sws_ctx, (const uint8_t * const *)(frame->data),
-                frame->linesize, 0, codec_ctx->height,
-                avf->data, avf->linesize);
-            avf->width = p_m->width;
-            avf->format = p_m->fmt;
-            sirius_que_put(p_g->h_que_res, (size_t)avf, 1000);
-        } else {
-            sirius_que_put(p_g->h_que_free, (size_t)avf, 1000);
-        }
+        atomic_fetch_add_explicit(
+            &(p_stats->packet_nr), 1, memory_order_relaxed);
+
+        /* send packet to the decoder */
+        ret = avcodec_send_packet(codec_ctx, pkt);
+        t_ns = i_stage_end(p_g, thd, POLLUX_STAGE_SEND, t_ns, -1);
+        if (ret) goto label_continue;
+        ret = avcodec_receive_frame(codec_ctx, frame);
+        i_stage_end(p_g, thd, POLLUX_STAGE_RECEIVE, t_ns, -1);
+        if (ret) goto label_continue;
+        atomic_fetch_add_explicit(
+            &(p_stats->decode_nr), 1, memory_order_relaxed);
+
+        i_frame_output(p_g, &tl, frame, true);
 
 label_continue:
         av_packet_unref(pkt);
-        clock_gettime(CLOCK_MONOTONIC, &end);
-        elapsed_ms = (end.tv_sec - start.tv_sec) * 1000 + 
-            (end.tv_nsec - start.tv_nsec) / 1000000;
-        sleep_ms = interval_ms - elapsed_ms;
-        if (sleep_ms > 0) usleep(sleep_ms * 1000);
     }
 
     p_thd->state = INTERNAL_THD_STATE_EXITED;
@@ -108,6 +1034,51 @@ label_continue:
 
 label_thd_terminal:
     p_thd->state = INTERNAL_THD_STATE_TERMINATION;
+    /* wake up the pollers, `result_try_get` reports the termination */
+    i_notify_post(p_g, 1);
+    internal_shm_end(&(p_g->shm));
+    return POLLUX_ERR_DECODE_THD_EXIT;
+}
+
+/**
+ * @brief the decoding thread of the segment mode, it delivers the
+ *  frames of the segment threads in order, without pacing
+ */
+static int
+i_segment_deliver_thd(void *args)
+{
+    i_pollux_t *p_g = (i_pollux_t *)args;
+    i_pollux_thd_t *p_thd = &(p_g->thd);
+    internal_seg_t *p_seg = &(p_g->seg);
+
+    AVFrame *frame;
+    i_pollux_timeline_t tl;
+    int ret;
+    i_timeline_reset(&tl, 0, 0);
+    internal_sched_apply(&(p_g->param.sched));
+    for (unsigned int n = 0; n < p_seg->seg_nr; n++) {
+        /* `NULL` at the end of the segment, or once it is stopped */
+        while ((frame = internal_seg_take(p_seg, n))) {
+            i_frame_output(p_g, &tl, frame, false);
+            internal_seg_recycle(p_seg, n, frame);
+        }
+
+        if (p_thd->state != INTERNAL_THD_STATE_RUNNING) {
+            p_thd->state = INTERNAL_THD_STATE_EXITED;
+            return POLLUX_OK;
+        }
+        /* the frames after a broken segment would leave a hole */
+        if ((ret = internal_seg_ret(p_seg, n))) {
+            SIRIUS_ERROR("segment %u: %d\n", n, ret);
+            p_thd->is_failed = true;
+            break;
+        }
+    }
+
+    p_thd->state = INTERNAL_THD_STATE_TERMINATION;
+    /* wake up the pollers, `result_try_get` reports the termination */
+    i_notify_post(p_g, 1);
+    internal_shm_end(&(p_g->shm));
     return POLLUX_ERR_DECODE_THD_EXIT;
 }
 
@@ -132,13 +1103,23 @@ i_frame_cache_free(i_pollux_t *p_g)
     QUE_DEL(p_g->h_que_res);
     QUE_DEL(p_g->h_que_free);
 #undef QUE_DEL
+
+    internal_mbox_deinit(&(p_g->mbox));
+
+    for (unsigned int i = 0; i < POLLUX_RENDITION_MAX; i++) {
+        internal_rend_deinit(&(p_g->rend[i]));
+    }
 }
 
 static int
 i_frame_cache_alloc(i_pollux_t *p_g)
 {
+    if (internal_mbox_init(&(p_g->mbox)))
+        return POLLUX_ERR_RESOURCE_REQUEST;
+
     sirius_que_cr_t cr = {0};
-    cr.elem_nr = INTERNAL_FRAME_NR;
+    /* one more for the `NULL` of `i_decoder_deinit` / `i_consumer_kick` */
+    cr.elem_nr = INTERNAL_FRAME_NR + 1;
     cr.que_type = SIRIUS_QUE_TYPE_MTX;
 #define QUE_CR(q) \
     if (sirius_que_cr(&cr, &(q))) { \
@@ -154,6 +1135,14 @@ i_frame_cache_alloc(i_pollux_t *p_g)
             SIRIUS_ERROR("av_frame_alloc\n");
             goto label_frame_cache_free;
         }
+        /* the index of the cache, the low part of the frame token */
+        p_g->p_frame_nv21[i]->opaque = (void *)(intptr_t)i;
+    }
+
+    /* the queues only, the caches come with the data in `param_set` */
+    for (unsigned int i = 0; i < POLLUX_RENDITION_MAX; i++) {
+        if (internal_rend_init(&(p_g->rend[i])))
+            goto label_frame_cache_free;
     }
 
 #undef QUE_CR
@@ -168,32 +1157,81 @@ label_frame_cache_free:
 static void
 i_frame_data_free(i_pollux_t *p_g)
 {
+    AVFrame *p_f;
     for (unsigned int i = 0; i < INTERNAL_FRAME_NR; i++) {
-        if (p_g->p_frame_nv21[i]->data[0]) {
-            av_freep(&(p_g->p_frame_nv21[i]->data[0]));
+        p_f = p_g->p_frame_nv21[i];
+        if (!(p_f->data[0])) continue;
+
+        if (p_g->frame_ext) {
+            /* the buffer belongs to the caller or to the ring */
+            memset(p_f->data, 0, sizeof(p_f->data));
+        } else {
+            internal_free(&(p_g->frame_alloc), p_f->data[0], p_g->frame_size);
+            memset(p_f->data, 0, sizeof(p_f->data));
         }
     }
+    p_g->frame_ext = false;
+    internal_shm_close(&(p_g->shm));
 
     (void)sirius_que_reset(p_g->h_que_free);
     (void)sirius_que_reset(p_g->h_que_res);
+    (void)internal_mbox_reset(&(p_g->mbox));
+    for (unsigned int i = 0; i < INTERNAL_FRAME_NR; i++) {
+        atomic_store(&(p_g->frame_held[i]), false);
+    }
+    p_g->p_hold = NULL;
+    p_g->hold_nr = 0;
+    i_notify_reset(p_g);
+    atomic_store(&(p_g->drop_nr), 0);
+
+    /* freed before `param_set` changes `rend_nr` */
+    for (unsigned int i = 0; i < p_g->rend_nr; i++) {
+        internal_rend_data_free(&(p_g->rend[i]));
+    }
 }
 
 static int
 i_frame_data_alloc(i_pollux_t *p_g)
 {
     i_frame_data_free(p_g);
+    atomic_fetch_add_explicit(&(p_g->frame_gen), 1, memory_order_release);
 
     AVFrame *p_f;
     internal_ffmpeg_param_t *p_pm = &(p_g->param);
-    for (unsigned int i = 0; i < INTERNAL_FRAME_NR; i++) {
+    unsigned int frame_nr = INTERNAL_FRAME_NR;
+    p_g->frame_alloc = p_pm->allocator;
+    if (p_pm->ext_buf_nr) {
+        frame_nr = p_pm->ext_buf_nr;
+        p_g->frame_ext = true;
+    } else if (p_pm->shm.slot_nr) {
+        if (internal_shm_open(&(p_g->shm), &(p_pm->shm), p_pm->fmt,
+            p_pm->pollux_fmt, p_pm->width, p_pm->height,
+            (int)(p_pm->alignment)))
+            return POLLUX_ERR_RESOURCE_REQUEST;
+        frame_nr = p_pm->shm.slot_nr;
+        p_g->frame_ext = true;
+    }
+    for (unsigned int i = 0; i < frame_nr; i++) {
         p_f = p_g->p_frame_nv21[i];
-        if (0 > av_image_alloc(
-            p_f->data, p_f->linesize,
-            p_pm->width, p_pm->height, p_pm->fmt, p_pm->alignment)) {
-            SIRIUS_ERROR("av_image_alloc\n");
-            goto label_frame_data_free;
+        if (p_g->frame_ext) {
+            if (0 > av_image_fill_arrays(p_f->data, p_f->linesize,
+                (p_g->shm.p_hdr) ? internal_shm_slot_data(&(p_g->shm), i) :
+                    p_pm->p_ext_buf[i],
+                p_pm->fmt, p_pm->width, p_pm->height, p_pm->alignment)) {
+                SIRIUS_ERROR("av_image_fill_arrays\n");
+                goto label_frame_data_free;
+            }
+        } else {
+            /* all of the same size, a failure keeps it for the free */
+            size_t size = internal_alloc_image(&(p_g->frame_alloc),
+                p_f->data, p_f->linesize, p_pm->width, p_pm->height,
+                p_pm->fmt, (int)(p_pm->alignment));
+            if (!(size)) goto label_frame_data_free;
+            p_g->frame_size = size;
         }
 
+        /* the slots of the ring are taken in turn, not from the queue */
+        if (p_g->shm.p_hdr) continue;
         if (sirius_que_put(
             p_g->h_que_free, (size_t)p_f, SIRIUS_QUE_TIMEOUT_NONE)) {
             SIRIUS_ERROR("sirius_que_put\n");
@@ -201,7 +1239,13 @@ i_frame_data_alloc(i_pollux_t *p_g)
         }
     }
 
-    p_pm->stride = p_g->p_frame_nv21[0]->linesize[0];
+    p_pm->stride = internal_fmt_stride(p_pm->fmt,
+        p_pm->width, p_g->p_frame_nv21[0]->linesize[0]);
+
+    for (unsigned int i = 0; i < p_g->rend_nr; i++) {
+        if (internal_rend_data_alloc(&(p_g->rend[i]), &(p_pm->allocator)))
+            goto label_frame_data_free;
+    }
 
     return POLLUX_OK;
 
@@ -210,11 +1254,30 @@ label_frame_data_free:
     return POLLUX_ERR;
 }
 
+static void
+i_audio_close(i_pollux_t *p_g)
+{
+    pthread_mutex_lock(&(p_g->audio_mtx));
+    if (p_g->audio_on) {
+        internal_audio_close(&(p_g->audio));
+        p_g->audio_on = false;
+    }
+    pthread_mutex_unlock(&(p_g->audio_mtx));
+}
+
+static void
+i_seg_close(i_pollux_t *p_g)
+{
+    if (!(p_g->seg_on)) return;
+
+    internal_seg_close(&(p_g->seg));
+    p_g->seg_on = false;
+}
+
 static void
 i_decoder_deinit(i_pollux_t *p_g)
 {
     i_pollux_thd_t *p_thd = &(p_g->thd);
-    int count = 20;
     switch (p_thd->state) {
         case INTERNAL_THD_STATE_INVALID:
             goto label_ffmpeg_free;
@@ -224,19 +1287,30 @@ i_decoder_deinit(i_pollux_t *p_g)
         default:
             goto label_thd_join;
     }
-    while((count--) &&
-        (p_thd->state != INTERNAL_THD_STATE_EXITED)) {
-        usleep(200 * 1000);
-    }
-    if (p_thd->state != INTERNAL_THD_STATE_EXITED) {
-        SIRIUS_WARN("thread[%lu] cancel\n", p_thd->id);
-        pthread_cancel(p_thd->id);
-    }
+    /**
+     * every wait of the decoding thread is cut short, it exits
+     * after the decoding or conversion of at most one frame:
+     * pacing is woken up, the wait for an idle frame cache gets a
+     * `NULL` (the queue has room for it beyond the frame caches),
+     * and blocking input gives up by `i_thd_interrupt`
+     */
+    i_thd_wake(p_g);
+    (void)sirius_que_put(p_g->h_que_free, 0, SIRIUS_QUE_TIMEOUT_NONE);
+    /* the wait for the next frame of the segment threads as well */
+    if (p_g->seg_on) internal_seg_stop(&(p_g->seg));
 
 label_thd_join:
     pthread_join(p_thd->id, NULL);
+    p_thd->state = INTERNAL_THD_STATE_INVALID;
+    internal_kfidx_close(&(p_g->kfidx));
+    i_audio_close(p_g);
+    i_seg_close(p_g);
 
 label_ffmpeg_free:
+    for (unsigned int i = 0; i < p_g->rend_nr; i++) {
+        internal_rend_sws_free(&(p_g->rend[i]));
+    }
+
     internal_ffmpeg_resource_free(&(p_g->ffmpeg));
 
     internal_ffmpeg_deinit(&(p_g->ffmpeg));
@@ -247,24 +1321,69 @@ i_decoder_init(i_pollux_t *p_g)
 {
     internal_ffmpeg_info_t *p_ffmpeg = &(p_g->ffmpeg);
     internal_ffmpeg_param_t *p_param = &(p_g->param);
-    int ret = internal_ffmpeg_init(p_param->src_file_path,
-        AVMEDIA_TYPE_VIDEO, p_ffmpeg);
+    int ret = internal_ffmpeg_init(p_param, AVMEDIA_TYPE_VIDEO, p_ffmpeg);
     if (ret) return ret;
 
     ret = internal_ffmpeg_resource_alloc(p_param, p_ffmpeg);
     if (ret) goto label_ffmpeg_deinit;
 
+    for (unsigned int i = 0; i < p_g->rend_nr; i++) {
+        ret = internal_rend_sws_create(
+            &(p_g->rend[i]), p_ffmpeg->codec_ctx);
+        if (ret) goto label_ffmpeg_resource_free;
+    }
+
+    /* without the index `seek` still works, only less precisely */
+    if (p_param->segment_thd_nr < 2 && internal_kfidx_open(&(p_g->kfidx),
+        p_ffmpeg->fmt_ctx, p_ffmpeg->stream_index,
+        p_param->src_file_path, (p_param->idx_file_path[0]) ?
+            p_param->idx_file_path : NULL)) {
+        SIRIUS_WARN("no keyframe index\n");
+    }
+    atomic_store(&(p_g->seek_pending), false);
+    p_ffmpeg->fmt_ctx->interrupt_callback.callback = i_thd_interrupt;
+    p_ffmpeg->fmt_ctx->interrupt_callback.opaque = (void *)p_g;
+
+    if (p_param->audio.is_enable) {
+        ret = internal_audio_open(&(p_g->audio), &(p_param->audio),
+            p_ffmpeg->fmt_ctx, p_ffmpeg->stream_index);
+        if (ret) {
+            internal_kfidx_close(&(p_g->kfidx));
+            goto label_ffmpeg_resource_free;
+        }
+        pthread_mutex_lock(&(p_g->audio_mtx));
+        p_g->audio_on = true;
+        pthread_mutex_unlock(&(p_g->audio_mtx));
+    }
+
+    internal_stats_reset(&(p_g->stats));
+    internal_shed_reset(&(p_g->shed), &(p_param->shed));
+    if (p_param->segment_thd_nr > 1) {
+        ret = internal_seg_open(&(p_g->seg), p_param, p_ffmpeg,
+            p_param->segment_thd_nr, &(p_g->stats));
+        if (ret) goto label_ffmpeg_resource_free;
+        p_g->seg_on = true;
+    }
+
+    p_g->thd.is_failed = false;
     p_g->thd.state = INTERNAL_THD_STATE_RUNNING;
-    ret = pthread_create(&(p_g->thd.id), NULL,
-        (void *)i_stream_decode_thd, (void *)p_g);
+    ret = pthread_create(&(p_g->thd.id), NULL, (p_g->seg_on) ?
+        (void *)i_segment_deliver_thd : (void *)i_stream_decode_thd,
+        (void *)p_g);
     if (ret) {
         SIRIUS_ERROR("pthread_create: %d\n", ret);
+        internal_kfidx_close(&(p_g->kfidx));
+        i_audio_close(p_g);
+        i_seg_close(p_g);
         goto label_ffmpeg_resource_free;
     }
 
     return POLLUX_OK;
 
 label_ffmpeg_resource_free:
+    for (unsigned int i = 0; i < p_g->rend_nr; i++) {
+        internal_rend_sws_free(&(p_g->rend[i]));
+    }
     internal_ffmpeg_resource_free(p_ffmpeg);
 
 label_ffmpeg_deinit:
@@ -273,8 +1392,65 @@ label_ffmpeg_deinit:
     return POLLUX_ERR;
 }
 
+/**
+ * @brief check the luma pyramid of the results, every level must
+ *  keep at least one pixel
+ */
 static int
-i_decode_param_set(pollux_decode_t *thiz,
+i_pyramid_check(enum AVPixelFormat fmt, unsigned short pyramid_nr,
+    unsigned short width, unsigned short height)
+{
+    if (pyramid_nr < 2) return POLLUX_OK;
+
+    pollux_decode_level_t level[POLLUX_PYRAMID_MAX];
+    if (pyramid_nr > POLLUX_PYRAMID_MAX ||
+        (fmt != AV_PIX_FMT_YUV444P &&
+        fmt != AV_PIX_FMT_NV12 && fmt != AV_PIX_FMT_NV21) ||
+        !(internal_pyramid_layout(level, pyramid_nr,
+            width, height, width, 1))) {
+        SIRIUS_ERROR("pyramid_nr: %hu, fmt: %d, %hux%hu\n",
+            pyramid_nr, fmt, width, height);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+
+    return POLLUX_OK;
+}
+
+/**
+ * @brief check the settings of an additional rendition
+ */
+static int
+i_rend_param_set(internal_rend_param_t *p_rp,
+    const pollux_decode_yuv_t *p_yuv)
+{
+    if (!(internal_fmt_convert(p_yuv->fmt, &(p_rp->fmt))))
+        return POLLUX_ERR_INVALID_PARAMETER;
+
+    if (i_pyramid_check(p_rp->fmt, p_yuv->pyramid_nr,
+        p_yuv->width, p_yuv->height))
+        return POLLUX_ERR_INVALID_PARAMETER;
+
+    p_rp->pollux_fmt = p_yuv->fmt;
+    p_rp->pyramid_nr = p_yuv->pyramid_nr;
+    internal_fmt_norm_set(&(p_rp->norm), p_yuv->mean, p_yuv->std);
+    p_rp->width = p_yuv->width;
+    p_rp->height = p_yuv->height;
+    p_rp->alignment = p_yuv->alignment;
+
+    /* `stride` of the results is an `unsigned short` */
+    unsigned int stride = internal_fmt_stride_of(
+        p_rp->fmt, p_rp->width, (int)(p_rp->alignment));
+    if (!(stride) || stride > USHRT_MAX) {
+        SIRIUS_ERROR("width: %hu, fmt: %d, stride: %u\n",
+            p_yuv->width, p_yuv->fmt, stride);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+
+    return POLLUX_OK;
+}
+
+static int
+i_decode_param_set(pollux_decode_t *thiz,
     const pollux_decode_param_t *p_param)
 {
     if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
@@ -282,9 +1458,12 @@ i_decode_param_set(pollux_decode_t *thiz,
     if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
 
     int ret = POLLUX_OK;
+    i_consumer_kick(p_g);
     pthread_mutex_lock(&(p_g->mtx));
+    i_rend_lock(p_g);
     if (p_g->param_set_flag) {
         i_decoder_deinit(p_g);
+        i_frame_data_free(p_g);
         p_g->param_set_flag = false;
     }
 
@@ -294,14 +1473,143 @@ i_decode_param_set(pollux_decode_t *thiz,
         ret = POLLUX_ERR_INVALID_PARAMETER;
         goto label_mtx_unlock;
     }
+    if (p_param->delivery < 0 ||
+        p_param->delivery >= POLLUX_DELIVERY_MAX ||
+        p_param->drop < 0 || p_param->drop >= POLLUX_DROP_MAX) {
+        SIRIUS_ERROR("delivery: %d, drop: %d\n",
+            p_param->delivery, p_param->drop);
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
 
     p_pm->fps = p_param->fps;
     p_pm->is_loop = p_param->is_loop;
+    p_pm->pollux_fmt = p_param->yuv.fmt;
+    p_pm->pyramid_nr = p_param->yuv.pyramid_nr;
+    ret = i_pyramid_check(p_pm->fmt, p_pm->pyramid_nr,
+        p_param->yuv.width, p_param->yuv.height);
+    if (ret) goto label_mtx_unlock;
+    internal_fmt_norm_set(&(p_pm->norm),
+        p_param->yuv.mean, p_param->yuv.std);
+    p_pm->delivery = p_param->delivery;
+    p_pm->drop = p_param->drop;
+    p_pm->on_frame = p_param->on_frame;
+    p_pm->p_user = p_param->p_user;
+    if (p_param->ext_buf.nr > POLLUX_FRAME_NR_MAX ||
+        (p_param->ext_buf.nr && !(p_param->ext_buf.pp_buf))) {
+        SIRIUS_ERROR("ext_buf nr: %u\n", p_param->ext_buf.nr);
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
+    if (p_param->shm.slot_nr == 1 ||
+        p_param->shm.slot_nr > POLLUX_FRAME_NR_MAX ||
+        (p_param->shm.slot_nr &&
+        (p_param->on_frame || p_param->ext_buf.nr))) {
+        SIRIUS_ERROR("shm slot_nr: %u\n", p_param->shm.slot_nr);
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
+    if (!(internal_fmt_is_direct(p_pm->fmt)) && (p_param->on_frame ||
+        p_param->ext_buf.nr || p_param->shm.slot_nr)) {
+        SIRIUS_ERROR("the frame caches of fmt [%d] can not be exposed\n",
+            p_param->yuv.fmt);
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
+    if (!(p_param->allocator.alloc) != !(p_param->allocator.free)) {
+        SIRIUS_ERROR("allocator: alloc and free go together\n");
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
+    if (p_param->page >= POLLUX_PAGE_MAX) {
+        SIRIUS_ERROR("page: %d\n", p_param->page);
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
+    p_pm->ext_buf_nr = p_param->ext_buf.nr;
+    p_pm->shm.slot_nr = p_param->shm.slot_nr;
+    snprintf(p_pm->shm.name, sizeof(p_pm->shm.name), "%s",
+        (p_param->shm.p_name) ? p_param->shm.p_name : "pollux");
+    for (unsigned int i = 0; i < p_pm->ext_buf_nr; i++) {
+        if (!(p_pm->p_ext_buf[i] = p_param->ext_buf.pp_buf[i])) {
+            ret = POLLUX_ERR_INVALID_PARAMETER;
+            goto label_mtx_unlock;
+        }
+    }
     p_pm->width = p_param->yuv.width;
     p_pm->height = p_param->yuv.height;
     p_pm->alignment = p_param->yuv.alignment;
+    /* `stride` of the results is an `unsigned short` */
+    unsigned int stride = internal_fmt_stride_of(
+        p_pm->fmt, p_pm->width, (int)(p_pm->alignment));
+    if (!(stride) || stride > USHRT_MAX) {
+        SIRIUS_ERROR("width: %hu, fmt: %d, stride: %u\n",
+            p_param->yuv.width, p_param->yuv.fmt, stride);
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
+
+    p_g->rend_nr = 0;
+    if (p_param->rendition_nr > POLLUX_RENDITION_MAX ||
+        (p_param->rendition_nr && !(p_param->p_rendition))) {
+        SIRIUS_ERROR("rendition_nr: %u\n", p_param->rendition_nr);
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
+    for (unsigned int i = 0; i < p_param->rendition_nr; i++) {
+        ret = i_rend_param_set(
+            &(p_g->rend[i].param), &(p_param->p_rendition[i]));
+        if (ret) goto label_mtx_unlock;
+    }
+    p_g->rend_nr = p_param->rendition_nr;
     strncpy(p_pm->src_file_path, p_param->p_file,
         sizeof(p_pm->src_file_path) - 1);
+    p_pm->idx_file_path[0] = '\0';
+    if (p_param->p_index_file) {
+        strncpy(p_pm->idx_file_path, p_param->p_index_file,
+            sizeof(p_pm->idx_file_path) - 1);
+    }
+    p_pm->trace_file_path[0] = '\0';
+    if (p_param->p_trace_file) {
+        strncpy(p_pm->trace_file_path, p_param->p_trace_file,
+            sizeof(p_pm->trace_file_path) - 1);
+    }
+    p_pm->stream_index =
+        (p_param->is_stream_index) ? (int)(p_param->stream_index) : -1;
+    p_pm->discard_off = p_param->is_discard_off;
+    if (p_param->audio.is_enable && (p_param->audio.fmt < 0 ||
+        p_param->audio.fmt >= POLLUX_SAMPLE_FMT_MAX)) {
+        SIRIUS_ERROR("audio fmt: %d\n", p_param->audio.fmt);
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
+    p_pm->audio.is_enable = p_param->audio.is_enable;
+    p_pm->audio.sample_rate = p_param->audio.sample_rate;
+    p_pm->audio.channels = p_param->audio.channels;
+    p_pm->audio.fmt = p_param->audio.fmt;
+    ret = internal_sched_param_set(&(p_pm->sched), &(p_param->sched));
+    if (ret) goto label_mtx_unlock;
+    /* the caches of the node are bound before they are faulted in */
+    internal_alloc_set(&(p_pm->allocator),
+        &(p_param->allocator), p_param->page, p_pm->sched.node);
+    /* the high classes keep their quality, the others yield instead */
+    p_pm->shed.is_enable = p_param->shed.is_enable &&
+        p_pm->sched.priority != POLLUX_PRIORITY_HIGH &&
+        p_pm->sched.priority != POLLUX_PRIORITY_REALTIME;
+    p_pm->shed.late_us = (p_param->shed.late_ms) ?
+        (int64_t)(p_param->shed.late_ms) * 1000 : INTERNAL_SHED_LATE_US;
+    p_pm->segment_thd_nr = p_param->segment_thd_nr;
+    if (p_pm->segment_thd_nr > POLLUX_SEGMENT_THD_MAX ||
+        (p_pm->segment_thd_nr > 1 &&
+        (p_param->is_loop || p_param->audio.is_enable))) {
+        SIRIUS_ERROR("segment_thd_nr: %hu, is_loop: %hu, audio: %hu\n",
+            p_param->segment_thd_nr, p_param->is_loop,
+            p_param->audio.is_enable);
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
+    p_pm->probesize = p_param->probesize;
+    p_pm->analyzeduration = p_param->analyzeduration;
 
     ret = i_frame_data_alloc(p_g);
     if (ret) goto label_mtx_unlock;
@@ -315,6 +1623,8 @@ i_decode_param_set(pollux_decode_t *thiz,
     p_g->param_set_flag = true;
 
 label_mtx_unlock:
+    i_consumer_unkick(p_g);
+    i_rend_unlock(p_g);
     pthread_mutex_unlock(&(p_g->mtx));
 
     return ret;
@@ -327,21 +1637,101 @@ i_decode_release(pollux_decode_t *thiz)
     i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
     if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
 
+    i_consumer_kick(p_g);
     pthread_mutex_lock(&(p_g->mtx));
+    i_rend_lock(p_g);
 
     if (!(p_g->param_set_flag)) {
         goto label_mtx_unlock;
     }
 
     i_decoder_deinit(p_g);
+    p_g->param_set_flag = false;
+
+    /* every writer has stopped, the timeline is complete */
+    if (p_g->param.trace_file_path[0] &&
+        internal_trace_dump(&(p_g->trace),
+            p_g->param.trace_file_path) == POLLUX_OK) {
+        internal_trace_reset(&(p_g->trace));
+    }
 
     i_frame_data_free(p_g);
 
 label_mtx_unlock:
+    i_consumer_unkick(p_g);
+    i_rend_unlock(p_g);
     pthread_mutex_unlock(&(p_g->mtx));
     return POLLUX_OK;
 }
 
+/**
+ * @brief copy a converted frame into the result
+ */
+static int
+i_result_fill(pollux_decode_result_t *p_res, const AVFrame *avf,
+    const internal_frame_meta_t *p_meta,
+    const internal_fmt_norm_t *p_norm, unsigned short pyramid_nr)
+{
+    p_res->width = avf->width;
+    p_res->height = avf->height;
+    p_res->stride = internal_fmt_stride(avf->format,
+        avf->width, avf->linesize[0]);
+    p_res->pts_us = p_meta->pts_us;
+    p_res->frame_idx = p_meta->frame_idx;
+
+    int ret = internal_fmt_img_result(p_res, avf, avf->format, p_norm);
+    p_res->level_nr = 0;
+    /* `param_set` has checked the size, the layout fails on a corrupt frame */
+    if (ret == POLLUX_OK && pyramid_nr > 1 &&
+        internal_pyramid_layout(p_res->level, pyramid_nr,
+            p_res->width, p_res->height, p_res->stride,
+            internal_fmt_size(avf->format,
+                p_res->stride, p_res->height))) {
+        p_res->level_nr = pyramid_nr;
+        internal_pyramid_build(p_res->buf, p_res->level, p_res->level_nr);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief get result, `p_g->mtx` must be held by the caller
+ * 
+ * @param[in] timeout_ms: the maximum time to wait for a frame
+ */
+static int
+i_result_get(i_pollux_t *p_g,
+    pollux_decode_result_t *p_res, unsigned int timeout_ms)
+{
+    if (!(p_g->param_set_flag)) return POLLUX_ERR_NOT_INIT;
+    if (p_g->param.on_frame || p_g->shm.p_hdr)
+        return POLLUX_ERR_UNSUPPORTED;
+
+    switch (p_g->thd.state) {
+        case INTERNAL_THD_STATE_TERMINATION:
+            SIRIUS_DEBG(
+                "the decode thread has terminated\n");
+            return i_thd_end_ret(p_g);
+        default: break;
+    }
+
+    AVFrame *frame_nv21 = i_tick_take(p_g, timeout_ms);
+    if (!(frame_nv21)) {
+        return (timeout_ms) ?
+            POLLUX_ERR_RESOURCE_REQUEST : POLLUX_ERR_AGAIN;
+    }
+
+    int64_t t_ns = internal_stats_now_ns();
+    int ret = i_result_fill(p_res, frame_nv21, i_frame_meta(p_g, frame_nv21),
+        &(p_g->param.norm), p_g->param.pyramid_nr);
+    i_stage_end(p_g, INTERNAL_TRACE_THD_CONSUMER,
+        POLLUX_STAGE_COPY, t_ns, p_res->frame_idx);
+
+    i_tick_done(p_g, frame_nv21);
+
+    return ret;
+}
+
 static int
 i_decode_result_get(pollux_decode_t *thiz,
     pollux_decode_result_t *p_res)
@@ -352,55 +1742,459 @@ i_decode_result_get(pollux_decode_t *thiz,
     if (!(p_res) || !(p_res->buf))
         return POLLUX_ERR_NULL_POINTER;
 
-    int ret = POLLUX_OK;
     pthread_mutex_lock(&(p_g->mtx));
+    int ret = i_result_get(p_g, p_res, 1000);
+    pthread_mutex_unlock(&(p_g->mtx));
+
+    return ret;
+}
+
+static int
+i_decode_result_try_get(pollux_decode_t *thiz,
+    pollux_decode_result_t *p_res)
+{
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+    if (!(p_res) || !(p_res->buf))
+        return POLLUX_ERR_NULL_POINTER;
+
+    if (pthread_mutex_trylock(&(p_g->mtx))) return POLLUX_ERR_AGAIN;
+    int ret = i_result_get(p_g, p_res, 0);
+    pthread_mutex_unlock(&(p_g->mtx));
+
+    return ret;
+}
+
+static int
+i_decode_audio_get(pollux_decode_t *thiz,
+    pollux_decode_audio_result_t *p_res)
+{
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+    if (!(p_res)) return POLLUX_ERR_NULL_POINTER;
+
+    int ret;
+    pthread_mutex_lock(&(p_g->audio_mtx));
+    if (!(p_g->audio_on)) {
+        ret = POLLUX_ERR_UNSUPPORTED;
+        goto label_mtx_unlock;
+    }
+
+    /* the state is read first, the chunks published before it count */
+    bool is_terminated = p_g->thd.state == INTERNAL_THD_STATE_TERMINATION;
+    ret = internal_audio_take(&(p_g->audio), p_res);
+    if (ret == POLLUX_ERR_AGAIN && is_terminated) {
+        ret = i_thd_end_ret(p_g);
+    }
+
+label_mtx_unlock:
+    pthread_mutex_unlock(&(p_g->audio_mtx));
+    return ret;
+}
+
+static int
+i_decode_result_rendition_get(pollux_decode_t *thiz,
+    unsigned int index, pollux_decode_result_t *p_res)
+{
+    if (index == 0) return i_decode_result_get(thiz, p_res);
+
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+    if (!(p_res) || !(p_res->buf))
+        return POLLUX_ERR_NULL_POINTER;
+    if (index > POLLUX_RENDITION_MAX) return POLLUX_ERR_INVALID_PARAMETER;
+
+    /**
+     * not `p_g->mtx`, the wait for the frame must not hold up the
+     * other outputs; `param_set` and `release` take this one as well
+     */
+    int ret = POLLUX_OK;
+    internal_rend_t *p_rend = &(p_g->rend[index - 1]);
+    pthread_mutex_lock(&(p_rend->mtx));
     if (!(p_g->param_set_flag)) {
         ret = POLLUX_ERR_NOT_INIT;
         goto label_mtx_unlock;
     }
+    if (index > p_g->rend_nr) {
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
 
     switch (p_g->thd.state) {
         case INTERNAL_THD_STATE_TERMINATION:
             SIRIUS_DEBG(
                 "the decode thread has terminated\n");
-            ret = (p_g->param.is_loop) ?
-                POLLUX_ERR_DECODE_THD_EXIT :
-                POLLUX_ERR_FILE_END;
+            ret = i_thd_end_ret(p_g);
             goto label_mtx_unlock;
         default: break;
     }
 
-    AVFrame *frame_nv21 = NULL;
-    ret = sirius_que_get(
-        p_g->h_que_res, (size_t *)&frame_nv21, 1000);
-    if (ret || !(frame_nv21)) {
+    AVFrame *avf = internal_rend_take(p_rend,
+        atomic_load_explicit(&(p_g->closing), memory_order_relaxed) ?
+            0 : 1000);
+    if (!(avf)) {
         ret = POLLUX_ERR_RESOURCE_REQUEST;
         goto label_mtx_unlock;
     }
 
-    p_res->width = frame_nv21->width;
-    p_res->height = frame_nv21->height;
-    p_res->stride = frame_nv21->linesize[0];
+    int64_t t_ns = internal_stats_now_ns();
+    ret = i_result_fill(p_res, avf, internal_rend_meta(p_rend, avf),
+        &(p_rend->param.norm), p_rend->param.pyramid_nr);
+    i_stage_end(p_g, INTERNAL_TRACE_THD_RENDITION + index - 1,
+        POLLUX_STAGE_COPY, t_ns, p_res->frame_idx);
 
-    ret = internal_fmt_img_result(
-        p_res, frame_nv21, frame_nv21->format);
+    internal_rend_recycle(p_rend, avf);
 
-    if (sirius_que_put(p_g->h_que_free, (size_t)frame_nv21,
-        SIRIUS_QUE_TIMEOUT_NONE)) {
-        SIRIUS_WARN("sirius_que_put\n");
+label_mtx_unlock:
+    pthread_mutex_unlock(&(p_rend->mtx));
+    return ret;
+}
+
+static int
+i_decode_seek(pollux_decode_t *thiz,
+    long long target, pollux_seek_t mode)
+{
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+    if (mode < 0 || mode >= POLLUX_SEEK_MAX || target < 0)
+        return POLLUX_ERR_INVALID_PARAMETER;
+
+    int ret = POLLUX_OK;
+    pthread_mutex_lock(&(p_g->mtx));
+    if (!(p_g->param_set_flag)) {
+        ret = POLLUX_ERR_NOT_INIT;
+        goto label_mtx_unlock;
+    }
+    if (p_g->seg_on) {
+        ret = POLLUX_ERR_UNSUPPORTED;
+        goto label_mtx_unlock;
+    }
+    switch (p_g->thd.state) {
+        case INTERNAL_THD_STATE_TERMINATION:
+            ret = i_thd_end_ret(p_g);
+            goto label_mtx_unlock;
+        default: break;
     }
 
+    /* the repeats of the held frame belong to the old position */
+    if (p_g->p_hold) {
+        i_notify_consume(p_g, p_g->hold_nr);
+        sirius_que_put(p_g->h_que_free,
+            (size_t)(p_g->p_hold), SIRIUS_QUE_TIMEOUT_NONE);
+        p_g->p_hold = NULL;
+    }
+
+    pthread_mutex_lock(&(p_g->seek_mtx));
+    p_g->seek_target = target;
+    p_g->seek_mode = mode;
+    atomic_store_explicit(&(p_g->seek_pending), true, memory_order_release);
+    /* free the caches, a decoding thread waiting for one moves on */
+    i_frame_flush(p_g);
+    i_thd_wake(p_g);
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += 2;
+    while (atomic_load(&(p_g->seek_pending))) {
+        if (pthread_cond_timedwait(
+            &(p_g->seek_cond), &(p_g->seek_mtx), &ts)) break;
+    }
+    if (atomic_load(&(p_g->seek_pending))) {
+        SIRIUS_WARN("the decoding thread does not respond\n");
+        atomic_store(&(p_g->seek_pending), false);
+        ret = POLLUX_ERR_TIMEOUT;
+    } else {
+        ret = p_g->seek_ret;
+    }
+    pthread_mutex_unlock(&(p_g->seek_mtx));
+
 label_mtx_unlock:
     pthread_mutex_unlock(&(p_g->mtx));
     return ret;
 }
 
+/**
+ * @brief the size of one frame of the batch
+ */
+static size_t
+i_batch_frame_size(i_pollux_t *p_g, pollux_layout_t layout)
+{
+    internal_ffmpeg_param_t *p_pm = &(p_g->param);
+    if (layout == POLLUX_LAYOUT_PACKED) {
+        return internal_fmt_packed_size(
+            p_pm->fmt, p_pm->width, p_pm->height);
+    }
+
+    return internal_fmt_size(p_pm->fmt, p_pm->stride, p_pm->height);
+}
+
+static int
+i_decode_result_get_batch(pollux_decode_t *thiz,
+    unsigned int n, pollux_decode_batch_t *p_batch,
+    unsigned int timeout_ms)
+{
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+    if (!(p_batch) || !(p_batch->buf) || !(p_batch->p_meta))
+        return POLLUX_ERR_NULL_POINTER;
+    if (n > p_batch->frame_nr) n = p_batch->frame_nr;
+
+    int ret = POLLUX_OK;
+    unsigned int nr = 0;
+    pthread_mutex_lock(&(p_g->mtx));
+    if (!(p_g->param_set_flag)) {
+        ret = POLLUX_ERR_NOT_INIT;
+        goto label_mtx_unlock;
+    }
+    if (p_g->param.on_frame || p_g->shm.p_hdr) {
+        ret = POLLUX_ERR_UNSUPPORTED;
+        goto label_mtx_unlock;
+    }
+
+    size_t frame_size = i_batch_frame_size(p_g, p_batch->layout);
+    if (frame_size == 0) {
+        ret = POLLUX_ERR_UNSUPPORTED;
+        goto label_mtx_unlock;
+    }
+    if (frame_size > p_batch->frame_size) {
+        SIRIUS_ERROR("the batch does not comply with the parameters\n");
+        ret = POLLUX_ERR_CACHE_OVERFLOW;
+        goto label_mtx_unlock;
+    }
+
+    AVFrame *avf;
+    pollux_decode_meta_t *p_meta;
+    int64_t t_ns;
+    while (nr < n) {
+        /* only the first frame is waited for */
+        if (!(avf = i_tick_take(p_g, nr ? 0 : timeout_ms))) break;
+
+        t_ns = internal_stats_now_ns();
+        ret = internal_fmt_img_copy(
+            p_batch->buf + nr * p_batch->frame_size,
+            avf, avf->format, p_batch->layout, &(p_g->param.norm));
+        i_stage_end(p_g, INTERNAL_TRACE_THD_CONSUMER,
+            POLLUX_STAGE_COPY, t_ns,
+            (int64_t)(i_frame_meta(p_g, avf)->frame_idx));
+        if (likely(ret == POLLUX_OK)) {
+            p_meta = &(p_batch->p_meta[nr++]);
+            p_meta->width = avf->width;
+            p_meta->height = avf->height;
+            p_meta->stride = (p_batch->layout == POLLUX_LAYOUT_PACKED) ?
+                internal_fmt_packed_size(avf->format, avf->width, 1) :
+                internal_fmt_stride(
+                    avf->format, avf->width, avf->linesize[0]);
+            p_meta->fmt = p_g->param.pollux_fmt;
+            p_meta->pts_us = i_frame_meta(p_g, avf)->pts_us;
+            p_meta->frame_idx = i_frame_meta(p_g, avf)->frame_idx;
+        }
+
+        i_tick_done(p_g, avf);
+        if (ret) break;
+    }
+
+    if (nr) {
+        ret = (int)nr;
+    } else if (ret == POLLUX_OK) {
+        switch (p_g->thd.state) {
+            case INTERNAL_THD_STATE_TERMINATION:
+                ret = i_thd_end_ret(p_g);
+                break;
+            default:
+                ret = POLLUX_ERR_AGAIN;
+                break;
+        }
+    }
+
+label_mtx_unlock:
+    pthread_mutex_unlock(&(p_g->mtx));
+    return ret;
+}
+
+static int
+i_decode_result_borrow(pollux_decode_t *thiz,
+    pollux_decode_frame_view_t *p_view, unsigned int timeout_ms)
+{
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+    if (!(p_view)) return POLLUX_ERR_NULL_POINTER;
+
+    int ret = POLLUX_OK;
+    pthread_mutex_lock(&(p_g->mtx));
+    if (!(p_g->param_set_flag)) {
+        ret = POLLUX_ERR_NOT_INIT;
+        goto label_mtx_unlock;
+    }
+    if (p_g->param.on_frame || p_g->shm.p_hdr ||
+        !(internal_fmt_is_direct(p_g->param.fmt))) {
+        ret = POLLUX_ERR_UNSUPPORTED;
+        goto label_mtx_unlock;
+    }
+
+    /* a repeated frame is borrowed only once, refer to `repeat_nr` */
+    AVFrame *avf = p_g->p_hold;
+    if (avf) {
+        i_notify_consume(p_g, p_g->hold_nr);
+        i_frame_meta(p_g, avf)->repeat_nr = p_g->hold_nr;
+        p_g->p_hold = NULL;
+    } else if ((avf = i_frame_take(p_g, timeout_ms))) {
+        i_notify_consume(p_g, i_frame_meta(p_g, avf)->repeat_nr - 1);
+    }
+    if (!(avf)) {
+        switch (p_g->thd.state) {
+            case INTERNAL_THD_STATE_TERMINATION:
+                ret = i_thd_end_ret(p_g);
+                break;
+            default:
+                ret = POLLUX_ERR_AGAIN;
+                break;
+        }
+        goto label_mtx_unlock;
+    }
+
+    memset(p_view, 0, sizeof(pollux_decode_frame_view_t));
+    p_view->width = avf->width;
+    p_view->height = avf->height;
+    p_view->fmt = p_g->param.pollux_fmt;
+    for (unsigned int i = 0; i < 4; i++) {
+        p_view->data[i] = avf->data[i];
+        p_view->linesize[i] = avf->linesize[i];
+    }
+    p_view->index = (unsigned int)(intptr_t)(avf->opaque);
+    p_view->token = i_frame_token(p_g, avf);
+    i_frame_hold(p_g, avf);
+    p_view->pts_us = i_frame_meta(p_g, avf)->pts_us;
+    p_view->frame_idx = i_frame_meta(p_g, avf)->frame_idx;
+    p_view->repeat_nr = i_frame_meta(p_g, avf)->repeat_nr;
+
+label_mtx_unlock:
+    pthread_mutex_unlock(&(p_g->mtx));
+    return ret;
+}
+
+static int
+i_decode_event_fd_get(pollux_decode_t *thiz, int *p_fd)
+{
+    if (!(thiz) || !(p_fd)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+
+    *p_fd = p_g->evt_fd;
+    return POLLUX_OK;
+}
+
+static int
+i_decode_shm_fd_get(pollux_decode_t *thiz, int *p_fd)
+{
+    if (!(thiz) || !(p_fd)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+
+    int ret = POLLUX_OK;
+    pthread_mutex_lock(&(p_g->mtx));
+    if (!(p_g->param_set_flag)) {
+        ret = POLLUX_ERR_NOT_INIT;
+    } else if (!(p_g->shm.p_hdr)) {
+        ret = POLLUX_ERR_UNSUPPORTED;
+    } else {
+        *p_fd = p_g->shm.fd;
+    }
+    pthread_mutex_unlock(&(p_g->mtx));
+
+    return ret;
+}
+
+static int
+i_decode_drop_nr_get(pollux_decode_t *thiz,
+    unsigned long long *p_nr)
+{
+    if (!(thiz) || !(p_nr)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+
+    *p_nr = atomic_load_explicit(&(p_g->drop_nr), memory_order_relaxed);
+    return POLLUX_OK;
+}
+
+static int
+i_decode_stats_get(pollux_decode_t *thiz,
+    pollux_decode_stats_t *p_stats)
+{
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+    if (!(p_stats)) return POLLUX_ERR_NULL_POINTER;
+
+    /* no lock, a snapshot of relaxed counters is good enough */
+    memset(p_stats, 0, sizeof(pollux_decode_stats_t));
+    internal_stats_get(&(p_g->stats), p_stats);
+    p_stats->drop_nr = atomic_load_explicit(
+        &(p_g->drop_nr), memory_order_relaxed);
+    p_stats->ready_nr = atomic_load_explicit(
+        &(p_g->ready_nr), memory_order_relaxed);
+    p_stats->shed_level = internal_shed_level(&(p_g->shed));
+    p_stats->late_us = atomic_load_explicit(
+        &(p_g->shed.late_avg_us), memory_order_relaxed);
+
+    return POLLUX_OK;
+}
+
+static int
+i_decode_trace_dump(pollux_decode_t *thiz, const char *p_file)
+{
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+    if (!(p_file)) return POLLUX_ERR_NULL_POINTER;
+
+    return internal_trace_dump(&(p_g->trace), p_file);
+}
+
+static int
+i_decode_frame_release(pollux_decode_t *thiz, int token)
+{
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(thiz->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+
+    /**
+     * `p_g->mtx` is not taken, the callback may call this function
+     * while `param_set` is waiting for the decoding thread
+     */
+    AVFrame *avf = (token >= 0) ?
+        p_g->p_frame_nv21[token % INTERNAL_FRAME_NR] : NULL;
+    if (!(avf) || i_frame_token(p_g, avf) != token) {
+        SIRIUS_WARN("stale frame token: %d\n", token);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+    /* released already, a second put would hand it out twice */
+    if (!(i_frame_unhold(p_g, avf))) {
+        SIRIUS_WARN("frame token not held: %d\n", token);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+
+    if (sirius_que_put(p_g->h_que_free,
+        (size_t)avf, SIRIUS_QUE_TIMEOUT_NONE)) {
+        SIRIUS_WARN("sirius_que_put\n");
+        return POLLUX_ERR;
+    }
+
+    return POLLUX_OK;
+}
+
 void
 pollux_decode_result_free(pollux_decode_result_t *p_result)
 {
     if (p_result) {
         if (p_result->buf) {
-            free(p_result->buf);
+            internal_free(&(p_result->allocator),
+                p_result->buf, p_result->buf_size);
             p_result->buf = NULL;
         }
 
@@ -411,6 +2205,13 @@ pollux_decode_result_free(pollux_decode_result_t *p_result)
 int
 pollux_decode_result_alloc(pollux_decode_t *p_handle,
     pollux_decode_result_t **pp_ressult)
+{
+    return pollux_decode_result_rendition_alloc(p_handle, 0, pp_ressult);
+}
+
+int
+pollux_decode_result_rendition_alloc(pollux_decode_t *p_handle,
+    unsigned int index, pollux_decode_result_t **pp_ressult)
 {
     if (!(pp_ressult)) return POLLUX_ERR_INVALID_ENTRY;
     if (!(p_handle)) return POLLUX_ERR_INVALID_ENTRY;
@@ -423,11 +2224,37 @@ pollux_decode_result_alloc(pollux_decode_t *p_handle,
         pthread_mutex_unlock(&(p_g->mtx));
         return POLLUX_ERR_NOT_INIT;
     }
+    if (index > p_g->rend_nr) {
+        pthread_mutex_unlock(&(p_g->mtx));
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+
+    enum AVPixelFormat fmt;
+    unsigned short width, height, stride, pyramid_nr;
+    pollux_allocator_t allocator = p_g->param.allocator;
+    if (index) {
+        internal_rend_param_t *p_rp = &(p_g->rend[index - 1].param);
+        fmt = p_rp->fmt;
+        width = p_rp->width;
+        height = p_rp->height;
+        stride = p_rp->stride;
+        pyramid_nr = p_rp->pyramid_nr;
+    } else {
+        internal_ffmpeg_param_t *p_pm = &(p_g->param);
+        fmt = p_pm->fmt;
+        width = p_pm->width;
+        height = p_pm->height;
+        stride = p_pm->stride;
+        pyramid_nr = p_pm->pyramid_nr;
+    }
     pthread_mutex_unlock(&(p_g->mtx));
 
-    internal_ffmpeg_param_t *p_pm = &(p_g->param);
-    unsigned int buf_size =
-        internal_fmt_size(p_pm->fmt, p_pm->stride, p_pm->height);
+    unsigned int buf_size = internal_fmt_size(fmt, stride, height);
+    if (buf_size && pyramid_nr > 1) {
+        pollux_decode_level_t level[POLLUX_PYRAMID_MAX];
+        buf_size = internal_pyramid_layout(level, pyramid_nr,
+            width, height, stride, buf_size);
+    }
     if (buf_size == 0) {
         return POLLUX_ERR_INVALID_PARAMETER;
     }
@@ -439,13 +2266,18 @@ pollux_decode_result_alloc(pollux_decode_t *p_handle,
         return POLLUX_ERR_MEMORY_ALLOC;
     }
 
-    p_res->buf = (unsigned char *)calloc(1, buf_size);
+    p_res->buf = (unsigned char *)internal_alloc(&allocator, buf_size, 0);
     if (!(p_res->buf)) {
-        SIRIUS_ERROR("calloc\n");
+        SIRIUS_ERROR("alloc: %u\n", buf_size);
         free(p_res);
         return POLLUX_ERR_MEMORY_ALLOC;
     } else {
-        p_res->stride = p_pm->stride;
+        /* the padding must not leak, the fresh pages are zeroed already */
+        if (!(internal_alloc_is_zeroed(&allocator, buf_size)))
+            memset(p_res->buf, 0, buf_size);
+        p_res->stride = stride;
+        p_res->buf_size = buf_size;
+        p_res->allocator = allocator;
     }
 
     *pp_ressult = p_res;
@@ -453,6 +2285,118 @@ pollux_decode_result_alloc(pollux_decode_t *p_handle,
     return POLLUX_OK;
 }
 
+int
+pollux_decode_buf_size(const pollux_decode_yuv_t *p_yuv,
+    size_t *p_size)
+{
+    if (!(p_yuv) || !(p_size)) return POLLUX_ERR_INVALID_ENTRY;
+
+    enum AVPixelFormat fmt;
+    if (!(internal_fmt_convert(p_yuv->fmt, &fmt)))
+        return POLLUX_ERR_INVALID_PARAMETER;
+
+    int size = av_image_get_buffer_size(
+        fmt, p_yuv->width, p_yuv->height, p_yuv->alignment);
+    if (size < 0) return POLLUX_ERR_INVALID_PARAMETER;
+
+    *p_size = (size_t)size;
+    return POLLUX_OK;
+}
+
+void
+pollux_decode_batch_free(pollux_decode_batch_t *p_batch)
+{
+    if (p_batch) {
+        internal_free(&(p_batch->allocator), p_batch->buf,
+            p_batch->frame_nr * p_batch->frame_size);
+        free(p_batch->p_meta);
+        free(p_batch);
+    }
+}
+
+int
+pollux_decode_batch_alloc(pollux_decode_t *p_handle,
+    unsigned int frame_nr, pollux_layout_t layout,
+    pollux_decode_batch_t **pp_batch)
+{
+    if (!(pp_batch) || !(frame_nr)) return POLLUX_ERR_INVALID_ENTRY;
+    if (layout < 0 || layout >= POLLUX_LAYOUT_MAX)
+        return POLLUX_ERR_INVALID_ENTRY;
+    if (!(p_handle)) return POLLUX_ERR_INVALID_ENTRY;
+    i_pollux_t *p_g = (i_pollux_t *)(p_handle->priv_data);
+    if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
+
+    pthread_mutex_lock(&(p_g->mtx));
+    if (!(p_g->param_set_flag)) {
+        SIRIUS_WARN("no valid parameter is configured\n");
+        pthread_mutex_unlock(&(p_g->mtx));
+        return POLLUX_ERR_NOT_INIT;
+    }
+    size_t frame_size = i_batch_frame_size(p_g, layout);
+    pollux_allocator_t allocator = p_g->param.allocator;
+    pthread_mutex_unlock(&(p_g->mtx));
+    if (frame_size == 0) return POLLUX_ERR_UNSUPPORTED;
+
+    pollux_decode_batch_t *p_batch = (pollux_decode_batch_t *)
+        calloc(1, sizeof(pollux_decode_batch_t));
+    if (!(p_batch)) {
+        SIRIUS_ERROR("calloc\n");
+        return POLLUX_ERR_MEMORY_ALLOC;
+    }
+
+    /* the sizes are set first, `pollux_decode_batch_free` needs them */
+    p_batch->frame_nr = frame_nr;
+    p_batch->layout = layout;
+    p_batch->frame_size = frame_size;
+    p_batch->allocator = allocator;
+    p_batch->buf = (unsigned char *)
+        internal_alloc(&allocator, frame_nr * frame_size, 0);
+    p_batch->p_meta = (pollux_decode_meta_t *)
+        calloc(frame_nr, sizeof(pollux_decode_meta_t));
+    if (!(p_batch->buf) || !(p_batch->p_meta)) {
+        SIRIUS_ERROR("alloc: %u x %zu\n", frame_nr, frame_size);
+        pollux_decode_batch_free(p_batch);
+        return POLLUX_ERR_MEMORY_ALLOC;
+    }
+    if (!(internal_alloc_is_zeroed(&allocator, frame_nr * frame_size)))
+        memset(p_batch->buf, 0, frame_nr * frame_size);
+
+    *pp_batch = p_batch;
+
+    return POLLUX_OK;
+}
+
+void
+pollux_decode_audio_result_free(pollux_decode_audio_result_t *p_result)
+{
+    if (p_result) {
+        free(p_result->buf);
+        free(p_result);
+    }
+}
+
+int
+pollux_decode_audio_result_alloc(pollux_decode_audio_result_t **pp_result)
+{
+    if (!(pp_result)) return POLLUX_ERR_INVALID_ENTRY;
+
+    *pp_result = (pollux_decode_audio_result_t *)
+        calloc(1, sizeof(pollux_decode_audio_result_t));
+    if (!(*pp_result)) {
+        SIRIUS_ERROR("calloc\n");
+        return POLLUX_ERR_MEMORY_ALLOC;
+    }
+    (*pp_result)->fmt = POLLUX_SAMPLE_FMT_NONE;
+
+    return POLLUX_OK;
+}
+
+int
+pollux_decode_probe_cache_set(unsigned int entry_nr, const char *p_file)
+{
+    return internal_probe_config(entry_nr, p_file);
+}
+
 int
 pollux_decode_deinit(pollux_decode_t *p_handle)
 {
@@ -461,8 +2405,16 @@ pollux_decode_deinit(pollux_decode_t *p_handle)
     if (!(p_g)) return POLLUX_ERR_NULL_POINTER;
 
     pthread_mutex_destroy(&(p_g->mtx));
+    pthread_cond_destroy(&(p_g->seek_cond));
+    pthread_mutex_destroy(&(p_g->seek_mtx));
+    pthread_mutex_destroy(&(p_g->audio_mtx));
+    pthread_cond_destroy(&(p_g->wake_cond));
+    pthread_mutex_destroy(&(p_g->wake_mtx));
 
     i_frame_cache_free(p_g);
+    internal_trace_close(&(p_g->trace));
+
+    close(p_g->evt_fd);
 
     free(p_g);
     p_g = NULL;
@@ -496,20 +2448,82 @@ pollux_decode_init(pollux_decode_t **pp_handle)
         ret = POLLUX_ERR_MEMORY_ALLOC;
         goto label_handle_free;
     }
+    internal_sched_param_init(&(p_g->param.sched));
+
+    p_g->evt_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC | EFD_SEMAPHORE);
+    if (p_g->evt_fd < 0) {
+        SIRIUS_ERROR("eventfd\n");
+        ret = POLLUX_ERR_RESOURCE_REQUEST;
+        goto label_gh_free;
+    }
+
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr)) {
+        SIRIUS_ERROR("pthread_condattr_init\n");
+        ret = POLLUX_ERR_RESOURCE_REQUEST;
+        goto label_evt_fd_close;
+    }
+    /* the seek timeout must not be affected by wall clock changes */
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    ret = pthread_cond_init(&(p_g->seek_cond), &attr);
+    if (ret) {
+        pthread_condattr_destroy(&attr);
+        SIRIUS_ERROR("pthread_cond_init\n");
+        ret = POLLUX_ERR_RESOURCE_REQUEST;
+        goto label_evt_fd_close;
+    }
+    /* the pacing deadlines are on the monotonic clock as well */
+    ret = pthread_cond_init(&(p_g->wake_cond), &attr);
+    pthread_condattr_destroy(&attr);
+    if (ret) {
+        SIRIUS_ERROR("pthread_cond_init\n");
+        ret = POLLUX_ERR_RESOURCE_REQUEST;
+        goto label_seek_cond_destroy;
+    }
 
     ret = i_frame_cache_alloc(p_g);
-    if(ret) goto label_gh_free;
+    if(ret) goto label_cond_destroy;
+
+    ret = internal_trace_open(&(p_g->trace));
+    if (ret) goto label_frame_cache_free;
 
     pthread_mutex_init(&(p_g->mtx), NULL);
+    pthread_mutex_init(&(p_g->wake_mtx), NULL);
+    pthread_mutex_init(&(p_g->seek_mtx), NULL);
+    pthread_mutex_init(&(p_g->audio_mtx), NULL);
 
     p_h->priv_data = (void *)p_g;
     p_h->param_set = i_decode_param_set;
     p_h->release = i_decode_release;
     p_h->result_get = i_decode_result_get;
+    p_h->drop_nr_get = i_decode_drop_nr_get;
+    p_h->result_try_get = i_decode_result_try_get;
+    p_h->event_fd_get = i_decode_event_fd_get;
+    p_h->frame_release = i_decode_frame_release;
+    p_h->result_get_batch = i_decode_result_get_batch;
+    p_h->result_borrow = i_decode_result_borrow;
+    p_h->result_rendition_get = i_decode_result_rendition_get;
+    p_h->seek = i_decode_seek;
+    p_h->audio_get = i_decode_audio_get;
+    p_h->stats_get = i_decode_stats_get;
+    p_h->trace_dump = i_decode_trace_dump;
+    p_h->shm_fd_get = i_decode_shm_fd_get;
 
     *pp_handle = p_h;
     return POLLUX_OK;
 
+label_frame_cache_free:
+    i_frame_cache_free(p_g);
+
+label_cond_destroy:
+    pthread_cond_destroy(&(p_g->wake_cond));
+
+label_seek_cond_destroy:
+    pthread_cond_destroy(&(p_g->seek_cond));
+
+label_evt_fd_close:
+    close(p_g->evt_fd);
+
 label_gh_free:
     free(p_g);
 
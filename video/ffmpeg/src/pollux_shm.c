@@ -0,0 +1,192 @@
+#include "sirius_log.h"
+#include "pollux_erron.h"
+#include "pollux_shm.h"
+
+#include <time.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+struct pollux_shm_reader_t {
+    /* the mapping, read-only */
+    const pollux_shm_header_t *p_hdr;
+    size_t size;
+    /* the slot array and the frame of slot 0 */
+    const pollux_shm_slot_t *p_slot;
+    const unsigned char *p_data;
+
+    /* the number of the next frame to read, refer to `head` */
+    uint32_t next;
+    /* frames lost since the reader was opened */
+    unsigned long long lost_nr;
+};
+
+static inline long long
+i_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief wait until `head` is no longer `val`, or `timeout_ms` passes;
+ *  it may return early, the caller checks again
+ */
+static void
+i_head_wait(const pollux_shm_header_t *p_hdr,
+    uint32_t val, long long timeout_ms)
+{
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+    /* the word is shared with the writer process, not private */
+    if (syscall(SYS_futex, &(p_hdr->head), FUTEX_WAIT,
+        val, &ts, NULL, 0) && errno != EAGAIN &&
+        errno != EINTR && errno != ETIMEDOUT) {
+        SIRIUS_WARN("futex wait: %d\n", errno);
+    }
+}
+
+int
+pollux_shm_reader_open(int fd, pollux_shm_reader_t **pp_reader)
+{
+    if (fd < 0 || !(pp_reader)) return POLLUX_ERR_INVALID_ENTRY;
+
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size < (off_t)sizeof(pollux_shm_header_t)) {
+        SIRIUS_ERROR("not a frame ring: %d\n", fd);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+
+    pollux_shm_reader_t *p_r =
+        (pollux_shm_reader_t *)calloc(1, sizeof(pollux_shm_reader_t));
+    if (!(p_r)) {
+        SIRIUS_ERROR("calloc\n");
+        return POLLUX_ERR_MEMORY_ALLOC;
+    }
+
+    p_r->size = (size_t)(st.st_size);
+    void *p = mmap(NULL, p_r->size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        SIRIUS_ERROR("mmap: %d\n", errno);
+        free(p_r);
+        return POLLUX_ERR_RESOURCE_REQUEST;
+    }
+    p_r->p_hdr = (const pollux_shm_header_t *)p;
+
+    const pollux_shm_header_t *p_hdr = p_r->p_hdr;
+    if (p_hdr->magic != POLLUX_SHM_MAGIC ||
+        p_hdr->version != POLLUX_SHM_VERSION ||
+        p_hdr->region_size != p_r->size || !(p_hdr->slot_nr) ||
+        p_hdr->slot_offset + p_hdr->slot_nr * sizeof(pollux_shm_slot_t) >
+            p_hdr->data_offset ||
+        p_hdr->frame_size > p_hdr->slot_size ||
+        p_hdr->data_offset + p_hdr->slot_nr * p_hdr->slot_size >
+            p_r->size) {
+        SIRIUS_ERROR("frame ring magic: %x, version: %u\n",
+            p_hdr->magic, p_hdr->version);
+        pollux_shm_reader_close(p_r);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+    p_r->p_slot = (const pollux_shm_slot_t *)
+        ((const unsigned char *)p + p_hdr->slot_offset);
+    p_r->p_data = (const unsigned char *)p + p_hdr->data_offset;
+
+    /* start at the newest frame */
+    uint32_t head = __atomic_load_n(&(p_hdr->head), __ATOMIC_ACQUIRE);
+    p_r->next = (head) ? head - 1 : 0;
+
+    *pp_reader = p_r;
+    return POLLUX_OK;
+}
+
+void
+pollux_shm_reader_close(pollux_shm_reader_t *p_reader)
+{
+    if (!(p_reader)) return;
+
+    munmap((void *)(p_reader->p_hdr), p_reader->size);
+    free(p_reader);
+}
+
+int
+pollux_shm_reader_next(pollux_shm_reader_t *p_reader,
+    pollux_shm_frame_t *p_frame, unsigned int timeout_ms)
+{
+    if (!(p_reader) || !(p_frame)) return POLLUX_ERR_INVALID_ENTRY;
+
+    const pollux_shm_header_t *p_hdr = p_reader->p_hdr;
+    const uint32_t slot_nr = p_hdr->slot_nr;
+    long long end_ms = i_now_ms() + timeout_ms;
+    uint32_t head, seq, n;
+    const pollux_shm_slot_t *p_s;
+    for (;;) {
+        n = p_reader->next;
+        head = __atomic_load_n(&(p_hdr->head), __ATOMIC_ACQUIRE);
+        if (head == n) {
+            /* `state` is set before the last wake, `head` is final */
+            if (__atomic_load_n(&(p_hdr->state), __ATOMIC_ACQUIRE) ==
+                POLLUX_SHM_STATE_END &&
+                __atomic_load_n(&(p_hdr->head), __ATOMIC_ACQUIRE) == n)
+                return POLLUX_ERR_FILE_END;
+
+            long long left_ms = end_ms - i_now_ms();
+            if (left_ms <= 0) return POLLUX_ERR_AGAIN;
+            i_head_wait(p_hdr, n, left_ms);
+            continue;
+        }
+
+        /* the slot of frame `head` may be being written already */
+        if (head - n >= slot_nr) {
+            p_reader->lost_nr += head - slot_nr + 1 - n;
+            p_reader->next = n = head - slot_nr + 1;
+        }
+
+        p_s = &(p_reader->p_slot[n % slot_nr]);
+        seq = __atomic_load_n(&(p_s->seq), __ATOMIC_ACQUIRE);
+        p_reader->next = n + 1;
+        if (!(seq & 1) && p_s->frame_nr == n) break;
+        /* the writer has lapped the reader in the meantime */
+        p_reader->lost_nr++;
+    }
+
+    p_frame->width = (unsigned short)(p_hdr->width);
+    p_frame->height = (unsigned short)(p_hdr->height);
+    p_frame->fmt = (pollux_fmt_t)(p_hdr->fmt);
+    const unsigned char *p_base =
+        p_reader->p_data + (n % slot_nr) * p_hdr->slot_size;
+    for (unsigned int i = 0; i < 4; i++) {
+        p_frame->linesize[i] = p_hdr->linesize[i];
+        p_frame->data[i] = (p_hdr->linesize[i]) ?
+            p_base + p_hdr->plane_offset[i] : NULL;
+    }
+    p_frame->pts_us = p_s->pts_us;
+    p_frame->frame_idx = p_s->frame_idx;
+    p_frame->repeat_nr = p_s->repeat_nr;
+    p_frame->lost_nr = p_reader->lost_nr;
+    p_frame->slot = n % slot_nr;
+    p_frame->seq = seq;
+
+    return POLLUX_OK;
+}
+
+int
+pollux_shm_reader_check(const pollux_shm_reader_t *p_reader,
+    const pollux_shm_frame_t *p_frame)
+{
+    if (!(p_reader) || !(p_frame)) return POLLUX_ERR_INVALID_ENTRY;
+    if (p_frame->slot >= p_reader->p_hdr->slot_nr)
+        return POLLUX_ERR_INVALID_PARAMETER;
+
+    /* the reads of the frame are ordered before the second load */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t seq = __atomic_load_n(
+        &(p_reader->p_slot[p_frame->slot].seq), __ATOMIC_RELAXED);
+
+    return (seq == p_frame->seq) ? POLLUX_OK : POLLUX_ERR_AGAIN;
+}
@@ -0,0 +1,465 @@
+#include "sirius_common.h"
+#include "sirius_log.h"
+#include "pollux_erron.h"
+#include "pollux_sync.h"
+
+#include <time.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+typedef struct {
+    /* the decode handle */
+    pollux_decode_t *p_handle;
+    /* offset added to the timestamps */
+    long long offset_us;
+
+    /* the frame waiting for its partners */
+    pollux_decode_result_t *p_head;
+    /* `p_head` holds a frame */
+    bool head_valid;
+
+    /* the event descriptor of `p_handle` */
+    int evt_fd;
+    /* `evt_fd` is in the epoll set */
+    bool is_watched;
+} i_sync_member_t;
+
+typedef struct {
+    /* members, `member_nr` of them are in use */
+    i_sync_member_t member[POLLUX_SYNC_HANDLE_MAX];
+    unsigned int member_nr;
+
+    /* refer to `pollux_sync_param_t` */
+    long long tolerance_us;
+
+    /* waits for the event descriptors of the members */
+    int ep_fd;
+
+    /* number of late frames dropped since the last `param_set` */
+    unsigned long long drop_nr;
+
+    /* parameter setting flag */
+    bool param_set_flag;
+
+    /* mutex */
+    pthread_mutex_t mtx;
+} i_sync_t;
+
+static inline long long
+i_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static inline long long
+i_member_pts(const i_sync_member_t *p_m)
+{
+    return p_m->p_head->pts_us + p_m->offset_us;
+}
+
+static void
+i_member_free(i_sync_t *p_s)
+{
+    for (unsigned int i = 0; i < p_s->member_nr; i++) {
+        pollux_decode_result_free(p_s->member[i].p_head);
+        p_s->member[i].p_head = NULL;
+        p_s->member[i].head_valid = false;
+        p_s->member[i].is_watched = false;
+    }
+    p_s->member_nr = 0;
+
+    if (p_s->ep_fd >= 0) {
+        close(p_s->ep_fd);
+        p_s->ep_fd = -1;
+    }
+}
+
+static int
+i_member_alloc(i_sync_t *p_s, const pollux_sync_param_t *p_param)
+{
+    p_s->ep_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (p_s->ep_fd < 0) {
+        SIRIUS_ERROR("epoll_create1\n");
+        return POLLUX_ERR_RESOURCE_REQUEST;
+    }
+
+    int ret;
+    struct epoll_event ev = {0};
+    i_sync_member_t *p_m;
+    for (unsigned int i = 0; i < p_param->handle_nr; i++) {
+        p_m = &(p_s->member[i]);
+        p_m->p_handle = p_param->pp_handle[i];
+        p_m->offset_us = (p_param->p_offset_us) ?
+            p_param->p_offset_us[i] : 0;
+        p_m->head_valid = false;
+        p_s->member_nr = i + 1;
+
+        ret = pollux_decode_result_alloc(p_m->p_handle, &(p_m->p_head));
+        if (ret) goto label_member_free;
+
+        ret = p_m->p_handle->event_fd_get(p_m->p_handle, &(p_m->evt_fd));
+        if (ret) goto label_member_free;
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        if (epoll_ctl(p_s->ep_fd, EPOLL_CTL_ADD, p_m->evt_fd, &ev)) {
+            SIRIUS_ERROR("epoll_ctl\n");
+            ret = POLLUX_ERR_RESOURCE_REQUEST;
+            goto label_member_free;
+        }
+        p_m->is_watched = true;
+    }
+
+    return POLLUX_OK;
+
+label_member_free:
+    i_member_free(p_s);
+    return ret;
+}
+
+static int
+i_sync_param_set(pollux_sync_t *thiz,
+    const pollux_sync_param_t *p_param)
+{
+    if (!(thiz) || !(p_param)) return POLLUX_ERR_INVALID_ENTRY;
+    i_sync_t *p_s = (i_sync_t *)(thiz->priv_data);
+    if (!(p_s)) return POLLUX_ERR_NULL_POINTER;
+
+    if (!(p_param->handle_nr) ||
+        p_param->handle_nr > POLLUX_SYNC_HANDLE_MAX ||
+        !(p_param->pp_handle) || p_param->tolerance_us < 0) {
+        SIRIUS_ERROR("handle_nr: %u\n", p_param->handle_nr);
+        return POLLUX_ERR_INVALID_PARAMETER;
+    }
+    for (unsigned int i = 0; i < p_param->handle_nr; i++) {
+        if (!(p_param->pp_handle[i])) return POLLUX_ERR_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&(p_s->mtx));
+    if (p_s->param_set_flag) {
+        i_member_free(p_s);
+        p_s->param_set_flag = false;
+    }
+
+    p_s->tolerance_us = p_param->tolerance_us;
+    p_s->drop_nr = 0;
+    int ret = i_member_alloc(p_s, p_param);
+    if (ret == POLLUX_OK) p_s->param_set_flag = true;
+
+    pthread_mutex_unlock(&(p_s->mtx));
+    return ret;
+}
+
+static int
+i_sync_release(pollux_sync_t *thiz)
+{
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_sync_t *p_s = (i_sync_t *)(thiz->priv_data);
+    if (!(p_s)) return POLLUX_ERR_NULL_POINTER;
+
+    pthread_mutex_lock(&(p_s->mtx));
+    if (p_s->param_set_flag) {
+        i_member_free(p_s);
+        p_s->param_set_flag = false;
+    }
+    pthread_mutex_unlock(&(p_s->mtx));
+
+    return POLLUX_OK;
+}
+
+/**
+ * @brief take a frame for every member without one
+ * 
+ * @return 0 if every member holds a frame; `POLLUX_ERR_AGAIN` if
+ *  some are still missing; error code of `result_try_get` otherwise
+ */
+static int
+i_head_fill(i_sync_t *p_s)
+{
+    int ret, missing = 0;
+    i_sync_member_t *p_m;
+    for (unsigned int i = 0; i < p_s->member_nr; i++) {
+        p_m = &(p_s->member[i]);
+        if (p_m->head_valid) continue;
+
+        ret = p_m->p_handle->result_try_get(p_m->p_handle, p_m->p_head);
+        switch (ret) {
+            case POLLUX_OK:
+                p_m->head_valid = true;
+                break;
+            case POLLUX_ERR_AGAIN:
+                missing++;
+                break;
+            default:
+                return ret;
+        }
+    }
+
+    return missing ? POLLUX_ERR_AGAIN : POLLUX_OK;
+}
+
+/**
+ * @brief watch only the members still without a frame; the event
+ *  descriptors are level-triggered, a member whose frame is already
+ *  held would wake `epoll_wait` at once and spin the loop
+ */
+static int
+i_head_watch(i_sync_t *p_s)
+{
+    struct epoll_event ev = {0};
+    i_sync_member_t *p_m;
+    for (unsigned int i = 0; i < p_s->member_nr; i++) {
+        p_m = &(p_s->member[i]);
+        if (p_m->is_watched != p_m->head_valid) continue;
+
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        if (epoll_ctl(p_s->ep_fd,
+            p_m->head_valid ? EPOLL_CTL_DEL : EPOLL_CTL_ADD,
+            p_m->evt_fd, &ev)) {
+            SIRIUS_ERROR("epoll_ctl\n");
+            return POLLUX_ERR;
+        }
+        p_m->is_watched = !(p_m->head_valid);
+    }
+
+    return POLLUX_OK;
+}
+
+/**
+ * @brief drop the frames too old to match the newest one
+ * 
+ * @return the number of dropped frames
+ */
+static unsigned int
+i_head_align(i_sync_t *p_s, long long *p_ref_us)
+{
+    long long ref_us = i_member_pts(&(p_s->member[0]));
+    for (unsigned int i = 1; i < p_s->member_nr; i++) {
+        if (i_member_pts(&(p_s->member[i])) > ref_us)
+            ref_us = i_member_pts(&(p_s->member[i]));
+    }
+
+    unsigned int nr = 0;
+    for (unsigned int i = 0; i < p_s->member_nr; i++) {
+        if (i_member_pts(&(p_s->member[i])) < ref_us - p_s->tolerance_us) {
+            p_s->member[i].head_valid = false;
+            nr++;
+        }
+    }
+
+    *p_ref_us = ref_us;
+    return nr;
+}
+
+static int
+i_sync_tuple_get(pollux_sync_t *thiz,
+    pollux_sync_tuple_t *p_tuple, unsigned int timeout_ms)
+{
+    if (!(thiz)) return POLLUX_ERR_INVALID_ENTRY;
+    i_sync_t *p_s = (i_sync_t *)(thiz->priv_data);
+    if (!(p_s)) return POLLUX_ERR_NULL_POINTER;
+    if (!(p_tuple) || !(p_tuple->pp_res))
+        return POLLUX_ERR_NULL_POINTER;
+
+    int ret;
+    pthread_mutex_lock(&(p_s->mtx));
+    if (!(p_s->param_set_flag)) {
+        ret = POLLUX_ERR_NOT_INIT;
+        goto label_mtx_unlock;
+    }
+    if (p_tuple->handle_nr != p_s->member_nr) {
+        SIRIUS_ERROR("the tuple does not comply with the parameters\n");
+        ret = POLLUX_ERR_INVALID_PARAMETER;
+        goto label_mtx_unlock;
+    }
+
+    long long ref_us, wait_ms;
+    long long deadline_ms = i_now_ms() + timeout_ms;
+    unsigned int nr;
+    struct epoll_event evs[POLLUX_SYNC_HANDLE_MAX];
+    for (;;) {
+        ret = i_head_fill(p_s);
+        if (ret == POLLUX_OK) {
+            if (!(nr = i_head_align(p_s, &ref_us))) break;
+            p_s->drop_nr += nr;
+            continue;
+        }
+        if (ret != POLLUX_ERR_AGAIN) goto label_mtx_unlock;
+
+        wait_ms = deadline_ms - i_now_ms();
+        if (wait_ms <= 0) goto label_mtx_unlock;
+        if ((ret = i_head_watch(p_s))) goto label_mtx_unlock;
+        if (epoll_wait(p_s->ep_fd, evs,
+            POLLUX_SYNC_HANDLE_MAX, (int)wait_ms) < 0) {
+            SIRIUS_ERROR("epoll_wait\n");
+            ret = POLLUX_ERR;
+            goto label_mtx_unlock;
+        }
+    }
+
+    /* the buffers come from the same handles, swap instead of copying */
+    pollux_decode_result_t *p_res;
+    for (unsigned int i = 0; i < p_s->member_nr; i++) {
+        p_res = p_tuple->pp_res[i];
+        p_tuple->pp_res[i] = p_s->member[i].p_head;
+        p_s->member[i].p_head = p_res;
+        p_s->member[i].head_valid = false;
+    }
+    p_tuple->pts_us = ref_us;
+
+label_mtx_unlock:
+    pthread_mutex_unlock(&(p_s->mtx));
+    return ret;
+}
+
+static int
+i_sync_drop_nr_get(pollux_sync_t *thiz,
+    unsigned long long *p_nr)
+{
+    if (!(thiz) || !(p_nr)) return POLLUX_ERR_INVALID_ENTRY;
+    i_sync_t *p_s = (i_sync_t *)(thiz->priv_data);
+    if (!(p_s)) return POLLUX_ERR_NULL_POINTER;
+
+    pthread_mutex_lock(&(p_s->mtx));
+    *p_nr = p_s->drop_nr;
+    pthread_mutex_unlock(&(p_s->mtx));
+
+    return POLLUX_OK;
+}
+
+void
+pollux_sync_tuple_free(pollux_sync_tuple_t *p_tuple)
+{
+    if (p_tuple) {
+        if (p_tuple->pp_res) {
+            for (unsigned int i = 0; i < p_tuple->handle_nr; i++) {
+                pollux_decode_result_free(p_tuple->pp_res[i]);
+            }
+            free(p_tuple->pp_res);
+        }
+
+        free(p_tuple);
+    }
+}
+
+int
+pollux_sync_tuple_alloc(pollux_sync_t *p_handle,
+    pollux_sync_tuple_t **pp_tuple)
+{
+    if (!(pp_tuple)) return POLLUX_ERR_INVALID_ENTRY;
+    if (!(p_handle)) return POLLUX_ERR_INVALID_ENTRY;
+    i_sync_t *p_s = (i_sync_t *)(p_handle->priv_data);
+    if (!(p_s)) return POLLUX_ERR_NULL_POINTER;
+
+    int ret = POLLUX_OK;
+    pthread_mutex_lock(&(p_s->mtx));
+    if (!(p_s->param_set_flag)) {
+        SIRIUS_WARN("no valid parameter is configured\n");
+        ret = POLLUX_ERR_NOT_INIT;
+        goto label_mtx_unlock;
+    }
+
+    pollux_sync_tuple_t *p_tuple = (pollux_sync_tuple_t *)
+        calloc(1, sizeof(pollux_sync_tuple_t));
+    if (!(p_tuple)) {
+        SIRIUS_ERROR("calloc\n");
+        ret = POLLUX_ERR_MEMORY_ALLOC;
+        goto label_mtx_unlock;
+    }
+    p_tuple->pp_res = (pollux_decode_result_t **)
+        calloc(p_s->member_nr, sizeof(pollux_decode_result_t *));
+    if (!(p_tuple->pp_res)) {
+        SIRIUS_ERROR("calloc\n");
+        free(p_tuple);
+        ret = POLLUX_ERR_MEMORY_ALLOC;
+        goto label_mtx_unlock;
+    }
+    p_tuple->handle_nr = p_s->member_nr;
+
+    for (unsigned int i = 0; i < p_s->member_nr; i++) {
+        ret = pollux_decode_result_alloc(
+            p_s->member[i].p_handle, &(p_tuple->pp_res[i]));
+        if (ret) {
+            pollux_sync_tuple_free(p_tuple);
+            goto label_mtx_unlock;
+        }
+    }
+
+    *pp_tuple = p_tuple;
+
+label_mtx_unlock:
+    pthread_mutex_unlock(&(p_s->mtx));
+    return ret;
+}
+
+int
+pollux_sync_deinit(pollux_sync_t *p_handle)
+{
+    if (!(p_handle)) return POLLUX_ERR_INVALID_ENTRY;
+    i_sync_t *p_s = (i_sync_t *)(p_handle->priv_data);
+    if (!(p_s)) return POLLUX_ERR_NULL_POINTER;
+
+    i_member_free(p_s);
+
+    pthread_mutex_destroy(&(p_s->mtx));
+
+    free(p_s);
+    p_s = NULL;
+
+    free(p_handle);
+
+    sirius_deinit();
+    return POLLUX_OK;
+}
+
+int
+pollux_sync_init(pollux_sync_t **pp_handle)
+{
+    if (!(pp_handle)) return POLLUX_ERR_INVALID_ENTRY;
+
+    sirius_init_t cr = {0};
+    cr.log_lv = SIRIUS_LOG_LV_INFO;
+    cr.p_pipe = "/var/tmp/log_pipe";
+    if (sirius_init(&cr)) return POLLUX_ERR;
+
+    int ret = POLLUX_OK;
+    pollux_sync_t *p_h =
+        (pollux_sync_t *)calloc(1, sizeof(pollux_sync_t));
+    if (!(p_h)) {
+        SIRIUS_ERROR("calloc\n");
+        ret = POLLUX_ERR_MEMORY_ALLOC;
+        goto label_sirius_deinit;
+    }
+
+    i_sync_t *p_s = (i_sync_t *)calloc(1, sizeof(i_sync_t));
+    if (!(p_s)) {
+        SIRIUS_ERROR("calloc\n");
+        ret = POLLUX_ERR_MEMORY_ALLOC;
+        goto label_handle_free;
+    }
+    p_s->ep_fd = -1;
+
+    pthread_mutex_init(&(p_s->mtx), NULL);
+
+    p_h->priv_data = (void *)p_s;
+    p_h->param_set = i_sync_param_set;
+    p_h->release = i_sync_release;
+    p_h->tuple_get = i_sync_tuple_get;
+    p_h->drop_nr_get = i_sync_drop_nr_get;
+
+    *pp_handle = p_h;
+    return POLLUX_OK;
+
+label_handle_free:
+    free(p_h);
+
+label_sirius_deinit:
+    sirius_deinit();
+
+    return ret;
+}
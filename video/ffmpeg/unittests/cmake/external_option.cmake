@@ -16,3 +16,26 @@ set(
     "" CACHE STRING
     "the link library file name in the test, e.g., `pthread;stdc++`"
 )
+
+#[[
+    the static jemalloc of `memory/jemalloc/example/lib` is built for
+    x86_64 and without `-fPIC`, the test of it needs `-no-pie`
+]]
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64)$" AND
+    NOT POLLUX_TEST_PIE_ENABLE)
+    set(_test_jemalloc_default ON)
+else()
+    set(_test_jemalloc_default OFF)
+endif()
+
+option(
+    POLLUX_TEST_JEMALLOC_ENABLE
+    "link jemalloc in the test, to try the arena adapter `pollux_jemalloc.h`"
+    ${_test_jemalloc_default}
+)
+
+set(
+    POLLUX_TEST_JEMALLOC_LIBRARY
+    "" CACHE STRING
+    "the jemalloc library of the test, the one of `memory/jemalloc/example/lib` if empty"
+)
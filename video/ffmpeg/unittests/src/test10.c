@@ -0,0 +1,146 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* the background handles that compete with the live one */
+#define BACKGROUND_NR (8)
+#define HANDLE_NR (BACKGROUND_NR + 1)
+#define RUN_S (10)
+/* the share of the rate of its source the live handle must deliver */
+#define LIVE_RATE_MIN (0.9)
+
+static const char *live = "./input1_1280-720_video_audio.mp4";
+static const char *batch = "./input2_2560-1440_video.mp4";
+
+typedef struct {
+    pollux_decode_t *p_pollux;
+    unsigned long long nr;
+    /* the first and the last result, for the rates */
+    unsigned long long first_idx, last_idx;
+    long long first_pts_us, last_pts_us;
+    long long first_us, last_us;
+} i_handle_t;
+
+static atomic_bool running = true;
+
+static long long
+i_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void *
+i_consume(void *args)
+{
+    i_handle_t *p_h = (i_handle_t *)args;
+    pollux_decode_result_t *p_res = NULL;
+    if (pollux_decode_result_alloc(p_h->p_pollux, &p_res)) return NULL;
+
+    while (atomic_load(&running)) {
+        if (p_h->p_pollux->result_get(p_h->p_pollux, p_res)) continue;
+        p_h->last_us = i_now_us();
+        if (!(p_h->nr++)) {
+            p_h->first_idx = p_res->frame_idx;
+            p_h->first_pts_us = p_res->pts_us;
+            p_h->first_us = p_h->last_us;
+        }
+        p_h->last_idx = p_res->frame_idx;
+        p_h->last_pts_us = p_res->pts_us;
+    }
+
+    pollux_decode_result_free(p_res);
+    return NULL;
+}
+
+/**
+ * the live handle must keep the rate of its source while the
+ * background ones share whatever CPU is left
+ */
+int
+main(int argc, char *argv[])
+{
+    i_handle_t handle[HANDLE_NR] = {0};
+    pthread_t thd[HANDLE_NR];
+    pollux_decode_param_t param = {0};
+    int ret = 0;
+    unsigned int nr = 0;
+
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.alignment = 1;
+    param.is_loop = 1;
+    /* the background handles degrade before they fall further behind */
+    param.shed.is_enable = 1;
+    for (; nr < HANDLE_NR; nr++) {
+        if ((ret = pollux_decode_init(&(handle[nr].p_pollux)))) break;
+
+        if (nr == 0) {
+            param.p_file = live;
+            param.yuv.width = 1280;
+            param.yuv.height = 720;
+            param.sched.priority = POLLUX_PRIORITY_HIGH;
+        } else {
+            param.p_file = batch;
+            param.yuv.width = 2560;
+            param.yuv.height = 1440;
+            param.sched.priority = POLLUX_PRIORITY_BACKGROUND;
+        }
+        ret = handle[nr].p_pollux->param_set(handle[nr].p_pollux, &param);
+        if (ret) {
+            fprintf(stderr, "error, param_set: %d\n", ret);
+            pollux_decode_deinit(handle[nr].p_pollux);
+            break;
+        }
+        if ((ret = pthread_create(
+            &(thd[nr]), NULL, i_consume, &(handle[nr])))) {
+            handle[nr].p_pollux->release(handle[nr].p_pollux);
+            pollux_decode_deinit(handle[nr].p_pollux);
+            break;
+        }
+    }
+
+    struct timespec ts = {.tv_sec = RUN_S};
+    if (!(ret)) nanosleep(&ts, NULL);
+    atomic_store(&running, false);
+
+    pollux_decode_stats_t stats;
+    for (unsigned int i = 0; i < nr; i++) {
+        pthread_join(thd[i], NULL);
+        if (!(handle[i].p_pollux->stats_get(handle[i].p_pollux, &stats))) {
+            printf("%-10s [%u]: %.1f fps delivered, %.1f fps decoded, "
+                "shed level %d, late %lld ms\n",
+                i ? "background" : "live", i,
+                (double)(handle[i].nr) / RUN_S, stats.decode_fps,
+                stats.shed_level, stats.late_us / 1000);
+        }
+        handle[i].p_pollux->release(handle[i].p_pollux);
+        pollux_decode_deinit(handle[i].p_pollux);
+    }
+    if (ret) return ret;
+
+    /**
+     * the frames of the stream per second of it, across the loops,
+     * against the results per second of the wall clock
+     */
+    i_handle_t *p_live = &(handle[0]);
+    double span_s = (double)(p_live->last_pts_us - p_live->first_pts_us) / 1e6;
+    double wall_s = (double)(p_live->last_us - p_live->first_us) / 1e6;
+    double source_fps = (span_s > 0) ?
+        (double)(p_live->last_idx - p_live->first_idx) / span_s : 0.0;
+    double live_fps = (wall_s > 0) ?
+        (double)(p_live->nr - 1) / wall_s : 0.0;
+    printf("live: %.1f fps of a %.1f fps source\n", live_fps, source_fps);
+    if (source_fps <= 0 || live_fps < LIVE_RATE_MIN * source_fps) {
+        fprintf(stderr, "error, the live handle fell behind its source\n");
+        ret = -1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,154 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <time.h>
+#include <stdio.h>
+
+static const char *file = "./input2_2560-1440_video.mp4";
+/* the first half of `file`, the later segments cannot be read */
+static const char *cut = "./test11_cut.mp4";
+
+typedef struct {
+    unsigned long long nr;
+    unsigned long long disorder;
+    /* what `result_get` returned at the end */
+    int end;
+} i_extract_t;
+
+static double
+i_now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)(ts.tv_sec) + (double)(ts.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief extract the whole file and check that the frames come in order
+ */
+static int
+i_extract(const char *p_file, unsigned short thd_nr, i_extract_t *p_out)
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    long long pts_last = -1;
+
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    param.p_file = p_file;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 2560;
+    param.yuv.height = 1440;
+    param.yuv.alignment = 1;
+    param.segment_thd_nr = thd_nr;
+    double start = i_now_s();
+    if ((ret = p_pollux->param_set(p_pollux, &param))) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_deinit;
+    }
+    if ((ret = pollux_decode_result_alloc(p_pollux, &p_res)))
+        goto label_release;
+
+    p_out->nr = p_out->disorder = 0;
+    for (;;) {
+        ret = p_pollux->result_get(p_pollux, p_res);
+        if (ret == POLLUX_ERR_FILE_END ||
+            ret == POLLUX_ERR_DECODE_THD_EXIT)
+            break;
+        if (ret) continue;
+
+        /* a frame delivered twice is out of order as well */
+        if (p_res->pts_us <= pts_last) p_out->disorder++;
+        pts_last = p_res->pts_us;
+        p_out->nr++;
+    }
+    p_out->end = ret;
+    ret = POLLUX_OK;
+
+    double cost = i_now_s() - start;
+    printf("%s, segment threads %2hu: %llu frames in %.2f s, %.1f fps, "
+        "%llu out of order, end %d\n", p_file, thd_nr, p_out->nr, cost,
+        (double)(p_out->nr) / cost, p_out->disorder, p_out->end);
+
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+    return ret;
+}
+
+/**
+ * @brief a copy of the first `num / den` of the file
+ */
+static int
+i_cut(const char *p_src, const char *p_dst, long num, long den)
+{
+    char buf[1 << 16];
+    size_t n;
+    long size, left;
+    int ret = -1;
+    FILE *p_in = fopen(p_src, "rb"), *p_out = fopen(p_dst, "wb");
+    if (!(p_in) || !(p_out)) goto label_close;
+    if (fseek(p_in, 0, SEEK_END) || (size = ftell(p_in)) <= 0 ||
+        fseek(p_in, 0, SEEK_SET))
+        goto label_close;
+
+    for (left = size / den * num; left > 0; left -= (long)n) {
+        n = fread(buf, 1, (size_t)left < sizeof(buf) ?
+            (size_t)left : sizeof(buf), p_in);
+        if (!(n) || fwrite(buf, 1, n, p_out) != n) goto label_close;
+    }
+    ret = 0;
+
+label_close:
+    if (p_in) fclose(p_in);
+    if (p_out && fclose(p_out)) ret = -1;
+    return ret;
+}
+
+/**
+ * whole-file extraction by one decoder, then by several decoding
+ * the segments of the file in parallel: the same frames, each once
+ * and in order; then an input cut short, which must come to an end
+ * with the frames in order, whatever the threads failed to read
+ */
+int
+main(int argc, char *argv[])
+{
+    static const unsigned short thd_nr[] = {1, 2, 4, 8};
+    i_extract_t ref = {0}, out = {0};
+    int ret;
+
+    for (unsigned int i = 0; i < sizeof(thd_nr) / sizeof(thd_nr[0]); i++) {
+        if ((ret = i_extract(file, thd_nr[i], i ? &out : &ref)))
+            return ret;
+        if (ref.end != POLLUX_ERR_FILE_END || ref.disorder ||
+            (i && (out.nr != ref.nr || out.disorder ||
+            out.end != POLLUX_ERR_FILE_END))) {
+            fprintf(stderr, "error, %hu segment threads\n", thd_nr[i]);
+            return -1;
+        }
+    }
+
+    if (i_cut(file, cut, 1, 2)) {
+        fprintf(stderr, "error, copy of %s\n", file);
+        return -1;
+    }
+    /* a file whose index is at its end does not open at all */
+    ret = i_extract(cut, 4, &out);
+    remove(cut);
+    if (ret) {
+        printf("%s does not open: %d, nothing more to check\n", cut, ret);
+        return 0;
+    }
+    if (out.disorder || out.nr >= ref.nr) {
+        fprintf(stderr, "error, the cut file\n");
+        return -1;
+    }
+
+    return 0;
+}
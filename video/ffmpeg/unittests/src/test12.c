@@ -0,0 +1,104 @@
+#include "pollux_decode.h"
+#include "pollux_shm.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define READ_NR (250)
+#define SLOT_NR (8)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+/**
+ * @brief the reader process, it reads the frames in place and sums
+ *  up the first line of the luma, as the analysis would
+ */
+static int
+i_reader(int fd)
+{
+    pollux_shm_reader_t *p_reader = NULL;
+    pollux_shm_frame_t frame = {0};
+    unsigned long long sum, torn = 0;
+    unsigned int nr = 0;
+
+    int ret = pollux_shm_reader_open(fd, &p_reader);
+    if (ret) return ret;
+
+    while (nr < READ_NR) {
+        ret = pollux_shm_reader_next(p_reader, &frame, 1000);
+        if (ret == POLLUX_ERR_AGAIN) continue;
+        if (ret) break;
+
+        sum = 0;
+        for (unsigned int i = 0; i < frame.width; i++)
+            sum += frame.data[0][i];
+        /* the writer does not wait, the frame may be gone already */
+        if (pollux_shm_reader_check(p_reader, &frame)) {
+            torn++;
+            continue;
+        }
+
+        if (!(nr++ % 25)) {
+            printf("[reader %d] frame %llu, pts %lld us, luma sum %llu, "
+                "lost %llu\n", (int)getpid(), frame.frame_idx,
+                frame.pts_us, sum, frame.lost_nr);
+        }
+    }
+    printf("[reader %d] %u frames, %llu torn, %llu lost\n",
+        (int)getpid(), nr, torn, frame.lost_nr);
+
+    pollux_shm_reader_close(p_reader);
+    return (ret == POLLUX_ERR_FILE_END) ? POLLUX_OK : ret;
+}
+
+/**
+ * the frames are published to a shared memory ring and read by
+ * another process without being copied
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_param_t param = {0};
+    int fd, status = 0;
+
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 1280;
+    param.yuv.height = 720;
+    param.yuv.alignment = 1;
+    param.is_loop = 1;
+    param.p_file = video;
+    param.shm.slot_nr = SLOT_NR;
+    param.shm.p_name = "pollux-test12";
+    if ((ret = p_pollux->param_set(p_pollux, &param))) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_deinit;
+    }
+    if ((ret = p_pollux->shm_fd_get(p_pollux, &fd))) goto label_release;
+
+    /* the memfd is inherited, another program would receive it instead */
+    pid_t pid = fork();
+    if (pid < 0) {
+        ret = -1;
+        goto label_release;
+    }
+    if (pid == 0) _exit(i_reader(fd) ? 1 : 0);
+
+    waitpid(pid, &status, 0);
+    if (!(WIFEXITED(status)) || WEXITSTATUS(status)) {
+        fprintf(stderr, "error, the reader failed\n");
+        ret = -1;
+    }
+
+label_release:
+    p_pollux->release(p_pollux);
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+    return ret;
+}
@@ -0,0 +1,170 @@
+#include "pollux_decode.h"
+#include "pollux_jemalloc.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#define FRAME_NR (100)
+
+/* the adapter is tried when the test is linked with jemalloc */
+#ifdef POLLUX_TEST_JEMALLOC
+#define I_JEMALLOC
+#endif
+
+static const char *video = "./input2_2560-1440_video.mp4";
+
+/**
+ * counts what passes through the allocator of the handle,
+ * on top of the jemalloc arena or of `aligned_alloc`
+ */
+typedef struct {
+    pollux_allocator_t inner;
+    atomic_llong live;
+    atomic_llong peak;
+    atomic_ullong alloc_nr;
+    /* the addresses not aligned as asked */
+    atomic_ullong misalign_nr;
+} i_counter_t;
+
+static void *
+i_alloc(void *p_user, size_t size, size_t alignment)
+{
+    i_counter_t *p_c = (i_counter_t *)p_user;
+    void *ptr = p_c->inner.alloc(p_c->inner.p_user, size, alignment);
+    if (!(ptr)) return NULL;
+
+    long long live = atomic_fetch_add(&(p_c->live), size) + size;
+    long long peak = atomic_load(&(p_c->peak));
+    while (live > peak &&
+        !(atomic_compare_exchange_weak(&(p_c->peak), &peak, live)));
+    atomic_fetch_add(&(p_c->alloc_nr), 1);
+    if ((uintptr_t)ptr % alignment) {
+        fprintf(stderr, "error, %p is not aligned to %zu\n", ptr, alignment);
+        atomic_fetch_add(&(p_c->misalign_nr), 1);
+    }
+    return ptr;
+}
+
+static void
+i_free(void *p_user, void *ptr, size_t size)
+{
+    i_counter_t *p_c = (i_counter_t *)p_user;
+    atomic_fetch_sub(&(p_c->live), size);
+    p_c->inner.free(p_c->inner.p_user, ptr, size);
+}
+
+#ifndef I_JEMALLOC
+static void *
+i_libc_alloc(void *p_user, size_t size, size_t alignment)
+{
+    /* the size of `aligned_alloc` is a multiple of the alignment */
+    return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+}
+
+static void
+i_libc_free(void *p_user, void *ptr, size_t size)
+{
+    free(ptr);
+}
+#endif
+
+/**
+ * the frame caches and the result of a handle come from the
+ * allocator of the caller, a jemalloc arena of their own if possible
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    i_counter_t counter = {0};
+
+#ifdef I_JEMALLOC
+    pollux_jemalloc_arena_t arena;
+    size_t size;
+    int ret = pollux_jemalloc_arena_create(&arena);
+    if (ret) return ret;
+    counter.inner = arena.allocator;
+    printf("jemalloc arena %u\n", arena.index);
+#else
+    int ret;
+    counter.inner.alloc = i_libc_alloc;
+    counter.inner.free = i_libc_free;
+    printf("no jemalloc, aligned_alloc\n");
+#endif
+
+    if ((ret = pollux_decode_init(&p_pollux))) goto label_arena;
+
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 2560;
+    param.yuv.height = 1440;
+    param.yuv.alignment = 64;
+    param.p_file = video;
+    param.allocator.alloc = i_alloc;
+    param.allocator.free = i_free;
+    param.allocator.p_user = &counter;
+    if ((ret = p_pollux->param_set(p_pollux, &param))) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_deinit;
+    }
+    if ((ret = pollux_decode_result_alloc(p_pollux, &p_res)))
+        goto label_release;
+
+    for (unsigned int i = 0; i < FRAME_NR && !(ret); i++) {
+        ret = p_pollux->result_get(p_pollux, p_res);
+    }
+    if (ret == POLLUX_ERR_FILE_END) ret = POLLUX_OK;
+    if (ret) fprintf(stderr, "error, result_get: %d\n", ret);
+
+    printf("%llu allocations, %lld bytes live, %lld bytes at the peak\n",
+        (unsigned long long)atomic_load(&(counter.alloc_nr)),
+        (long long)atomic_load(&(counter.live)),
+        (long long)atomic_load(&(counter.peak)));
+#ifdef I_JEMALLOC
+    /* the frames must have gone to the arena, not to the heap */
+    if (!(pollux_jemalloc_arena_allocated(&arena, &size))) {
+        printf("the arena holds %zu bytes\n", size);
+        if (size < (size_t)atomic_load(&(counter.live))) {
+            fprintf(stderr, "error, the arena holds less than is live\n");
+            ret = -1;
+        }
+    }
+#endif
+
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+label_arena:
+    if (!(atomic_load(&(counter.alloc_nr)))) {
+        fprintf(stderr, "error, the allocator was never called\n");
+        ret = -1;
+    }
+    if (atomic_load(&(counter.misalign_nr))) {
+        fprintf(stderr, "error, %llu addresses not aligned\n",
+            (unsigned long long)atomic_load(&(counter.misalign_nr)));
+        ret = -1;
+    }
+    if (atomic_load(&(counter.live))) {
+        fprintf(stderr, "error, %lld bytes not freed\n",
+            (long long)atomic_load(&(counter.live)));
+        ret = -1;
+    }
+#ifdef I_JEMALLOC
+    /* everything is back in the arena, which is then dropped */
+    if (!(pollux_jemalloc_arena_allocated(&arena, &size)) && size) {
+        fprintf(stderr, "error, the arena still holds %zu bytes\n", size);
+        ret = -1;
+    }
+    if (pollux_jemalloc_arena_destroy(&arena)) {
+        fprintf(stderr, "error, arena %u not destroyed\n", arena.index);
+        ret = -1;
+    }
+#endif
+    return ret;
+}
@@ -0,0 +1,176 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define FRAME_NR (300)
+/* the frame caches are over 5 MB each, one huge page is the least */
+#define HUGE_KB_MIN (2048)
+
+static const char *file = "./input2_2560-1440_video.mp4";
+
+static double
+i_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)(ts.tv_sec) * 1e3 + (double)(ts.tv_nsec) / 1e6;
+}
+
+/**
+ * @brief count the data TLB misses of `op` in user space, of this
+ *  thread and of the threads it creates from now on
+ * 
+ * @return the counter, -1 if the cpu or `perf_event_paranoid`
+ *  does not allow it
+ */
+static int
+i_dtlb_open(unsigned long long op)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (op << 8) |
+        ((unsigned long long)PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static long long
+i_dtlb_read(int fd)
+{
+    long long count;
+    if (fd < 0 || read(fd, &count, sizeof(count)) != sizeof(count))
+        return -1;
+    return count;
+}
+
+/**
+ * @brief the kB of this process on huge pages, of the `hugetlbfs` pool
+ *  and transparent ones
+ * 
+ * @return the kB, -1 if `/proc/self/smaps` cannot be read
+ */
+static long long
+i_huge_kb(void)
+{
+    FILE *fp = fopen("/proc/self/smaps", "r");
+    if (!fp) return -1;
+
+    char line[256];
+    long long kb, sum = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "AnonHugePages: %lld kB", &kb) == 1 ||
+            sscanf(line, "Private_Hugetlb: %lld kB", &kb) == 1 ||
+            sscanf(line, "Shared_Hugetlb: %lld kB", &kb) == 1)
+            sum += kb;
+    }
+    fclose(fp);
+    return sum;
+}
+
+/**
+ * @brief time the first frame and count the TLB misses of the
+ *  frames after it, on the pages `page`
+ */
+static int
+i_run(pollux_page_t page)
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    unsigned int nr = 0;
+
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    param.p_file = file;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 2560;
+    param.yuv.height = 1440;
+    param.yuv.alignment = 64;
+    param.page = page;
+
+    long long base_kb = i_huge_kb();
+
+    /* before `param_set`, the decoding thread inherits the counters */
+    int load_fd = i_dtlb_open(PERF_COUNT_HW_CACHE_OP_READ);
+    int store_fd = i_dtlb_open(PERF_COUNT_HW_CACHE_OP_WRITE);
+
+    double start = i_now_ms();
+    if ((ret = p_pollux->param_set(p_pollux, &param))) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_deinit;
+    }
+    if ((ret = pollux_decode_result_alloc(p_pollux, &p_res)))
+        goto label_release;
+    if ((ret = p_pollux->result_get(p_pollux, p_res))) {
+        fprintf(stderr, "error, result_get: %d\n", ret);
+        goto label_result_free;
+    }
+    double first = i_now_ms() - start;
+
+    while (++nr < FRAME_NR) {
+        ret = p_pollux->result_get(p_pollux, p_res);
+        if (ret == POLLUX_ERR_FILE_END) break;
+        if (ret) goto label_result_free;
+    }
+    ret = POLLUX_OK;
+    double total = i_now_ms() - start;
+
+    /* the frame caches are still mapped until `release` */
+    long long huge_kb = i_huge_kb();
+    if (huge_kb >= 0 && base_kb >= 0) huge_kb -= base_kb;
+
+    printf("%-8s first frame %7.2f ms, %u frames %8.2f ms, "
+        "dTLB load misses %lld, store misses %lld, huge pages %lld kB\n",
+        (page == POLLUX_PAGE_HUGE) ? "huge" : "default", first, nr, total,
+        i_dtlb_read(load_fd), i_dtlb_read(store_fd), huge_kb);
+
+    /* the allocator falls back to ordinary pages without an error */
+    if (page == POLLUX_PAGE_HUGE && huge_kb < HUGE_KB_MIN) {
+        fprintf(stderr, "error, the frame caches are on ordinary pages, "
+            "refer to `/proc/sys/vm/nr_hugepages` and "
+            "`/sys/kernel/mm/transparent_hugepage/enabled`\n");
+        ret = -1;
+    }
+
+label_result_free:
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+    if (load_fd >= 0) close(load_fd);
+    if (store_fd >= 0) close(store_fd);
+    return ret;
+}
+
+/**
+ * the frame caches and the result on ordinary pages against huge ones;
+ * the counters read -1 where perf events are not allowed, the huge run
+ * fails when its frame caches are not on huge pages
+ */
+int
+main(int argc, char *argv[])
+{
+    int ret;
+    if ((ret = i_run(POLLUX_PAGE_DEFAULT))) return ret;
+    if ((ret = i_run(POLLUX_PAGE_HUGE))) return ret;
+
+    return 0;
+}
@@ -0,0 +1,274 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <time.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#define FRAME_NR (300)
+#define NODE_NR (64)
+#define CPU_NR (1024)
+/* the memory of the bandwidth probe, far above the caches */
+#define PROBE_SIZE ((size_t)256 << 20)
+
+static const char *file = "./input2_2560-1440_video.mp4";
+
+static double
+i_now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)(ts.tv_sec) + (double)(ts.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief the CPUs of `node`
+ * 
+ * @return the number of CPUs, 0 if there are none
+ */
+static unsigned int
+i_node_cpus(int node, unsigned int *p_cpu)
+{
+    char path[64];
+    snprintf(path, sizeof(path),
+        "/sys/devices/system/node/node%d/cpulist", node);
+    FILE *fp = fopen(path, "r");
+    if (!(fp)) return 0;
+
+    unsigned int nr = 0, first, last;
+    char sep;
+    while (fscanf(fp, "%u", &first) == 1) {
+        last = first;
+        if ((sep = (char)fgetc(fp)) == '-') {
+            if (fscanf(fp, "%u", &last) != 1) break;
+            sep = (char)fgetc(fp);
+        }
+        for (unsigned int i = first; i <= last && nr < CPU_NR; i++)
+            p_cpu[nr++] = i;
+        if (sep != ',') break;
+    }
+    fclose(fp);
+    return nr;
+}
+
+static void
+i_pin(const unsigned int *p_cpu, unsigned int nr)
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (unsigned int i = 0; i < nr; i++) CPU_SET(p_cpu[i], &cpus);
+    sched_setaffinity(0, sizeof(cpus), &cpus);
+}
+
+/**
+ * @brief the read bandwidth of the memory of `mem_node`, from the
+ *  calling thread, in GB/s
+ */
+static double
+i_probe(int mem_node)
+{
+    unsigned char *p = (unsigned char *)mmap(NULL, PROBE_SIZE,
+        PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if ((void *)p == MAP_FAILED) return -1.0;
+
+    unsigned long mask = 1UL << mem_node;
+    if (syscall(SYS_mbind, p, PROBE_SIZE, MPOL_BIND,
+        &mask, NODE_NR + 1, 0)) {
+        munmap(p, PROBE_SIZE);
+        return -1.0;
+    }
+    memset(p, 1, PROBE_SIZE);
+
+    unsigned long long sum = 0;
+    double start = i_now_s();
+    for (unsigned int n = 0; n < 4; n++) {
+        const unsigned long long *p_w = (const unsigned long long *)p;
+        for (size_t i = 0; i < PROBE_SIZE / sizeof(*p_w); i += 8) {
+            sum += p_w[i] + p_w[i + 1] + p_w[i + 2] + p_w[i + 3] +
+                p_w[i + 4] + p_w[i + 5] + p_w[i + 6] + p_w[i + 7];
+        }
+    }
+    double sec = i_now_s() - start;
+    munmap(p, PROBE_SIZE);
+
+    /* keeps the loop */
+    if (sum == 42) printf(" ");
+    return (double)(4 * PROBE_SIZE) / sec / 1e9;
+}
+
+/**
+ * @brief decode on the CPUs `p_cpu` with the frame caches on
+ *  `mem_node`, in frames per second
+ */
+static double
+i_decode(const unsigned int *p_cpu, unsigned int cpu_nr, int mem_node)
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    unsigned int nr = 0;
+    double fps = -1.0;
+
+    if (pollux_decode_init(&p_pollux)) return fps;
+
+    param.p_file = file;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 2560;
+    param.yuv.height = 1440;
+    param.yuv.alignment = 64;
+    param.sched.cpu_nr = cpu_nr;
+    param.sched.p_cpu = p_cpu;
+    param.sched.numa = POLLUX_NUMA_NODE(mem_node);
+    if (p_pollux->param_set(p_pollux, &param)) goto label_deinit;
+    if (pollux_decode_result_alloc(p_pollux, &p_res)) goto label_release;
+
+    double start = i_now_s();
+    for (; nr < FRAME_NR; nr++) {
+        if (p_pollux->result_get(p_pollux, p_res)) break;
+    }
+    fps = (double)nr / (i_now_s() - start);
+
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+    return fps;
+}
+
+/**
+ * @brief the policy of the page at `ptr`, and the node it is on
+ */
+static int
+i_policy(void *ptr, int *p_mode, unsigned long *p_mask, int *p_node)
+{
+    if (syscall(SYS_get_mempolicy, p_mode, p_mask,
+        NODE_NR + 1, ptr, MPOL_F_ADDR))
+        return -1;
+    return (syscall(SYS_get_mempolicy, p_node, NULL, 0, ptr,
+        MPOL_F_NODE | MPOL_F_ADDR)) ? -1 : 0;
+}
+
+/**
+ * @brief `param_set` and a result, whose policy and node are those
+ *  the default allocator gives the frame caches
+ */
+static int
+i_result_policy(pollux_decode_t *p_pollux, pollux_decode_param_t *p_param,
+    int *p_mode, unsigned long *p_mask, int *p_node)
+{
+    pollux_decode_result_t *p_res = NULL;
+    int ret = p_pollux->param_set(p_pollux, p_param);
+    if (ret) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        return ret;
+    }
+    if (!(ret = pollux_decode_result_alloc(p_pollux, &p_res))) {
+        *p_mask = 0;
+        ret = i_policy(p_res->buf, p_mode, p_mask, p_node);
+        pollux_decode_result_free(p_res);
+    }
+    p_pollux->release(p_pollux);
+
+    return ret;
+}
+
+/**
+ * @brief the default allocators map on the node of the handle, with
+ *  ordinary and huge pages, and `POLLUX_NUMA_AUTO` keeps the node
+ *  over `param_set`
+ */
+static int
+i_placement(int node_nr)
+{
+    static const char *page[POLLUX_PAGE_MAX] = {"default", "huge"};
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_param_t param = {0};
+    int node = node_nr - 1, mode, where, ret = -1;
+    unsigned long mask, first = 0;
+
+    if (pollux_decode_init(&p_pollux)) return ret;
+
+    param.p_file = file;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 2560;
+    param.yuv.height = 1440;
+    param.yuv.alignment = 64;
+    param.sched.numa = POLLUX_NUMA_NODE(node);
+    for (int i = 0; i < POLLUX_PAGE_MAX; i++) {
+        param.page = (pollux_page_t)i;
+        if (i_result_policy(p_pollux, &param, &mode, &mask, &where))
+            goto label_deinit;
+        printf("%s pages, node %d: policy %d, mask %#lx, on node %d\n",
+            page[i], node, mode, mask, where);
+        if (mode != MPOL_PREFERRED || mask != 1UL << node || where != node) {
+            fprintf(stderr, "error, not mapped on node %d\n", node);
+            goto label_deinit;
+        }
+    }
+
+    param.page = POLLUX_PAGE_DEFAULT;
+    param.sched.numa = POLLUX_NUMA_AUTO;
+    for (int i = 0; i < 4; i++) {
+        if (i_result_policy(p_pollux, &param, &mode, &mask, &where))
+            goto label_deinit;
+        if (!(i)) first = mask;
+        /* one node is left alone, the mask stays empty */
+        if (mask != first) {
+            fprintf(stderr, "error, auto moved from %#lx to %#lx\n",
+                first, mask);
+            goto label_deinit;
+        }
+    }
+    printf("auto: mask %#lx over 4 param_set\n", first);
+    ret = 0;
+
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+    return ret;
+}
+
+/**
+ * the caches of a handle mapped on its node; then the CPUs of one
+ * node against the memory of each node: the raw read bandwidth, and
+ * the decoding with the frame caches on that node
+ */
+int
+main(int argc, char *argv[])
+{
+    static unsigned int cpu[NODE_NR][CPU_NR];
+    unsigned int cpu_nr[NODE_NR];
+    int node_nr = 0;
+    while (node_nr < NODE_NR &&
+        (cpu_nr[node_nr] = i_node_cpus(node_nr, cpu[node_nr])))
+        node_nr++;
+    if (!(node_nr)) {
+        printf("no NUMA information, skipped\n");
+        return 0;
+    }
+    if (i_placement(node_nr)) return -1;
+    if (node_nr == 1) printf("one node, local access only\n");
+
+    for (int c = 0; c < node_nr; c++) {
+        i_pin(cpu[c], cpu_nr[c]);
+        for (int m = 0; m < node_nr; m++) {
+            printf("cpus of node %d, memory of node %d (%s): "
+                "read %6.2f GB/s, decoding %7.2f fps\n",
+                c, m, (c == m) ? "local" : "remote", i_probe(m),
+                i_decode(cpu[c], cpu_nr[c], m));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#define FRAME_NR (200)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+typedef struct {
+    pollux_decode_t *p_pollux;
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    /* frames retained by the callback */
+    unsigned int nr;
+    /* the frame retained last, -1 if none */
+    int token;
+    unsigned long long last_idx;
+    /* the first error, 0 if none */
+    int err;
+} i_ctx_t;
+
+static i_ctx_t ctx = {
+    .mtx = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .token = -1,
+};
+
+/**
+ * retain each frame until the next one arrives, then give it back
+ * twice; the caches are only reused by the decoding thread, which is
+ * in here, so only the first release may succeed
+ */
+static int
+i_on_frame(const pollux_decode_frame_view_t *p_view, void *p_user)
+{
+    i_ctx_t *p_c = (i_ctx_t *)p_user;
+    pollux_decode_t *p_pollux = p_c->p_pollux;
+    int ret;
+
+    pthread_mutex_lock(&(p_c->mtx));
+    if (p_c->nr >= FRAME_NR || p_c->err) {
+        pthread_mutex_unlock(&(p_c->mtx));
+        return POLLUX_FRAME_RELEASE;
+    }
+
+    if (p_c->token >= 0) {
+        if ((ret = p_pollux->frame_release(p_pollux, p_c->token))) {
+            fprintf(stderr, "error, frame_release: %d\n", ret);
+            p_c->err = -1;
+        }
+        ret = p_pollux->frame_release(p_pollux, p_c->token);
+        if (ret != POLLUX_ERR_INVALID_PARAMETER) {
+            fprintf(stderr, "error, second frame_release: %d\n", ret);
+            p_c->err = -1;
+        }
+    }
+    if (p_c->nr && p_view->frame_idx <= p_c->last_idx) {
+        fprintf(stderr, "error, frame %llu after %llu\n",
+            p_view->frame_idx, p_c->last_idx);
+        p_c->err = -1;
+    }
+
+    p_c->token = p_view->token;
+    p_c->last_idx = p_view->frame_idx;
+    if (++(p_c->nr) == FRAME_NR || p_c->err)
+        pthread_cond_signal(&(p_c->cond));
+    pthread_mutex_unlock(&(p_c->mtx));
+
+    return POLLUX_FRAME_RETAIN;
+}
+
+/**
+ * @brief wait until the callback has retained `FRAME_NR` frames
+ */
+static int
+i_wait(i_ctx_t *p_c)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += 30;
+
+    pthread_mutex_lock(&(p_c->mtx));
+    while (p_c->nr < FRAME_NR && !(p_c->err)) {
+        if (pthread_cond_timedwait(&(p_c->cond), &(p_c->mtx), &ts)) {
+            fprintf(stderr, "error, %u frames in time\n", p_c->nr);
+            p_c->err = -1;
+        }
+    }
+    pthread_mutex_unlock(&(p_c->mtx));
+
+    return p_c->err;
+}
+
+/**
+ * frames retained by the frame ready callback are given back once;
+ * a second release, or a release after `release` of the handle,
+ * must be rejected instead of freeing the cache twice
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_param_t param = {0};
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+    ctx.p_pollux = p_pollux;
+
+    param.p_file = video;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 360;
+    param.yuv.alignment = 1;
+    param.on_frame = i_on_frame;
+    param.p_user = &ctx;
+    ret = p_pollux->param_set(p_pollux, &param);
+    if (ret) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_deinit;
+    }
+
+    ret = i_wait(&ctx);
+    /* the callback retains no more, the last frame is ours */
+    if (ctx.token >= 0 &&
+        p_pollux->frame_release(p_pollux, ctx.token) != POLLUX_OK) {
+        fprintf(stderr, "error, frame_release of the last frame\n");
+        ret = -1;
+    }
+    p_pollux->release(p_pollux);
+    if (ctx.token >= 0 && p_pollux->frame_release(p_pollux,
+        ctx.token) != POLLUX_ERR_INVALID_PARAMETER) {
+        fprintf(stderr, "error, frame_release after release\n");
+        ret = -1;
+    }
+    printf("%u frames retained and released\n", ctx.nr);
+
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
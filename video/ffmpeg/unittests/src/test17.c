@@ -0,0 +1,98 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BUF_NR (4)
+#define FRAME_NR (200)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+/**
+ * @brief borrow frames converted straight into the buffers of the
+ *  caller, and give each one back twice
+ */
+static int
+i_borrow_loop(pollux_decode_t *p_pollux, unsigned char **pp_buf)
+{
+    int ret;
+    pollux_decode_frame_view_t view;
+    for (unsigned int n = 0; n < FRAME_NR; n++) {
+        ret = p_pollux->result_borrow(p_pollux, &view, 1000);
+        if (ret == POLLUX_ERR_AGAIN) continue;
+        if (ret == POLLUX_ERR_FILE_END) break;
+        if (ret) {
+            fprintf(stderr, "error, result_borrow: %d\n", ret);
+            return -1;
+        }
+
+        if (view.index >= BUF_NR || view.data[0] != pp_buf[view.index]) {
+            fprintf(stderr, "error, frame %u is not in buffer %u\n",
+                n, view.index);
+            return -1;
+        }
+
+        if ((ret = p_pollux->frame_release(p_pollux, view.token))) {
+            fprintf(stderr, "error, frame_release: %d\n", ret);
+            return -1;
+        }
+        /* the cache may be in the free queue already, not again */
+        ret = p_pollux->frame_release(p_pollux, view.token);
+        if (ret != POLLUX_ERR_INVALID_PARAMETER) {
+            fprintf(stderr, "error, second frame_release: %d\n", ret);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * the frames are converted into caller-owned buffers and borrowed
+ * without a copy; a borrowed frame is given back exactly once
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_param_t param = {0};
+    unsigned char *p_buf[BUF_NR] = {NULL};
+    size_t size;
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    param.p_file = video;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 360;
+    param.yuv.alignment = 64;
+    if ((ret = pollux_decode_buf_size(&(param.yuv), &size)))
+        goto label_deinit;
+    for (unsigned int i = 0; i < BUF_NR; i++) {
+        if (!(p_buf[i] = (unsigned char *)aligned_alloc(64,
+            (size + 63) / 64 * 64))) {
+            ret = -1;
+            goto label_buf_free;
+        }
+    }
+    param.ext_buf.nr = BUF_NR;
+    param.ext_buf.pp_buf = p_buf;
+    ret = p_pollux->param_set(p_pollux, &param);
+    if (ret) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_buf_free;
+    }
+
+    ret = i_borrow_loop(p_pollux, p_buf);
+    p_pollux->release(p_pollux);
+    if (!(ret)) printf("%d frames borrowed and released\n", FRAME_NR);
+
+label_buf_free:
+    for (unsigned int i = 0; i < BUF_NR; i++) free(p_buf[i]);
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
@@ -0,0 +1,101 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#define GET_NR (40)
+/* the consumer is slower than the source */
+#define CONSUME_US (100 * 1000)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+static const char *name[] = {"fifo", "mailbox", "drop-oldest"};
+
+/**
+ * @brief a slow consumer, the frame indexes must rise and be
+ *  consecutive only when nothing is dropped
+ */
+static int
+i_run(pollux_decode_t *p_pollux,
+    pollux_delivery_t delivery, pollux_drop_t drop)
+{
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    unsigned long long last_idx = 0, gap_nr = 0, drop_nr = 0;
+    unsigned int nr = 0;
+
+    param.p_file = video;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 360;
+    param.yuv.alignment = 1;
+    param.is_loop = 1;
+    param.delivery = delivery;
+    param.drop = drop;
+    int ret = p_pollux->param_set(p_pollux, &param);
+    if (ret) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        return ret;
+    }
+    if ((ret = pollux_decode_result_alloc(p_pollux, &p_res)))
+        goto label_release;
+
+    for (; nr < GET_NR; nr++) {
+        if ((ret = p_pollux->result_get(p_pollux, p_res))) {
+            fprintf(stderr, "error, result_get: %d\n", ret);
+            goto label_result_free;
+        }
+        if (nr && p_res->frame_idx <= last_idx) {
+            fprintf(stderr, "error, frame %llu after %llu\n",
+                p_res->frame_idx, last_idx);
+            ret = -1;
+            goto label_result_free;
+        }
+        if (nr && p_res->frame_idx != last_idx + 1) gap_nr++;
+        last_idx = p_res->frame_idx;
+        usleep(CONSUME_US);
+    }
+    p_pollux->drop_nr_get(p_pollux, &drop_nr);
+
+    printf("%-12s %u results, last frame %llu, %llu gaps, %llu dropped\n",
+        name[(delivery == POLLUX_DELIVERY_MAILBOX) ? 1 : drop ? 2 : 0],
+        nr, last_idx, gap_nr, drop_nr);
+
+    /* blocking loses nothing, the others must have lost frames */
+    if (delivery == POLLUX_DELIVERY_FIFO && drop == POLLUX_DROP_NONE) {
+        if (gap_nr || drop_nr) ret = -1;
+    } else if (!(gap_nr) || !(drop_nr)) {
+        ret = -1;
+    }
+    if (ret) fprintf(stderr, "error, unexpected drops\n");
+
+label_result_free:
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+    return ret;
+}
+
+/**
+ * a consumer slower than the source: the queue blocks the decoder,
+ * the mailbox and the drop-oldest policy skip ahead to new frames
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    if (!(ret = i_run(p_pollux, POLLUX_DELIVERY_FIFO, POLLUX_DROP_NONE)) &&
+        !(ret = i_run(p_pollux,
+            POLLUX_DELIVERY_MAILBOX, POLLUX_DROP_NONE))) {
+        ret = i_run(p_pollux, POLLUX_DELIVERY_FIFO, POLLUX_DROP_OLDEST);
+    }
+
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
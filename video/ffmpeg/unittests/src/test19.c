@@ -0,0 +1,121 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define FRAME_NR (120)
+#define BATCH_NR (8)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+static int
+i_open(pollux_decode_t **pp_pollux)
+{
+    pollux_decode_param_t param = {0};
+    param.p_file = video;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 360;
+    param.yuv.alignment = 32;
+
+    int ret = pollux_decode_init(pp_pollux);
+    if (ret) return ret;
+    if ((ret = (*pp_pollux)->param_set(*pp_pollux, &param))) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        pollux_decode_deinit(*pp_pollux);
+        *pp_pollux = NULL;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief the frames of the batches against the same frames got
+ *  one by one from another handle
+ */
+static int
+i_compare(pollux_decode_t *p_one, pollux_decode_result_t *p_res,
+    pollux_decode_t *p_batch_h, pollux_decode_batch_t *p_batch)
+{
+    int ret, n;
+    unsigned int nr = 0, call_nr = 0;
+    const pollux_decode_meta_t *p_meta;
+    while (nr < FRAME_NR) {
+        n = p_batch_h->result_get_batch(p_batch_h, BATCH_NR, p_batch, 1000);
+        if (n == POLLUX_ERR_AGAIN) continue;
+        if (n == POLLUX_ERR_FILE_END) break;
+        if (n <= 0 || n > BATCH_NR) {
+            fprintf(stderr, "error, result_get_batch: %d\n", n);
+            return -1;
+        }
+        call_nr++;
+
+        for (int i = 0; i < n; i++, nr++) {
+            if ((ret = p_one->result_get(p_one, p_res))) {
+                fprintf(stderr, "error, result_get: %d\n", ret);
+                return -1;
+            }
+
+            p_meta = &(p_batch->p_meta[i]);
+            if (p_meta->frame_idx != p_res->frame_idx ||
+                p_meta->pts_us != p_res->pts_us ||
+                p_meta->width != p_res->width ||
+                p_meta->height != p_res->height ||
+                p_meta->stride != p_res->stride ||
+                memcmp(p_batch->buf + i * p_batch->frame_size,
+                    p_res->buf, p_batch->frame_size)) {
+                fprintf(stderr, "error, frame %u differs\n", nr);
+                return -1;
+            }
+        }
+    }
+
+    printf("%u frames in %u batches, all equal to the single results\n",
+        nr, call_nr);
+    return nr ? 0 : -1;
+}
+
+/**
+ * a batch is the same frames `result_get` returns, one after the
+ * other in a continuous buffer
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_one = NULL, *p_batch_h = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_batch_t *p_batch = NULL;
+
+    int ret = i_open(&p_one);
+    if (ret) return ret;
+    if ((ret = i_open(&p_batch_h))) goto label_one_deinit;
+
+    if ((ret = pollux_decode_result_alloc(p_one, &p_res)))
+        goto label_batch_deinit;
+    if ((ret = pollux_decode_batch_alloc(p_batch_h,
+        BATCH_NR, POLLUX_LAYOUT_PLANAR, &p_batch)))
+        goto label_result_free;
+    if (p_batch->frame_size != p_res->buf_size) {
+        fprintf(stderr, "error, frame size %zu, result size %zu\n",
+            p_batch->frame_size, p_res->buf_size);
+        ret = -1;
+        goto label_batch_free;
+    }
+
+    ret = i_compare(p_one, p_res, p_batch_h, p_batch);
+
+label_batch_free:
+    pollux_decode_batch_free(p_batch);
+label_result_free:
+    pollux_decode_result_free(p_res);
+label_batch_deinit:
+    p_batch_h->release(p_batch_h);
+    pollux_decode_deinit(p_batch_h);
+label_one_deinit:
+    p_one->release(p_one);
+    pollux_decode_deinit(p_one);
+
+    return ret;
+}
@@ -0,0 +1,122 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FRAME_NR (60)
+#define WIDTH (1280)
+#define HEIGHT (720)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+typedef struct {
+    pollux_fmt_t fmt;
+    /* the 8-bit format of the same layout */
+    pollux_fmt_t ref_fmt;
+    /* the bits to drop to get 8-bit luma */
+    unsigned int shift;
+    const char *p_name;
+} i_case_t;
+
+static const i_case_t cases[] = {
+    {POLLUX_FMT_P010, POLLUX_FMT_NV12, 8, "p010"},
+    {POLLUX_FMT_YUV420P10, POLLUX_FMT_NV12, 2, "yuv420p10"},
+    {POLLUX_FMT_YUV444P16, POLLUX_FMT_444P, 8, "yuv444p16"},
+};
+
+static int
+i_open(pollux_decode_t **pp_pollux, pollux_decode_result_t **pp_res,
+    pollux_fmt_t fmt)
+{
+    pollux_decode_param_t param = {0};
+    param.p_file = video;
+    param.yuv.fmt = fmt;
+    /* the size of the source, the frames may be copied without sws */
+    param.yuv.width = WIDTH;
+    param.yuv.height = HEIGHT;
+    param.yuv.alignment = 64;
+
+    int ret = pollux_decode_init(pp_pollux);
+    if (ret) return ret;
+    if ((ret = (*pp_pollux)->param_set(*pp_pollux, &param)) ||
+        (ret = pollux_decode_result_alloc(*pp_pollux, pp_res))) {
+        fprintf(stderr, "error, fmt %d: %d\n", fmt, ret);
+        (*pp_pollux)->release(*pp_pollux);
+        pollux_decode_deinit(*pp_pollux);
+        *pp_pollux = NULL;
+    }
+
+    return ret;
+}
+
+static void
+i_close(pollux_decode_t *p_pollux, pollux_decode_result_t *p_res)
+{
+    if (!(p_pollux)) return;
+    pollux_decode_result_free(p_res);
+    p_pollux->release(p_pollux);
+    pollux_decode_deinit(p_pollux);
+}
+
+/**
+ * @brief the luma of a deep format, shifted down, against the luma
+ *  of the 8-bit format from another handle on the same file
+ *
+ * @return the largest difference, negative on error
+ */
+static int
+i_compare(const i_case_t *p_c)
+{
+    pollux_decode_t *p_deep = NULL, *p_ref = NULL;
+    pollux_decode_result_t *p_deep_res = NULL, *p_ref_res = NULL;
+    int max = -1, d;
+    if (i_open(&p_deep, &p_deep_res, p_c->fmt)) return -1;
+    if (i_open(&p_ref, &p_ref_res, p_c->ref_fmt)) goto label_close;
+
+    max = 0;
+    for (unsigned int n = 0; n < FRAME_NR && max >= 0; n++) {
+        if (p_deep->result_get(p_deep, p_deep_res) ||
+            p_ref->result_get(p_ref, p_ref_res) ||
+            p_deep_res->frame_idx != p_ref_res->frame_idx ||
+            p_deep_res->fmt != p_c->fmt) {
+            fprintf(stderr, "error, %s frame %u\n", p_c->p_name, n);
+            max = -1;
+            break;
+        }
+
+        for (int y = 0; y < HEIGHT; y++) {
+            const unsigned short *p_w = (const unsigned short *)
+                (p_deep_res->buf + y * p_deep_res->stride);
+            const unsigned char *p_b = p_ref_res->buf + y * p_ref_res->stride;
+            for (int x = 0; x < WIDTH; x++) {
+                d = abs((int)(p_w[x] >> p_c->shift) - (int)(p_b[x]));
+                if (d > max) max = d;
+            }
+        }
+    }
+
+label_close:
+    i_close(p_ref, p_ref_res);
+    i_close(p_deep, p_deep_res);
+    return max;
+}
+
+/**
+ * the formats of more than 8 bits per component must carry the same
+ * picture as the 8-bit ones, in the bits the format documents
+ */
+int
+main(int argc, char *argv[])
+{
+    int max;
+    for (unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        max = i_compare(&(cases[i]));
+        printf("%-10s largest luma difference: %d\n", cases[i].p_name, max);
+        /* the rounding of sws, nothing more */
+        if (max < 0 || max > 1) return -1;
+    }
+
+    return 0;
+}
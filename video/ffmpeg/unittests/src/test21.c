@@ -0,0 +1,126 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+
+#define FRAME_NR (30)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+/**
+ * @brief parameters whose smallest pyramid level has no pixel left,
+ *  for the output and for a rendition, must be rejected
+ */
+static int
+i_too_small(pollux_decode_t *p_pollux)
+{
+    pollux_decode_param_t param = {0};
+    pollux_decode_yuv_t rend = {0};
+    param.p_file = video;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 4;
+    param.yuv.alignment = 1;
+    param.yuv.pyramid_nr = POLLUX_PYRAMID_MAX;
+    int ret = p_pollux->param_set(p_pollux, &param);
+    p_pollux->release(p_pollux);
+    if (ret != POLLUX_ERR_INVALID_PARAMETER) {
+        fprintf(stderr, "error, param_set of a 640x4 pyramid: %d\n", ret);
+        return -1;
+    }
+
+    rend = param.yuv;
+    param.yuv.height = 360;
+    param.rendition_nr = 1;
+    param.p_rendition = &rend;
+    ret = p_pollux->param_set(p_pollux, &param);
+    p_pollux->release(p_pollux);
+    if (ret != POLLUX_ERR_INVALID_PARAMETER) {
+        fprintf(stderr, "error, param_set of a 640x4 rendition: %d\n", ret);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief every scaled level is the rounded 2x2 average of the one above
+ */
+static int
+i_levels_check(const pollux_decode_result_t *p_res)
+{
+    const pollux_decode_level_t *p_s, *p_d;
+    const unsigned char *p_s0, *p_s1, *p_row;
+    for (unsigned int i = 1; i < p_res->level_nr; i++) {
+        p_s = &(p_res->level[i - 1]);
+        p_d = &(p_res->level[i]);
+        if (p_d->width != p_s->width / 2 || p_d->height != p_s->height / 2 ||
+            p_d->offset + p_d->stride * p_d->height > p_res->buf_size)
+            return -1;
+
+        for (int y = 0; y < p_d->height; y++) {
+            p_s0 = p_res->buf + p_s->offset + 2 * y * p_s->stride;
+            p_s1 = p_s0 + p_s->stride;
+            p_row = p_res->buf + p_d->offset + y * p_d->stride;
+            for (int x = 0; x < p_d->width; x++) {
+                if (p_row[x] != ((p_s0[2 * x] + p_s0[2 * x + 1] +
+                    p_s1[2 * x] + p_s1[2 * x + 1] + 2) >> 2))
+                    return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * the luma pyramid behind the frame in the result, and the rejection
+ * of the sizes too small for the levels asked for
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+    if ((ret = i_too_small(p_pollux))) goto label_deinit;
+
+    param.p_file = video;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 360;
+    param.yuv.alignment = 64;
+    param.yuv.pyramid_nr = POLLUX_PYRAMID_MAX;
+    if ((ret = p_pollux->param_set(p_pollux, &param))) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_deinit;
+    }
+    if ((ret = pollux_decode_result_alloc(p_pollux, &p_res)))
+        goto label_release;
+
+    for (unsigned int n = 0; n < FRAME_NR; n++) {
+        if ((ret = p_pollux->result_get(p_pollux, p_res))) {
+            fprintf(stderr, "error, result_get: %d\n", ret);
+            break;
+        }
+        if (p_res->level_nr != POLLUX_PYRAMID_MAX ||
+            i_levels_check(p_res)) {
+            fprintf(stderr, "error, the pyramid of frame %u\n", n);
+            ret = -1;
+            break;
+        }
+    }
+    if (!(ret)) printf("%d frames, %d levels each\n",
+        FRAME_NR, POLLUX_PYRAMID_MAX);
+
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
@@ -0,0 +1,135 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define GET_NR (40)
+/* the main consumer is slower than the source, its queue stays full */
+#define CONSUME_US (100 * 1000)
+/* far below the 1 s a rendition consumer may wait for its frame */
+#define GET_LIMIT_US (200 * 1000)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+typedef struct {
+    pollux_decode_t *p_pollux;
+    pollux_decode_result_t *p_res;
+    unsigned long long nr;
+    unsigned long long bad_nr;
+} i_rend_arg_t;
+
+static atomic_bool running = true;
+
+static long long
+i_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief take rendition 1 as fast as it comes, the consumer is
+ *  waiting for a frame most of the time
+ */
+static void *
+i_rend_consume(void *args)
+{
+    i_rend_arg_t *p_a = (i_rend_arg_t *)args;
+    int ret;
+    while (atomic_load(&running)) {
+        ret = p_a->p_pollux->result_rendition_get(p_a->p_pollux,
+            1, p_a->p_res);
+        if (ret == POLLUX_ERR_RESOURCE_REQUEST) continue;
+        if (ret) break;
+        p_a->nr++;
+        if (p_a->p_res->width != 320 || p_a->p_res->height != 180)
+            p_a->bad_nr++;
+    }
+
+    return NULL;
+}
+
+/**
+ * a consumer of a rendition waiting for its frame must not hold up
+ * `result_get` of the main output on the same handle
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    pollux_decode_yuv_t rend = {0};
+    i_rend_arg_t arg = {0};
+    pthread_t thd;
+    long long t, dt, max_us = 0;
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    param.p_file = video;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 360;
+    param.yuv.alignment = 1;
+    param.is_loop = 1;
+    rend = param.yuv;
+    rend.width = 320;
+    rend.height = 180;
+    param.rendition_nr = 1;
+    param.p_rendition = &rend;
+    if ((ret = p_pollux->param_set(p_pollux, &param))) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_deinit;
+    }
+    if ((ret = pollux_decode_result_alloc(p_pollux, &p_res)))
+        goto label_release;
+    if ((ret = pollux_decode_result_rendition_alloc(p_pollux,
+        1, &(arg.p_res))))
+        goto label_result_free;
+
+    arg.p_pollux = p_pollux;
+    if ((ret = pthread_create(&thd, NULL, i_rend_consume, &arg))) {
+        pollux_decode_result_free(arg.p_res);
+        goto label_result_free;
+    }
+
+    for (unsigned int n = 0; n < GET_NR; n++) {
+        usleep(CONSUME_US);
+        t = i_now_us();
+        if ((ret = p_pollux->result_get(p_pollux, p_res))) {
+            fprintf(stderr, "error, result_get: %d\n", ret);
+            break;
+        }
+        dt = i_now_us() - t;
+        /* the first frames may still be decoding */
+        if (n > 2 && dt > max_us) max_us = dt;
+    }
+
+    atomic_store(&running, false);
+    pthread_join(thd, NULL);
+    pollux_decode_result_free(arg.p_res);
+
+    printf("longest result_get: %lld us, %llu rendition frames\n",
+        max_us, arg.nr);
+    if (!(ret) && (max_us > GET_LIMIT_US || !(arg.nr) || arg.bad_nr)) {
+        fprintf(stderr, "error, %llu rendition frames of a wrong size\n",
+            arg.bad_nr);
+        ret = -1;
+    }
+
+label_result_free:
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
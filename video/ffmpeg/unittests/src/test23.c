@@ -0,0 +1,83 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+
+#define GET_NR (600)
+/* above the rate of the source, and 1 / FPS is not a whole microsecond */
+#define FPS (90)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+/**
+ * @brief the time of tick `n`, rounded the same way as the handle
+ */
+static long long
+i_tick_us(unsigned long long n)
+{
+    return (long long)((n * 1000000ULL + FPS / 2) / FPS);
+}
+
+/**
+ * the results of a converted rate are exactly one tick apart, the
+ * repeated frames included, and their error does not grow over time
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    long long first_us = 0, d, max_d = 0;
+    unsigned long long last_idx = 0, repeat_nr = 0;
+    unsigned int n = 0;
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    param.p_file = video;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 360;
+    param.yuv.alignment = 1;
+    param.is_loop = 0;
+    param.fps = FPS;
+    if ((ret = p_pollux->param_set(p_pollux, &param))) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_deinit;
+    }
+    if ((ret = pollux_decode_result_alloc(p_pollux, &p_res)))
+        goto label_release;
+
+    for (; n < GET_NR; n++) {
+        ret = p_pollux->result_get(p_pollux, p_res);
+        if (ret == POLLUX_ERR_FILE_END && n) {
+            ret = 0;
+            break;
+        }
+        if (ret) {
+            fprintf(stderr, "error, result_get: %d\n", ret);
+            break;
+        }
+        if (!(n)) first_us = p_res->pts_us;
+        if (n && p_res->frame_idx == last_idx) repeat_nr++;
+        last_idx = p_res->frame_idx;
+
+        d = p_res->pts_us - first_us - i_tick_us(n);
+        if (d < 0) d = -d;
+        if (d > max_d) max_d = d;
+    }
+
+    printf("%u ticks, %llu repeated, largest error: %lld us\n",
+        n, repeat_nr, max_d);
+    /* the rounding of the tick and of the first one, no drift */
+    if (!(ret) && (!(repeat_nr) || max_d > 2)) ret = -1;
+
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
@@ -0,0 +1,133 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <time.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* the `param_set` calls averaged for a hit */
+#define HIT_NR (5)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+/* a copy, whose modification time the test may change */
+static const char *copy = "./test24_input.mp4";
+static const char *cache = "./test24_probe.cache";
+
+static double
+i_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)(ts.tv_sec) * 1e3 + (double)(ts.tv_nsec) / 1e6;
+}
+
+static int
+i_copy(const char *p_src, const char *p_dst)
+{
+    char buf[1 << 16];
+    size_t n;
+    int ret = -1;
+    FILE *p_in = fopen(p_src, "rb"), *p_out = fopen(p_dst, "wb");
+    if (!(p_in) || !(p_out)) goto label_close;
+
+    while ((n = fread(buf, 1, sizeof(buf), p_in)) > 0) {
+        if (fwrite(buf, 1, n, p_out) != n) goto label_close;
+    }
+    ret = 0;
+
+label_close:
+    if (p_in) fclose(p_in);
+    if (p_out && fclose(p_out)) ret = -1;
+    return ret;
+}
+
+/**
+ * @brief the time of `param_set` on the copy, in milliseconds
+ */
+static double
+i_param_set_ms(pollux_decode_t *p_pollux)
+{
+    pollux_decode_param_t param = {0};
+    param.p_file = copy;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 360;
+    param.yuv.alignment = 1;
+
+    double start = i_now_ms();
+    int ret = p_pollux->param_set(p_pollux, &param);
+    double ms = i_now_ms() - start;
+    p_pollux->release(p_pollux);
+    if (ret) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        return -1.0;
+    }
+
+    return ms;
+}
+
+static double
+i_hit_ms(pollux_decode_t *p_pollux)
+{
+    double ms, sum = 0.0;
+    for (unsigned int i = 0; i < HIT_NR; i++) {
+        if ((ms = i_param_set_ms(p_pollux)) < 0) return ms;
+        sum += ms;
+    }
+
+    return sum / HIT_NR;
+}
+
+/**
+ * the probe cache: a miss probes the streams, a hit skips the probe,
+ * a file with a new modification time is probed again, and the cache
+ * file carries the hits over to the next configuration
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    struct timespec ts[2] = {{0, UTIME_OMIT}, {0, 0}};
+    double miss, hit, stale, reload;
+    int ret = -1;
+
+    remove(cache);
+    if (i_copy(video, copy)) {
+        fprintf(stderr, "error, copy of %s\n", video);
+        return -1;
+    }
+    if (pollux_decode_probe_cache_set(16, cache)) goto label_copy_remove;
+    if (pollux_decode_init(&p_pollux)) goto label_copy_remove;
+
+    if ((miss = i_param_set_ms(p_pollux)) < 0 ||
+        (hit = i_hit_ms(p_pollux)) < 0)
+        goto label_deinit;
+
+    /* the same size, another modification time */
+    clock_gettime(CLOCK_REALTIME, &(ts[1]));
+    ts[1].tv_sec += 60;
+    if (utimensat(AT_FDCWD, copy, ts, 0)) goto label_deinit;
+    if ((stale = i_param_set_ms(p_pollux)) < 0) goto label_deinit;
+
+    /* a fresh start from the cache file */
+    if (pollux_decode_probe_cache_set(0, NULL) ||
+        pollux_decode_probe_cache_set(16, cache) ||
+        (reload = i_hit_ms(p_pollux)) < 0)
+        goto label_deinit;
+
+    printf("miss %.2f ms, hit %.2f ms, stale %.2f ms, "
+        "hit after reload %.2f ms\n", miss, hit, stale, reload);
+    ret = (hit < miss && hit < stale && reload < stale) ? 0 : -1;
+    if (ret) fprintf(stderr, "error, the hits are not faster\n");
+
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+label_copy_remove:
+    remove(copy);
+    remove(cache);
+
+    return ret;
+}
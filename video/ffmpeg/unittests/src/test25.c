@@ -0,0 +1,122 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+static const char *stage[POLLUX_STAGE_MAX] = {
+    "read", "send", "receive", "convert", "deliver", "copy",
+};
+
+/**
+ * @brief the statistics of a run to the end of the file, checked
+ *  against the `nr` results the consumer got
+ */
+static int
+i_stats_check(const pollux_decode_stats_t *p_stats, unsigned long long nr)
+{
+    const pollux_decode_stage_stats_t *p_st;
+    int ret = 0;
+
+    printf("packets %llu, decoded %llu, delivered %llu, got %llu, "
+        "dropped %llu, %.1f fps\n", p_stats->packet_nr, p_stats->decode_nr,
+        p_stats->deliver_nr, nr, p_stats->drop_nr, p_stats->decode_fps);
+    /* nothing is dropped when the consumer waits for every frame */
+    if (p_stats->deliver_nr != nr || p_stats->drop_nr ||
+        p_stats->decode_nr < nr || !(p_stats->packet_nr)) {
+        fprintf(stderr, "error, the counters do not add up\n");
+        ret = -1;
+    }
+
+    for (unsigned int i = 0; i < POLLUX_STAGE_MAX; i++) {
+        p_st = &(p_stats->stage[i]);
+        printf("%-8s: %8llu, p50 %6llu us, p99 %6llu us, max %6llu us\n",
+            stage[i], p_st->count, p_st->p50_ns / 1000,
+            p_st->p99_ns / 1000, p_st->max_ns / 1000);
+        if (!(p_st->count) || p_st->p50_ns > p_st->p99_ns ||
+            p_st->p99_ns > p_st->max_ns || p_st->max_ns > p_st->total_ns) {
+            fprintf(stderr, "error, stage %s\n", stage[i]);
+            ret = -1;
+        }
+    }
+    /* one copy per result, in the thread of the consumer */
+    if (p_stats->stage[POLLUX_STAGE_COPY].count != nr ||
+        p_stats->stage[POLLUX_STAGE_DELIVER].count != nr) {
+        fprintf(stderr, "error, %llu results but %llu copies\n",
+            nr, p_stats->stage[POLLUX_STAGE_COPY].count);
+        ret = -1;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief decode the whole file, then check the statistics
+ */
+static int
+i_run(pollux_decode_t *p_pollux, const pollux_decode_param_t *p_param)
+{
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_stats_t stats;
+    unsigned long long nr = 0;
+    int ret = p_pollux->param_set(p_pollux, p_param);
+    if (ret) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_release;
+    }
+    if ((ret = pollux_decode_result_alloc(p_pollux, &p_res)))
+        goto label_release;
+
+    for (;;) {
+        ret = p_pollux->result_get(p_pollux, p_res);
+        if (ret == POLLUX_OK) {
+            nr++;
+        } else if (ret == POLLUX_ERR_FILE_END) {
+            break;
+        } else if (ret != POLLUX_ERR_RESOURCE_REQUEST) {
+            fprintf(stderr, "error, result_get: %d\n", ret);
+            goto label_result_free;
+        }
+    }
+
+    if ((ret = p_pollux->stats_get(p_pollux, &stats)))
+        goto label_result_free;
+    ret = (nr && !(i_stats_check(&stats, nr))) ? 0 : -1;
+
+label_result_free:
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+
+    return ret;
+}
+
+/**
+ * the counters and the per-stage latencies of `stats_get`, twice on
+ * the same handle, as `param_set` starts them over
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_param_t param = {0};
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    param.p_file = video;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 360;
+    param.yuv.alignment = 1;
+    param.fps = 0;
+    param.is_loop = 0;
+    for (unsigned int i = 0; i < 2 && !(ret); i++) {
+        ret = i_run(p_pollux, &param);
+    }
+
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
@@ -0,0 +1,268 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define FRAME_NR (60)
+/* deeper than any trace, a guard against a runaway parse */
+#define DEPTH_MAX (32)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+/* written by `trace_dump` while the handle runs */
+static const char *live = "./test26_live.json";
+/* written by `release`, refer to `p_trace_file` */
+static const char *last = "./test26_release.json";
+
+typedef struct {
+    const char *p;
+    /* complete events, `"ph":"X"` */
+    unsigned long long event_nr;
+} i_json_t;
+
+static void
+i_space(i_json_t *p_j)
+{
+    while (isspace((unsigned char)(*(p_j->p)))) p_j->p++;
+}
+
+static bool
+i_string(i_json_t *p_j)
+{
+    if (*(p_j->p) != '"') return false;
+    for (p_j->p++; *(p_j->p) != '"'; p_j->p++) {
+        if (!(*(p_j->p)) || (unsigned char)(*(p_j->p)) < 0x20) return false;
+        if (*(p_j->p) != '\\') continue;
+
+        p_j->p++;
+        if (*(p_j->p) == 'u') {
+            for (unsigned int i = 0; i < 4; i++) {
+                if (!(isxdigit((unsigned char)(*(++(p_j->p)))))) return false;
+            }
+        } else if (!(*(p_j->p)) || !(strchr("\"\\/bfnrt", *(p_j->p)))) {
+            return false;
+        }
+    }
+    p_j->p++;
+
+    return true;
+}
+
+static bool
+i_digits(i_json_t *p_j)
+{
+    if (!(isdigit((unsigned char)(*(p_j->p))))) return false;
+    while (isdigit((unsigned char)(*(p_j->p)))) p_j->p++;
+    return true;
+}
+
+static bool
+i_number(i_json_t *p_j)
+{
+    if (*(p_j->p) == '-') p_j->p++;
+    if (*(p_j->p) == '0') {
+        p_j->p++;
+    } else if (!(i_digits(p_j))) {
+        return false;
+    }
+    if (*(p_j->p) == '.') {
+        p_j->p++;
+        if (!(i_digits(p_j))) return false;
+    }
+    if (*(p_j->p) == 'e' || *(p_j->p) == 'E') {
+        p_j->p++;
+        if (*(p_j->p) == '+' || *(p_j->p) == '-') p_j->p++;
+        if (!(i_digits(p_j))) return false;
+    }
+
+    return true;
+}
+
+static bool i_value(i_json_t *p_j, unsigned int depth);
+
+static bool
+i_object(i_json_t *p_j, unsigned int depth)
+{
+    const char *p_key;
+    p_j->p++;
+    i_space(p_j);
+    if (*(p_j->p) == '}') {
+        p_j->p++;
+        return true;
+    }
+
+    for (;;) {
+        i_space(p_j);
+        p_key = p_j->p;
+        if (!(i_string(p_j))) return false;
+        i_space(p_j);
+        if (*(p_j->p) != ':') return false;
+        p_j->p++;
+        i_space(p_j);
+        if (!(strncmp(p_key, "\"ph\"", 4)) && !(strncmp(p_j->p, "\"X\"", 3)))
+            p_j->event_nr++;
+        if (!(i_value(p_j, depth + 1))) return false;
+
+        i_space(p_j);
+        if (*(p_j->p) == '}') break;
+        if (*(p_j->p) != ',') return false;
+        p_j->p++;
+    }
+    p_j->p++;
+
+    return true;
+}
+
+static bool
+i_array(i_json_t *p_j, unsigned int depth)
+{
+    p_j->p++;
+    i_space(p_j);
+    if (*(p_j->p) == ']') {
+        p_j->p++;
+        return true;
+    }
+
+    for (;;) {
+        if (!(i_value(p_j, depth + 1))) return false;
+        i_space(p_j);
+        if (*(p_j->p) == ']') break;
+        if (*(p_j->p) != ',') return false;
+        p_j->p++;
+    }
+    p_j->p++;
+
+    return true;
+}
+
+static bool
+i_value(i_json_t *p_j, unsigned int depth)
+{
+    if (depth > DEPTH_MAX) return false;
+
+    i_space(p_j);
+    switch (*(p_j->p)) {
+    case '{':
+        return i_object(p_j, depth);
+    case '[':
+        return i_array(p_j, depth);
+    case '"':
+        return i_string(p_j);
+    case 't':
+        p_j->p += 4;
+        return !(strncmp(p_j->p - 4, "true", 4));
+    case 'f':
+        p_j->p += 5;
+        return !(strncmp(p_j->p - 5, "false", 5));
+    case 'n':
+        p_j->p += 4;
+        return !(strncmp(p_j->p - 4, "null", 4));
+    default:
+        return i_number(p_j);
+    }
+}
+
+/**
+ * @brief parse the whole file as one JSON document
+ * 
+ * @return the number of complete events, negative if it does not parse
+ */
+static long long
+i_trace_check(const char *p_file)
+{
+    FILE *fp = fopen(p_file, "rb");
+    char *p_buf = NULL;
+    i_json_t j = {0};
+    long size;
+    long long ret = -1;
+    if (!(fp)) {
+        fprintf(stderr, "error, fopen: %s\n", p_file);
+        return -1;
+    }
+    if (fseek(fp, 0, SEEK_END) || (size = ftell(fp)) <= 0 ||
+        fseek(fp, 0, SEEK_SET))
+        goto label_close;
+    if (!(p_buf = (char *)malloc(size + 1))) goto label_close;
+    if (fread(p_buf, 1, size, fp) != (size_t)size) goto label_free;
+    p_buf[size] = '\0';
+
+    j.p = p_buf;
+    if (*(j.p) == '{' && i_value(&j, 0)) {
+        i_space(&j);
+        /* nothing may follow the document */
+        if (!(*(j.p))) ret = (long long)(j.event_nr);
+    }
+    /* the traces this handle writes always carry the event array */
+    if (ret >= 0 && !(strstr(p_buf, "\"traceEvents\":["))) ret = -1;
+    if (ret < 0) {
+        fprintf(stderr, "error, %s does not parse at byte %ld\n",
+            p_file, (long)(j.p - p_buf));
+    }
+
+label_free:
+    free(p_buf);
+label_close:
+    fclose(fp);
+    return ret;
+}
+
+/**
+ * the trace of a library built with `POLLUX_TRACE`: the one dumped
+ * while the handle runs and the one written by `release` must both
+ * be valid JSON and hold the events of the decoded frames
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    long long live_nr, last_nr;
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    remove(live);
+    remove(last);
+    param.p_file = video;
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.width = 640;
+    param.yuv.height = 360;
+    param.yuv.alignment = 1;
+    param.is_loop = 1;
+    param.p_trace_file = last;
+    if ((ret = p_pollux->param_set(p_pollux, &param))) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_release;
+    }
+    if ((ret = pollux_decode_result_alloc(p_pollux, &p_res)))
+        goto label_release;
+
+    for (unsigned int n = 0; n < FRAME_NR && !(ret); n++) {
+        if ((ret = p_pollux->result_get(p_pollux, p_res)))
+            fprintf(stderr, "error, result_get: %d\n", ret);
+    }
+    if (!(ret) && (ret = p_pollux->trace_dump(p_pollux, live)))
+        fprintf(stderr, "error, trace_dump: %d\n", ret);
+
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+    pollux_decode_deinit(p_pollux);
+    if (ret) return ret;
+
+    live_nr = i_trace_check(live);
+    last_nr = i_trace_check(last);
+    printf("events: %lld while running, %lld at release\n",
+        live_nr, last_nr);
+    /* a read, a send, a receive and a copy at least for every frame */
+    if (live_nr < 4 * FRAME_NR || last_nr < live_nr) ret = -1;
+
+    remove(live);
+    remove(last);
+
+    return ret;
+}
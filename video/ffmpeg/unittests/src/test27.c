@@ -0,0 +1,263 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <time.h>
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* the frames of the reference, the indexes checked against it */
+#define REF_NR (150)
+/* the handles sharing one CPU, far more than it decodes in time */
+#define HANDLE_NR (16)
+#define RUN_US (8 * 1000 * 1000)
+/* every handle must still deliver in this last part of the run */
+#define TAIL_US (2 * 1000 * 1000)
+/* the consumer too slow for the source, unit: microsecond */
+#define SLOW_US (200 * 1000)
+#define SLOW_NR (20)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+typedef struct {
+    pollux_decode_t *p_pollux;
+    unsigned long long nr;
+    /* the results in `TAIL_US` */
+    unsigned long long tail_nr;
+    /* the results whose index is not the one of their timestamp */
+    unsigned long long bad_nr;
+    pollux_decode_stats_t stats;
+} i_handle_t;
+
+static atomic_bool running = true;
+static long long start_us;
+/* the timestamp of each frame index, from a run at full quality */
+static long long ref_pts[REF_NR];
+static unsigned int ref_nr;
+
+static long long
+i_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+i_param_init(pollux_decode_param_t *p_param)
+{
+    p_param->p_file = video;
+    p_param->yuv.fmt = POLLUX_FMT_NV12;
+    p_param->yuv.width = 1280;
+    p_param->yuv.height = 720;
+    p_param->yuv.alignment = 1;
+}
+
+/**
+ * @brief the timestamps of the first frames, nothing shed
+ */
+static int
+i_reference(void)
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    i_param_init(&param);
+    if ((ret = p_pollux->param_set(p_pollux, &param)) ||
+        (ret = pollux_decode_result_alloc(p_pollux, &p_res))) {
+        fprintf(stderr, "error, reference: %d\n", ret);
+        goto label_release;
+    }
+
+    for (ref_nr = 0; ref_nr < REF_NR; ref_nr++) {
+        if ((ret = p_pollux->result_get(p_pollux, p_res))) break;
+        if (p_res->frame_idx != ref_nr) {
+            fprintf(stderr, "error, reference frame %u: index %llu\n",
+                ref_nr, p_res->frame_idx);
+            ret = -1;
+            break;
+        }
+        ref_pts[ref_nr] = p_res->pts_us;
+    }
+    if (ret == POLLUX_ERR_FILE_END && ref_nr) ret = 0;
+
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
+
+static void *
+i_consume(void *args)
+{
+    i_handle_t *p_h = (i_handle_t *)args;
+    pollux_decode_result_t *p_res = NULL;
+    if (pollux_decode_result_alloc(p_h->p_pollux, &p_res)) return NULL;
+
+    while (atomic_load(&running)) {
+        if (p_h->p_pollux->result_get(p_h->p_pollux, p_res)) continue;
+        p_h->nr++;
+        if (i_now_us() - start_us > RUN_US - TAIL_US) p_h->tail_nr++;
+        /* the first pass over the file, the loops are shifted in time */
+        if (p_res->frame_idx < ref_nr &&
+            p_res->pts_us != ref_pts[p_res->frame_idx])
+            p_h->bad_nr++;
+    }
+
+    pollux_decode_result_free(p_res);
+    return NULL;
+}
+
+/**
+ * @brief many handles on one CPU: each of them must keep delivering
+ *  whatever level it sheds, with the indexes of the frames of the
+ *  stream, even when the decoder drops the non-reference frames
+ */
+static int
+i_overload(void)
+{
+    static i_handle_t handle[HANDLE_NR];
+    pthread_t thd[HANDLE_NR];
+    pollux_decode_param_t param = {0};
+    cpu_set_t cpus, one;
+    unsigned int nr = 0, shed_nr = 0;
+    unsigned long long sum = 0, min = 0, bad_nr = 0;
+    int ret = 0;
+
+    /* the decoding threads, the ones of the codec too, inherit it */
+    sched_getaffinity(0, sizeof(cpus), &cpus);
+    CPU_ZERO(&one);
+    CPU_SET(sched_getcpu(), &one);
+    sched_setaffinity(0, sizeof(one), &one);
+
+    i_param_init(&param);
+    param.is_loop = 1;
+    param.shed.is_enable = 1;
+    start_us = i_now_us();
+    for (; nr < HANDLE_NR; nr++) {
+        if ((ret = pollux_decode_init(&(handle[nr].p_pollux)))) break;
+        ret = handle[nr].p_pollux->param_set(handle[nr].p_pollux, &param);
+        if (ret) {
+            fprintf(stderr, "error, param_set: %d\n", ret);
+            pollux_decode_deinit(handle[nr].p_pollux);
+            break;
+        }
+        if ((ret = pthread_create(
+            &(thd[nr]), NULL, i_consume, &(handle[nr])))) {
+            handle[nr].p_pollux->release(handle[nr].p_pollux);
+            pollux_decode_deinit(handle[nr].p_pollux);
+            break;
+        }
+    }
+    sched_setaffinity(0, sizeof(cpus), &cpus);
+
+    long long left_us = RUN_US - (i_now_us() - start_us);
+    struct timespec ts = {
+        .tv_sec = left_us / 1000000, .tv_nsec = left_us % 1000000 * 1000,
+    };
+    if (!(ret) && left_us > 0) nanosleep(&ts, NULL);
+    for (unsigned int i = 0; i < nr; i++) {
+        (void)handle[i].p_pollux->stats_get(
+            handle[i].p_pollux, &(handle[i].stats));
+    }
+    atomic_store(&running, false);
+
+    for (unsigned int i = 0; i < nr; i++) {
+        pthread_join(thd[i], NULL);
+        handle[i].p_pollux->release(handle[i].p_pollux);
+        pollux_decode_deinit(handle[i].p_pollux);
+
+        printf("[%2u] %5.1f fps, %llu in the tail, shed level %d, "
+            "late %lld ms, dropped %llu, wrong index %llu\n", i,
+            (double)(handle[i].nr) * 1e6 / RUN_US, handle[i].tail_nr,
+            handle[i].stats.shed_level, handle[i].stats.late_us / 1000,
+            handle[i].stats.drop_nr, handle[i].bad_nr);
+        sum += handle[i].nr;
+        if (!(i) || handle[i].nr < min) min = handle[i].nr;
+        if (handle[i].stats.shed_level > POLLUX_SHED_NONE) shed_nr++;
+        bad_nr += handle[i].bad_nr;
+        /* the output stopped for good */
+        if (!(handle[i].tail_nr)) {
+            fprintf(stderr, "error, handle %u stopped delivering\n", i);
+            ret = -1;
+        }
+    }
+    if (ret) return ret;
+
+    printf("%u handles on one CPU: %.1f fps in total, %.1f fps at least, "
+        "%u shedding\n", nr, (double)sum * 1e6 / RUN_US,
+        (double)min * 1e6 / RUN_US, shed_nr);
+    /* not overloaded, nothing was tested */
+    if (!(shed_nr) || bad_nr) ret = -1;
+
+    return ret;
+}
+
+/**
+ * @brief a consumer slower than the source holds the frame caches,
+ *  which is not the decoder falling behind: nothing may be shed
+ */
+static int
+i_slow_consumer(void)
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    pollux_decode_stats_t stats;
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    i_param_init(&param);
+    param.is_loop = 1;
+    param.shed.is_enable = 1;
+    if ((ret = p_pollux->param_set(p_pollux, &param)) ||
+        (ret = pollux_decode_result_alloc(p_pollux, &p_res))) {
+        fprintf(stderr, "error, slow consumer: %d\n", ret);
+        goto label_release;
+    }
+
+    for (unsigned int n = 0; n < SLOW_NR && !(ret); n++) {
+        ret = p_pollux->result_get(p_pollux, p_res);
+        usleep(SLOW_US);
+    }
+    if (!(ret)) ret = p_pollux->stats_get(p_pollux, &stats);
+    if (!(ret)) {
+        printf("slow consumer: shed level %d, late %lld ms\n",
+            stats.shed_level, stats.late_us / 1000);
+        if (stats.shed_level != POLLUX_SHED_NONE) ret = -1;
+    }
+
+    pollux_decode_result_free(p_res);
+label_release:
+    p_pollux->release(p_pollux);
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
+
+/**
+ * the load shedding under an overload it cannot keep up with, and
+ * under a consumer that is slow instead of the decoder
+ */
+int
+main(int argc, char *argv[])
+{
+    int ret;
+    if ((ret = i_reference())) return ret;
+    if ((ret = i_slow_consumer())) return ret;
+
+    return i_overload();
+}
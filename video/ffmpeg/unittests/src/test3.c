@@ -0,0 +1,125 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+
+#define HANDLE_NR (2)
+#define YUV_NR (256)
+
+static const char *video[HANDLE_NR] = {
+    "./input1_1280-720_video_audio.mp4",
+    "./input2_2560-1440_video.mp4",
+};
+
+/**
+ * one epoll loop services all the handles,
+ * no thread per handle is needed
+ */
+static int
+i_epoll_loop(pollux_decode_t **pp_pollux,
+    pollux_decode_result_t **pp_res)
+{
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    if (ep < 0) return -1;
+
+    int fd;
+    struct epoll_event ev = {0};
+    for (unsigned int i = 0; i < HANDLE_NR; i++) {
+        pp_pollux[i]->event_fd_get(pp_pollux[i], &fd);
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        if (epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev)) {
+            close(ep);
+            return -1;
+        }
+    }
+
+    int ret = 0;
+    unsigned int nr[HANDLE_NR] = {0};
+    unsigned int done = 0;
+    struct epoll_event evs[HANDLE_NR];
+    while (done < HANDLE_NR) {
+        int n = epoll_wait(ep, evs, HANDLE_NR, 5000);
+        if (n <= 0) {
+            fprintf(stderr, "error, epoll_wait: %d\n", n);
+            ret = -1;
+            break;
+        }
+
+        for (int j = 0; j < n; j++) {
+            unsigned int i = evs[j].data.u32;
+            if (nr[i] >= YUV_NR) continue;
+
+            switch (pp_pollux[i]->result_try_get(pp_pollux[i], pp_res[i])) {
+                case POLLUX_OK:
+                    if (++nr[i] == YUV_NR) done++;
+                    break;
+                case POLLUX_ERR_AGAIN:
+                    break;
+                case POLLUX_ERR_FILE_END:
+                    nr[i] = YUV_NR;
+                    done++;
+                    break;
+                default:
+                    fprintf(stderr, "error, result_try_get\n");
+                    close(ep);
+                    return -1;
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < HANDLE_NR; i++) {
+        printf("handle %u: %u results\n", i, nr[i]);
+    }
+
+    close(ep);
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ret = 0;
+    unsigned int i;
+    pollux_decode_t *p_pollux[HANDLE_NR] = {NULL};
+    pollux_decode_result_t *p_res[HANDLE_NR] = {NULL};
+    pollux_decode_param_t param = {0};
+
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.height = 720;
+    param.yuv.width = 1280;
+    param.yuv.alignment = 1;
+    param.fps = 60;
+    param.is_loop = 0;
+    for (i = 0; i < HANDLE_NR; i++) {
+        ret = pollux_decode_init(&(p_pollux[i]));
+        if (ret) goto label_decode_deinit;
+
+        param.p_file = video[i];
+        ret = p_pollux[i]->param_set(p_pollux[i], &param);
+        if (ret) {
+            fprintf(stderr, "error, param_set: %d\n", ret);
+            goto label_decode_deinit;
+        }
+
+        ret = pollux_decode_result_alloc(p_pollux[i], &(p_res[i]));
+        if (ret) goto label_decode_deinit;
+    }
+
+    ret = i_epoll_loop(p_pollux, p_res);
+
+label_decode_deinit:
+    for (i = 0; i < HANDLE_NR; i++) {
+        if (!(p_pollux[i])) continue;
+        pollux_decode_result_free(p_res[i]);
+        p_pollux[i]->release(p_pollux[i]);
+        pollux_decode_deinit(p_pollux[i]);
+    }
+
+    return ret;
+}
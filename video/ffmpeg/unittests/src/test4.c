@@ -0,0 +1,174 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * benchmark of the tensor output, both paths end with the same
+ *  normalized rgb float planes:
+ *  three passes, `POLLUX_FMT_444P` result and a separate
+ *  yuv-to-rgb / convert-to-float / normalize pass by the caller;
+ *  fused, `POLLUX_FMT_RGB_F32` result
+ */
+
+#define ROUND_NR (8)
+/* no more than the frame caches of the decoder */
+#define ROUND_FRAME_NR (30)
+
+static const char *video_1 = "./input2_2560-1440_video.mp4";
+
+static const float mean[3] = {0.485f, 0.456f, 0.406f};
+static const float std[3] = {0.229f, 0.224f, 0.225f};
+
+static inline double
+i_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static inline float
+i_clip(float v)
+{
+    return (v < 0.0f) ? 0.0f : (v > 255.0f) ? 255.0f : v;
+}
+
+/**
+ * the caller side pass of the three-pass path, bt.601 limited range
+ * yuv to rgb as sws does by default, then the normalization
+ */
+static void
+i_normalize(float *p_dst, const pollux_decode_result_t *p_res)
+{
+    const size_t plane = (size_t)(p_res->width) * p_res->height;
+    const unsigned char *p_y, *p_u, *p_v;
+    float scale[3], bias[3], l, u, v, rgb[3];
+    for (int c = 0; c < 3; c++) {
+        scale[c] = 1.0f / (255.0f * std[c]);
+        bias[c] = -mean[c] / std[c];
+    }
+
+    for (int y = 0; y < p_res->height; y++) {
+        p_y = p_res->buf + y * p_res->stride;
+        p_u = p_y + p_res->height * p_res->stride;
+        p_v = p_u + p_res->height * p_res->stride;
+        for (int x = 0; x < p_res->width; x++) {
+            l = 1.164f * (p_y[x] - 16);
+            u = p_u[x] - 128.0f;
+            v = p_v[x] - 128.0f;
+            rgb[0] = i_clip(l + 1.596f * v);
+            rgb[1] = i_clip(l - 0.392f * u - 0.813f * v);
+            rgb[2] = i_clip(l + 2.017f * u);
+            for (int c = 0; c < 3; c++) {
+                p_dst[c * plane + x] = rgb[c] * scale[c] + bias[c];
+            }
+        }
+        p_dst += p_res->width;
+    }
+}
+
+/**
+ * @return the average milliseconds per frame spent by the caller,
+ *  negative on error
+ */
+static double
+i_bench(pollux_decode_t *p_pollux, pollux_fmt_t fmt)
+{
+    pollux_decode_param_t param = {0};
+    param.yuv.fmt = fmt;
+    param.yuv.width = 640;
+    param.yuv.height = 384;
+    param.yuv.alignment = 1;
+    memcpy(param.yuv.mean, mean, sizeof(mean));
+    memcpy(param.yuv.std, std, sizeof(std));
+    param.fps = 1000;
+    param.is_loop = 1;
+    param.p_file = video_1;
+    int ret = p_pollux->param_set(p_pollux, &param);
+    if (ret) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        return -1;
+    }
+
+    pollux_decode_result_t *p_res = NULL;
+    if (pollux_decode_result_alloc(p_pollux, &p_res)) return -1;
+    float *p_tensor = (float *)malloc(
+        sizeof(float) * 3 * param.yuv.width * param.yuv.height);
+    if (!(p_tensor)) {
+        pollux_decode_result_free(p_res);
+        return -1;
+    }
+
+    double elapsed = 0, start;
+    unsigned int nr = 0;
+    for (unsigned int r = 0; r < ROUND_NR; r++) {
+        /* let the decoder fill its caches, so that only the copy is timed */
+        sleep(1);
+
+        start = i_now_ms();
+        for (unsigned int i = 0; i < ROUND_FRAME_NR; i++) {
+            if (p_pollux->result_get(p_pollux, p_res)) continue;
+            if (fmt == POLLUX_FMT_444P) i_normalize(p_tensor, p_res);
+            nr++;
+        }
+        elapsed += i_now_ms() - start;
+    }
+
+    free(p_tensor);
+    pollux_decode_result_free(p_res);
+    p_pollux->release(p_pollux);
+
+    return nr ? elapsed / nr : -1;
+}
+
+/**
+ * @brief a line of 16384 floats does not fit `stride` of the result,
+ *  the parameters must be rejected instead of wrapping around
+ */
+static int
+i_stride_limit(pollux_decode_t *p_pollux)
+{
+    pollux_decode_param_t param = {0};
+    param.yuv.fmt = POLLUX_FMT_RGB_F32;
+    param.yuv.width = 16384;
+    param.yuv.height = 16;
+    param.yuv.alignment = 1;
+    param.p_file = video_1;
+    int ret = p_pollux->param_set(p_pollux, &param);
+    p_pollux->release(p_pollux);
+    if (ret != POLLUX_ERR_INVALID_PARAMETER) {
+        fprintf(stderr, "error, param_set of width 16384: %d\n", ret);
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+    if ((ret = i_stride_limit(p_pollux))) goto label_deinit;
+
+    double three_pass = i_bench(p_pollux, POLLUX_FMT_444P);
+    double fused = i_bench(p_pollux, POLLUX_FMT_RGB_F32);
+    if (three_pass < 0 || fused < 0) {
+        ret = -1;
+    } else {
+        printf("three-pass: %.3f ms/frame, fused: %.3f ms/frame\n",
+            three_pass, fused);
+    }
+
+label_deinit:
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
@@ -0,0 +1,113 @@
+#include "pollux_decode.h"
+#include "pollux_sync.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HANDLE_NR (4)
+#define TUPLE_NR (256)
+
+/* the same recording stands in for every camera */
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+/**
+ * the handles run at different rates, the group must still
+ * return tuples whose frames share a timestamp
+ */
+static const unsigned short fps[HANDLE_NR] = {60, 50, 45, 30};
+
+static int
+i_tuple_loop(pollux_sync_t *p_sync, pollux_sync_tuple_t *p_tuple)
+{
+    int ret;
+    unsigned int nr = 0;
+    long long skew, max_skew = 0;
+    while (nr < TUPLE_NR) {
+        ret = p_sync->tuple_get(p_sync, p_tuple, 1000);
+        if (ret == POLLUX_ERR_AGAIN) continue;
+        if (ret == POLLUX_ERR_FILE_END) break;
+        if (ret) {
+            fprintf(stderr, "error, tuple_get: %d\n", ret);
+            return -1;
+        }
+
+        for (unsigned int i = 0; i < p_tuple->handle_nr; i++) {
+            skew = p_tuple->pts_us - p_tuple->pp_res[i]->pts_us;
+            if (skew > max_skew) max_skew = skew;
+        }
+        nr++;
+    }
+
+    unsigned long long drop_nr = 0;
+    p_sync->drop_nr_get(p_sync, &drop_nr);
+    printf("tuples: %u, late frames dropped: %llu, max skew: %lld us\n",
+        nr, drop_nr, max_skew);
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ret = 0;
+    unsigned int i;
+    pollux_decode_t *p_pollux[HANDLE_NR] = {NULL};
+    pollux_sync_t *p_sync = NULL;
+    pollux_sync_tuple_t *p_tuple = NULL;
+    pollux_decode_param_t param = {0};
+    pollux_sync_param_t sync_param = {0};
+
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.height = 360;
+    param.yuv.width = 640;
+    param.yuv.alignment = 1;
+    param.is_loop = 0;
+    param.p_file = video;
+    for (i = 0; i < HANDLE_NR; i++) {
+        ret = pollux_decode_init(&(p_pollux[i]));
+        if (ret) goto label_decode_deinit;
+
+        param.fps = fps[i];
+        ret = p_pollux[i]->param_set(p_pollux[i], &param);
+        if (ret) {
+            fprintf(stderr, "error, param_set: %d\n", ret);
+            goto label_decode_deinit;
+        }
+    }
+
+    ret = pollux_sync_init(&p_sync);
+    if (ret) goto label_decode_deinit;
+
+    sync_param.handle_nr = HANDLE_NR;
+    sync_param.pp_handle = p_pollux;
+    sync_param.tolerance_us = 5000;
+    ret = p_sync->param_set(p_sync, &sync_param);
+    if (ret) {
+        fprintf(stderr, "error, sync param_set: %d\n", ret);
+        goto label_sync_deinit;
+    }
+
+    ret = pollux_sync_tuple_alloc(p_sync, &p_tuple);
+    if (ret) goto label_sync_release;
+
+    ret = i_tuple_loop(p_sync, p_tuple);
+
+    pollux_sync_tuple_free(p_tuple);
+
+label_sync_release:
+    p_sync->release(p_sync);
+
+label_sync_deinit:
+    pollux_sync_deinit(p_sync);
+
+label_decode_deinit:
+    for (i = 0; i < HANDLE_NR; i++) {
+        if (!(p_pollux[i])) continue;
+        p_pollux[i]->release(p_pollux[i]);
+        pollux_decode_deinit(p_pollux[i]);
+    }
+
+    return ret;
+}
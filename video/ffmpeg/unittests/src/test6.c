@@ -0,0 +1,250 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include "libavformat/avformat.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SEEK_NR (64)
+
+static const char *video = "./input2_2560-1440_video.mp4";
+static const char *index_file = "./input2_2560-1440_video.mp4.pxidx";
+/**
+ * the same stream in MPEG-TS, which has no index of its frames:
+ * the seeks run before the background scan of the keyframes is done
+ */
+static const char *video_ts = "./test6_input.ts";
+
+/* targets within the first seconds of the test file */
+#define SEEK_RANGE_US (8 * 1000 * 1000LL)
+#define SEEK_RANGE_FRAME (240)
+/* the frames of the reference, beyond the targets and their GOP */
+#define REF_NR (360)
+
+static const char *mode_name[POLLUX_SEEK_MAX] = {
+    "keyframe", "accurate", "frame",
+};
+
+/* the timestamp of each frame index, from a run without seeks */
+static long long ref_pts[REF_NR];
+static unsigned int ref_nr;
+
+static inline long long
+i_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * random access latency: from `seek` until the first result
+ * of the new position is in hand
+ */
+static int
+i_seek_latency(pollux_decode_t *p_pollux,
+    pollux_decode_result_t *p_res, pollux_seek_t mode)
+{
+    int ret;
+    long long target, start, cost, sum = 0, max = 0;
+    unsigned int miss = 0;
+    for (unsigned int i = 0; i < SEEK_NR; i++) {
+        target = (mode == POLLUX_SEEK_FRAME) ?
+            rand() % SEEK_RANGE_FRAME : rand() % SEEK_RANGE_US;
+
+        start = i_now_us();
+        ret = p_pollux->seek(p_pollux, target, mode);
+        if (ret) {
+            fprintf(stderr, "error, seek: %d\n", ret);
+            return -1;
+        }
+        do {
+            ret = p_pollux->result_get(p_pollux, p_res);
+        } while (ret == POLLUX_ERR_RESOURCE_REQUEST);
+        if (ret) {
+            fprintf(stderr, "error, result_get: %d\n", ret);
+            return -1;
+        }
+        cost = i_now_us() - start;
+
+        if ((mode == POLLUX_SEEK_ACCURATE && p_res->pts_us < target) ||
+            (mode == POLLUX_SEEK_FRAME &&
+            p_res->frame_idx != (unsigned long long)target)) {
+            miss++;
+        }
+        /* the index is the one of the frame, whatever the mode */
+        if (p_res->frame_idx < ref_nr &&
+            p_res->pts_us != ref_pts[p_res->frame_idx]) {
+            fprintf(stderr, "error, %s seek to %lld: frame %llu at %lld us, "
+                "the reference has it at %lld us\n", mode_name[mode],
+                target, p_res->frame_idx, p_res->pts_us,
+                ref_pts[p_res->frame_idx]);
+            miss++;
+        }
+        sum += cost;
+        if (cost > max) max = cost;
+    }
+
+    printf("%-8s: avg %lld us, max %lld us, missed targets: %u\n",
+        mode_name[mode], sum / SEEK_NR, max, miss);
+    return (miss) ? -1 : 0;
+}
+
+/**
+ * @brief copy the video stream of `p_src` into an MPEG-TS file
+ */
+static int
+i_remux(const char *p_src, const char *p_dst)
+{
+    AVFormatContext *p_in = NULL, *p_out = NULL;
+    AVPacket *pkt = av_packet_alloc();
+    AVStream *p_st = NULL;
+    int ret = -1, index;
+    if (!(pkt) || avformat_open_input(&p_in, p_src, NULL, NULL) < 0 ||
+        avformat_find_stream_info(p_in, NULL) < 0)
+        goto label_close;
+    if ((index = av_find_best_stream(
+        p_in, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0)) < 0)
+        goto label_close;
+    if (avformat_alloc_output_context2(&p_out, NULL, "mpegts", p_dst) < 0 ||
+        !(p_st = avformat_new_stream(p_out, NULL)) ||
+        avcodec_parameters_copy(p_st->codecpar,
+            p_in->streams[index]->codecpar) < 0)
+        goto label_close;
+    p_st->codecpar->codec_tag = 0;
+    if (avio_open(&(p_out->pb), p_dst, AVIO_FLAG_WRITE) < 0 ||
+        avformat_write_header(p_out, NULL) < 0)
+        goto label_close;
+
+    while (av_read_frame(p_in, pkt) >= 0) {
+        if (pkt->stream_index != index) {
+            av_packet_unref(pkt);
+            continue;
+        }
+        pkt->stream_index = 0;
+        av_packet_rescale_ts(pkt,
+            p_in->streams[index]->time_base, p_st->time_base);
+        if (av_interleaved_write_frame(p_out, pkt) < 0) goto label_close;
+    }
+    if (!(av_write_trailer(p_out))) ret = 0;
+
+label_close:
+    if (p_out) {
+        if (p_out->pb) avio_closep(&(p_out->pb));
+        avformat_free_context(p_out);
+    }
+    avformat_close_input(&p_in);
+    av_packet_free(&pkt);
+    return ret;
+}
+
+static void
+i_param_init(pollux_decode_param_t *p_param, const char *p_file)
+{
+    p_param->yuv.fmt = POLLUX_FMT_NV12;
+    p_param->yuv.height = 720;
+    p_param->yuv.width = 1280;
+    p_param->yuv.alignment = 1;
+    p_param->fps = 0;
+    p_param->is_loop = 1;
+    p_param->p_file = p_file;
+}
+
+/**
+ * @brief the timestamps of the first frames of `p_file`, no seek
+ */
+static int
+i_reference(pollux_decode_t *p_pollux, pollux_decode_result_t **pp_res,
+    const char *p_file)
+{
+    pollux_decode_param_t param = {0};
+    i_param_init(&param, p_file);
+    int ret = p_pollux->param_set(p_pollux, &param);
+    if (ret) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        return ret;
+    }
+    if (!(*pp_res) && (ret = pollux_decode_result_alloc(p_pollux, pp_res)))
+        goto label_release;
+
+    for (ref_nr = 0; ref_nr < REF_NR; ref_nr++) {
+        if ((ret = p_pollux->result_get(p_pollux, *pp_res))) break;
+        if ((*pp_res)->frame_idx != ref_nr) {
+            fprintf(stderr, "error, reference frame %u: index %llu\n",
+                ref_nr, (*pp_res)->frame_idx);
+            ret = -1;
+            break;
+        }
+        ref_pts[ref_nr] = (*pp_res)->pts_us;
+    }
+
+label_release:
+    p_pollux->release(p_pollux);
+    return ret;
+}
+
+/**
+ * @brief the seeks of every mode on `p_file`, with the keyframe
+ *  index in `p_index_file` if it is not `NULL`
+ */
+static int
+i_file_seek(pollux_decode_t *p_pollux, const char *p_file,
+    const char *p_index_file)
+{
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+    int ret = i_reference(p_pollux, &p_res, p_file);
+    if (ret) goto label_result_free;
+
+    i_param_init(&param, p_file);
+    param.p_index_file = p_index_file;
+    ret = p_pollux->param_set(p_pollux, &param);
+    if (ret) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_result_free;
+    }
+
+    printf("%s, %s\n", p_file,
+        (p_index_file) ? "keyframe index" : "no keyframe index yet");
+    srand(1);
+    for (int mode = 0; mode < POLLUX_SEEK_MAX; mode++) {
+        ret = i_seek_latency(p_pollux, p_res, (pollux_seek_t)mode);
+        if (ret) break;
+    }
+
+    p_pollux->release(p_pollux);
+label_result_free:
+    pollux_decode_result_free(p_res);
+    return ret;
+}
+
+/**
+ * random access: the latency of the seeks, the targets they reach
+ * and the index of the frames at the new position, with the index
+ * of the demuxer and before the keyframes of a file without one
+ * are scanned
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    ret = i_file_seek(p_pollux, video, index_file);
+    if (!(ret)) {
+        if ((ret = i_remux(video, video_ts))) {
+            fprintf(stderr, "error, remux to %s\n", video_ts);
+        } else {
+            ret = i_file_seek(p_pollux, video_ts, NULL);
+        }
+        remove(video_ts);
+    }
+
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
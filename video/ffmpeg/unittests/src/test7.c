@@ -0,0 +1,104 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <time.h>
+#include <stdio.h>
+
+/* video with an audio stream that the demuxer discards */
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+static inline long long
+i_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * decode throughput of the whole file, as fast as the decoder goes
+ */
+static int
+i_throughput(pollux_decode_t *p_pollux, pollux_decode_result_t *p_res,
+    const char *p_name)
+{
+    unsigned long long nr = 0;
+    long long start = i_now_us();
+    int ret;
+    for (;;) {
+        ret = p_pollux->result_get(p_pollux, p_res);
+        if (ret == POLLUX_OK) {
+            nr++;
+        } else if (ret == POLLUX_ERR_FILE_END) {
+            break;
+        } else if (ret != POLLUX_ERR_RESOURCE_REQUEST) {
+            fprintf(stderr, "error, result_get: %d\n", ret);
+            return -1;
+        }
+    }
+    long long cost = i_now_us() - start;
+
+    printf("%-8s: %llu frames in %lld ms, %.1f fps\n", p_name, nr,
+        cost / 1000, cost ? (double)nr * 1000000 / cost : 0.0);
+
+    return 0;
+}
+
+/**
+ * the throughput of the same stream with the other streams read and
+ * dropped by the decoding thread, and discarded by the demuxer
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_param_t param = {0};
+
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.height = 720;
+    param.yuv.width = 1280;
+    param.yuv.alignment = 1;
+    param.fps = 0;
+    param.is_loop = 0;
+    param.p_file = video;
+
+    /**
+     * the best video stream with the audio read and dropped, then
+     * discarded by the demuxer; then the same stream by index
+     */
+    static const struct {
+        const char *p_name;
+        unsigned short is_stream_index;
+        unsigned short is_discard_off;
+    } run[] = {
+        {"keep", 0, 1},
+        {"discard", 0, 0},
+        {"index 0", 1, 0},
+    };
+    for (unsigned int i = 0; i < sizeof(run) / sizeof(run[0]); i++) {
+        param.is_stream_index = run[i].is_stream_index;
+        param.stream_index = 0;
+        param.is_discard_off = run[i].is_discard_off;
+        ret = p_pollux->param_set(p_pollux, &param);
+        if (ret) {
+            fprintf(stderr, "error, param_set: %d\n", ret);
+            break;
+        }
+
+        ret = pollux_decode_result_alloc(p_pollux, &p_res);
+        if (ret) break;
+        ret = i_throughput(p_pollux, p_res, run[i].p_name);
+        pollux_decode_result_free(p_res);
+        if (ret) break;
+    }
+
+    p_pollux->release(p_pollux);
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
@@ -0,0 +1,107 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <unistd.h>
+#include <stdio.h>
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+static const char *pcm_file = "./8_48000_2_s16.pcm";
+
+/**
+ * the audio of the file resampled to 48 kHz stereo s16 and written
+ * out in full, the samples left in the resampler at the end included
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_audio_result_t *p_audio = NULL;
+    pollux_decode_param_t param = {0};
+
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.height = 720;
+    param.yuv.width = 1280;
+    param.yuv.alignment = 1;
+    param.fps = 25;
+    param.is_loop = 0;
+    param.audio.is_enable = 1;
+    param.audio.sample_rate = 48000;
+    param.audio.channels = 2;
+    param.audio.fmt = POLLUX_SAMPLE_FMT_S16;
+    param.p_file = video;
+    ret = p_pollux->param_set(p_pollux, &param);
+    if (ret) {
+        fprintf(stderr, "error, param_set: %d\n", ret);
+        goto label_decode_deinit;
+    }
+
+    ret = pollux_decode_result_alloc(p_pollux, &p_res);
+    if (ret) goto label_decode_release;
+    ret = pollux_decode_audio_result_alloc(&p_audio);
+    if (ret) goto label_result_free;
+
+    FILE *fp = fopen(pcm_file, "wb");
+    if (!(fp)) {
+        fprintf(stderr, "error, fopen: %s\n", pcm_file);
+        ret = -1;
+        goto label_audio_free;
+    }
+
+    /* the video is taken on the way, only the audio is kept */
+    unsigned long long frame_nr = 0, sample_nr = 0;
+    int v_ret = POLLUX_OK, a_ret = POLLUX_OK;
+    while (v_ret != POLLUX_ERR_FILE_END || a_ret != POLLUX_ERR_FILE_END) {
+        if (v_ret != POLLUX_ERR_FILE_END) {
+            v_ret = p_pollux->result_try_get(p_pollux, p_res);
+            if (v_ret == POLLUX_OK) {
+                frame_nr++;
+            } else if (v_ret != POLLUX_ERR_AGAIN &&
+                v_ret != POLLUX_ERR_FILE_END) {
+                fprintf(stderr, "error, result_try_get: %d\n", v_ret);
+                ret = v_ret;
+                break;
+            }
+        }
+
+        a_ret = p_pollux->audio_get(p_pollux, p_audio);
+        if (a_ret == POLLUX_OK) {
+            fwrite(p_audio->buf, 1, (size_t)(p_audio->sample_nr) *
+                p_audio->channels * sizeof(short), fp);
+            sample_nr += p_audio->sample_nr;
+            continue;
+        }
+        if (a_ret != POLLUX_ERR_AGAIN && a_ret != POLLUX_ERR_FILE_END) {
+            fprintf(stderr, "error, audio_get: %d\n", a_ret);
+            ret = a_ret;
+            break;
+        }
+        usleep(5 * 1000);
+    }
+    fclose(fp);
+
+    printf("frames: %llu, samples: %llu (%.2f s), dropped chunks: %llu\n",
+        frame_nr, sample_nr, (double)sample_nr / 48000, p_audio->drop_nr);
+    if (!(ret) && !(sample_nr)) {
+        fprintf(stderr, "error, no audio\n");
+        ret = -1;
+    }
+
+label_audio_free:
+    pollux_decode_audio_result_free(p_audio);
+
+label_result_free:
+    pollux_decode_result_free(p_res);
+
+label_decode_release:
+    p_pollux->release(p_pollux);
+
+label_decode_deinit:
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}
@@ -0,0 +1,203 @@
+#include "pollux_decode.h"
+#include "pollux_fmt.h"
+#include "pollux_erron.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define CYCLE_NR (2000)
+#define DROP_CYCLE_NR (200)
+/* the teardown latency the handles are expected to keep */
+#define TEARDOWN_BUDGET_US (10 * 1000)
+
+static const char *video = "./input1_1280-720_video_audio.mp4";
+
+typedef struct {
+    pollux_decode_t *p_pollux;
+    pollux_decode_result_t *p_res;
+    atomic_bool running;
+} i_consumer_t;
+
+static inline long long
+i_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int
+i_cmp(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+static void
+i_report(const char *p_name, long long *p_us, unsigned int nr)
+{
+    long long sum = 0;
+    for (unsigned int i = 0; i < nr; i++) sum += p_us[i];
+    qsort(p_us, nr, sizeof(long long), i_cmp);
+
+    printf("%-10s: avg %lld us, p50 %lld us, p99 %lld us, max %lld us\n",
+        p_name, sum / nr, p_us[nr / 2], p_us[nr * 99 / 100], p_us[nr - 1]);
+}
+
+/**
+ * @brief take frames slower than the decoder makes them, the frame
+ *  caches are full and the decoder recycles the oldest ones
+ */
+static void *
+i_consume(void *args)
+{
+    i_consumer_t *p_c = (i_consumer_t *)args;
+    while (atomic_load(&(p_c->running))) {
+        (void)p_c->p_pollux->result_get(p_c->p_pollux, p_c->p_res);
+        usleep(5 * 1000);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief `param_set` and `release` in a loop
+ * 
+ * @param[in] p_c: a consumer started for each cycle and waiting for
+ *  frames during `release`, `NULL` if none, the calling thread then
+ *  takes one frame itself
+ * @param[in] is_borrow: without `p_c`, the calling thread borrows
+ *  every frame cache and holds them over `release`, the decoding
+ *  thread is left waiting for a free one
+ * 
+ * @return the number of `release` calls over the budget,
+ *  negative on error
+ */
+static int
+i_cycle(pollux_decode_t *p_pollux, const pollux_decode_param_t *p_param,
+    i_consumer_t *p_c, bool is_borrow, unsigned int cycle_nr,
+    const char *p_name)
+{
+    pollux_decode_result_t *p_res = NULL;
+    pollux_decode_frame_view_t view;
+    long long *p_set = calloc(cycle_nr, sizeof(long long));
+    long long *p_rel = calloc(cycle_nr, sizeof(long long));
+    long long start;
+    int ret = -1, over = 0;
+    pthread_t thd;
+    if (!(p_set) || !(p_rel)) goto label_free;
+
+    for (unsigned int i = 0; i < cycle_nr; i++) {
+        start = i_now_us();
+        ret = p_pollux->param_set(p_pollux, p_param);
+        p_set[i] = i_now_us() - start;
+        if (ret) {
+            fprintf(stderr, "error, param_set: %d\n", ret);
+            goto label_release;
+        }
+
+        if (!(p_res) && (ret = pollux_decode_result_alloc(p_pollux, &p_res)))
+            goto label_release;
+        if (p_c) {
+            p_c->p_res = p_res;
+            atomic_store(&(p_c->running), true);
+            if (pthread_create(&thd, NULL, i_consume, p_c)) {
+                ret = -1;
+                goto label_release;
+            }
+            /* the caches fill up, the consumer is waiting or sleeping */
+            usleep(20 * 1000);
+        } else if (is_borrow) {
+            /* the views are stale after `release`, they are not read */
+            while (!(p_pollux->result_borrow(p_pollux, &view, 50)));
+        } else {
+            /* the decoding thread is well into pacing */
+            (void)p_pollux->result_get(p_pollux, p_res);
+        }
+
+        start = i_now_us();
+        p_pollux->release(p_pollux);
+        p_rel[i] = i_now_us() - start;
+        if (p_rel[i] > TEARDOWN_BUDGET_US) over++;
+
+        if (p_c) {
+            atomic_store(&(p_c->running), false);
+            pthread_join(thd, NULL);
+        }
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s param_set", p_name);
+    i_report(name, p_set, cycle_nr);
+    snprintf(name, sizeof(name), "%s release", p_name);
+    i_report(name, p_rel, cycle_nr);
+    printf("release over %d us: %d of %u\n",
+        TEARDOWN_BUDGET_US, over, cycle_nr);
+    ret = over;
+
+label_release:
+    p_pollux->release(p_pollux);
+    pollux_decode_result_free(p_res);
+
+label_free:
+    free(p_set);
+    free(p_rel);
+
+    return ret;
+}
+
+/**
+ * `param_set` and `release` in a loop, while the decoding thread is
+ * pacing and a frame cache is waited for, while the decoder recycles
+ * the frames a slow consumer has not taken, and while the consumer
+ * has borrowed all of them; the teardown must not wait for a timeout
+ * anywhere
+ */
+int
+main(int argc, char *argv[])
+{
+    pollux_decode_t *p_pollux = NULL;
+    pollux_decode_param_t param = {0};
+    i_consumer_t consumer = {0};
+    int over;
+
+    int ret = pollux_decode_init(&p_pollux);
+    if (ret) return ret;
+
+    param.yuv.fmt = POLLUX_FMT_NV12;
+    param.yuv.height = 720;
+    param.yuv.width = 1280;
+    param.yuv.alignment = 1;
+    param.fps = 25;
+    param.is_loop = 1;
+    param.p_file = video;
+    ret = -1;
+    over = i_cycle(p_pollux, &param, NULL, false, CYCLE_NR, "paced");
+    /* a few runs late to the scheduler, none to a timeout */
+    if (over < 0 || over > CYCLE_NR / 100) goto label_decode_deinit;
+
+    /* as fast as the decoder goes, into a consumer too slow for it */
+    param.fps = 0;
+    param.drop = POLLUX_DROP_OLDEST;
+    consumer.p_pollux = p_pollux;
+    atomic_init(&(consumer.running), false);
+    over = i_cycle(p_pollux, &param, &consumer, false, DROP_CYCLE_NR, "drop");
+    if (over < 0 || over > DROP_CYCLE_NR / 100) goto label_decode_deinit;
+
+    /* nothing to recycle, every cache is borrowed */
+    over = i_cycle(p_pollux, &param, NULL, true, DROP_CYCLE_NR, "borrowed");
+    if (over < 0 || over > DROP_CYCLE_NR / 100) goto label_decode_deinit;
+
+    ret = 0;
+
+label_decode_deinit:
+    if (ret) fprintf(stderr, "error, release over the budget: %d\n", over);
+    pollux_decode_deinit(p_pollux);
+
+    return ret;
+}